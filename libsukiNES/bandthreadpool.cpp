@@ -0,0 +1,134 @@
+#include "bandthreadpool.h"
+
+// STL includes
+#include <algorithm>
+
+namespace sukiNES
+{
+	BandThreadPool::BandThreadPool(uint32 threadCount, uint32 lineCount)
+	: _threadCount(threadCount)
+	, _lineCount(lineCount)
+	, _jobGeneration(0)
+	, _bandsLeft(0)
+	, _isBusy(false)
+	, _isQuitting(false)
+	{
+		if (_threadCount == 0)
+		{
+			uint32 hardwareThreadCount = std::thread::hardware_concurrency();
+			_threadCount = std::max<uint32>(hardwareThreadCount, 2) - 1;
+		}
+
+		// The workers compute their band from the thread count when they start
+		_threadCount = std::min(_threadCount, _lineCount);
+		for (uint32 band = 0; band < _threadCount; ++band)
+		{
+			_threads.push_back(std::thread(&BandThreadPool::_work, this, band));
+		}
+	}
+
+	BandThreadPool::~BandThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_isQuitting = true;
+		}
+		_jobStarted.notify_all();
+
+		for (auto& thread : _threads)
+		{
+			thread.join();
+		}
+	}
+
+	void BandThreadPool::setJobDoneCallback(const std::function<void()>& callback)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_jobDoneCallback = callback;
+	}
+
+	bool BandThreadPool::run(const BandJob& job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (_isBusy)
+			{
+				return false;
+			}
+
+			_job = job;
+			_bandsLeft = _threadCount;
+			_isBusy = true;
+			++_jobGeneration;
+		}
+		_jobStarted.notify_all();
+
+		return true;
+	}
+
+	bool BandThreadPool::isBusy() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _isBusy;
+	}
+
+	void BandThreadPool::wait()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (_isBusy)
+		{
+			_jobDone.wait(lock);
+		}
+	}
+
+	void BandThreadPool::_work(uint32 band)
+	{
+		uint32 firstY = band * _lineCount / _threadCount;
+		uint32 lineCount = (band + 1) * _lineCount / _threadCount - firstY;
+		uint32 doneGeneration = 0;
+
+		for (;;)
+		{
+			BandJob job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				while (!_isQuitting && _jobGeneration == doneGeneration)
+				{
+					_jobStarted.wait(lock);
+				}
+
+				if (_isQuitting)
+				{
+					return;
+				}
+
+				doneGeneration = _jobGeneration;
+				job = _job;
+			}
+
+			job(firstY, lineCount);
+
+			std::function<void()> callback;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				if (--_bandsLeft > 0)
+				{
+					continue;
+				}
+				callback = _jobDoneCallback;
+			}
+
+			// Last band of the job
+			if (callback)
+			{
+				callback();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_isBusy = false;
+			}
+			_jobDone.notify_all();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+// STL includes
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Local includes
+#include "framebuffer.h"
+
+namespace sukiNES
+{
+	/**
+	 * @brief Worker threads splitting a job in horizontal bands of scanlines
+	 *
+	 * run() returns at once, each worker then calls the job on its own band.
+	 * Jobs are meant to be started from a single thread: a job started while the
+	 * previous one is still running is refused, so the caller can drop that frame.
+	 */
+	class BandThreadPool
+	{
+	public:
+		typedef std::function<void(uint32 firstY, uint32 lineCount)> BandJob;
+
+		/**
+		 * @param threadCount Worker threads, 0 for one per hardware thread besides the emulation thread
+		 * @param lineCount Scanlines shared among the workers
+		 */
+		explicit BandThreadPool(uint32 threadCount = 0, uint32 lineCount = FrameHeight);
+		~BandThreadPool();
+
+		/**
+		 * @brief Called on a worker thread once every band of a job is done
+		 *
+		 * The next job is not accepted before the callback returns.
+		 */
+		void setJobDoneCallback(const std::function<void()>& callback);
+
+		/**
+		 * @brief Start a job on every band
+		 * @return false when the previous job is still running, this one is not started
+		 */
+		bool run(const BandJob& job);
+
+		bool isBusy() const;
+
+		/**
+		 * @brief Wait until the running job is done
+		 */
+		void wait();
+
+		uint32 threadCount() const
+		{
+			return _threadCount;
+		}
+
+	private:
+		void _work(uint32 band);
+
+	private:
+		uint32 _threadCount;
+		uint32 _lineCount;
+		std::vector<std::thread> _threads;
+
+		mutable std::mutex _mutex;
+		std::condition_variable _jobStarted;
+		std::condition_variable _jobDone;
+
+		// Bumped by each job started
+		uint32 _jobGeneration;
+		uint32 _bandsLeft;
+		bool _isBusy;
+		bool _isQuitting;
+
+		BandJob _job;
+		std::function<void()> _jobDoneCallback;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "colorconversion.h"
+
+#ifdef SUKINES_ARCH_X86
+#include <immintrin.h>
+#endif
+
+// Local includes
+#include "assert.h"
+#include "cpufeatures.h"
+#include "rgbpalette.h"
+
+namespace sukiNES
+{
+	static const uint32 IndexMask = RgbPalette::EntryCount - 1;
+
+	template<typename Pixel>
+	static void lookUpColors(const uint16* indices, uint32 count, const Pixel* colors, Pixel* output)
+	{
+		for (uint32 pixel = 0; pixel < count; ++pixel)
+		{
+			output[pixel] = colors[indices[pixel] & IndexMask];
+		}
+	}
+
+	void convertColorIndicesScalar(const uint16* indices, uint32 count, const RgbPalette& palette, PixelFormat format, byte* output)
+	{
+		switch(format)
+		{
+			case PixelFormat::RGB32:
+				lookUpColors(indices, count, palette.rgb32(), reinterpret_cast<uint32*>(output));
+				break;
+			case PixelFormat::RGB565:
+				lookUpColors(indices, count, palette.rgb565(), reinterpret_cast<uint16*>(output));
+				break;
+			case PixelFormat::Grayscale:
+				lookUpColors(indices, count, palette.grayscale(), output);
+				break;
+			default:
+				sukiAssertWithMessage(false, "Color indices can only be converted to RGB32, RGB565 or Grayscale");
+				break;
+		}
+	}
+
+#ifdef SUKINES_ARCH_X86
+	// Gather 8 table entries as 32-bit values, the bytes past each entry are not masked out
+	template<int EntrySize>
+	SUKINES_TARGET_AVX2 static inline __m256i gatherColors(const uint16* indices, const void* colors)
+	{
+		__m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices)));
+		index = _mm256_and_si256(index, _mm256_set1_epi32(IndexMask));
+		return _mm256_i32gather_epi32(reinterpret_cast<const int*>(colors), index, EntrySize);
+	}
+
+	// Pack two vectors of 8 values below 0x10000 to 16 uint16 in order
+	SUKINES_TARGET_AVX2 static inline __m256i packTo16(__m256i low, __m256i high)
+	{
+		return _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8);
+	}
+
+	SUKINES_TARGET_AVX2 void convertColorIndicesAVX2(const uint16* indices, uint32 count, const RgbPalette& palette, PixelFormat format, byte* output)
+	{
+		uint32 pixel = 0;
+
+		switch(format)
+		{
+			case PixelFormat::RGB32:
+			{
+				uint32* rgb32 = reinterpret_cast<uint32*>(output);
+				for (; pixel + 8 <= count; pixel += 8)
+				{
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgb32 + pixel), gatherColors<4>(indices + pixel, palette.rgb32()));
+				}
+				break;
+			}
+			case PixelFormat::RGB565:
+			{
+				uint16* rgb565 = reinterpret_cast<uint16*>(output);
+				__m256i entryMask = _mm256_set1_epi32(0xFFFF);
+				for (; pixel + 16 <= count; pixel += 16)
+				{
+					__m256i low = _mm256_and_si256(gatherColors<2>(indices + pixel, palette.rgb565()), entryMask);
+					__m256i high = _mm256_and_si256(gatherColors<2>(indices + pixel + 8, palette.rgb565()), entryMask);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(rgb565 + pixel), packTo16(low, high));
+				}
+				break;
+			}
+			case PixelFormat::Grayscale:
+			{
+				__m256i entryMask = _mm256_set1_epi32(0xFF);
+				for (; pixel + 16 <= count; pixel += 16)
+				{
+					__m256i low = _mm256_and_si256(gatherColors<1>(indices + pixel, palette.grayscale()), entryMask);
+					__m256i high = _mm256_and_si256(gatherColors<1>(indices + pixel + 8, palette.grayscale()), entryMask);
+					__m256i luma = packTo16(low, high);
+					__m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(luma), _mm256_extracti128_si256(luma, 1));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(output + pixel), bytes);
+				}
+				break;
+			}
+			default:
+				break;
+		}
+
+		if (pixel < count)
+		{
+			uint32 bytesPerPixel = FrameBuffer::bytesPerPixel(format);
+			convertColorIndicesScalar(indices + pixel, count - pixel, palette, format, output + pixel * bytesPerPixel);
+		}
+	}
+#endif
+
+	ConvertColorIndicesFunction selectConvertColorIndices()
+	{
+#ifdef SUKINES_ARCH_X86
+		if (hostCpuFeatures().avx2)
+		{
+			return &convertColorIndicesAVX2;
+		}
+#endif
+		return &convertColorIndicesScalar;
+	}
+
+	void convertFrame(const FrameBuffer& source, const RgbPalette& palette, const FrameBuffer& destination)
+	{
+		sukiAssert(source.format == PixelFormat::ColorIndex);
+
+		ConvertColorIndicesFunction convertColorIndices = selectConvertColorIndices();
+		for (uint32 y = 0; y < FrameHeight; ++y)
+		{
+			const uint16* indices = reinterpret_cast<const uint16*>(source.scanline(y));
+			convertColorIndices(indices, FrameWidth, palette, destination.format, destination.scanline(y));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+// Local includes
+#include "framebuffer.h"
+
+namespace sukiNES
+{
+	class RgbPalette;
+
+	/**
+	 * @brief Convert ColorIndex pixels to a host pixel format
+	 * @param indices RgbPalette indices, (emphasis << 6) | colour
+	 * @param count Number of pixels
+	 * @param palette Colours to convert with
+	 * @param format RGB32, RGB565 or Grayscale
+	 * @param output count pixels in format
+	 */
+	typedef void (*ConvertColorIndicesFunction)(const uint16* indices, uint32 count, const RgbPalette& palette, PixelFormat format, byte* output);
+
+	void convertColorIndicesScalar(const uint16* indices, uint32 count, const RgbPalette& palette, PixelFormat format, byte* output);
+#ifdef SUKINES_ARCH_X86
+	void convertColorIndicesAVX2(const uint16* indices, uint32 count, const RgbPalette& palette, PixelFormat format, byte* output);
+#endif
+
+	/**
+	 * @brief Fastest conversion kernel supported by the host CPU
+	 */
+	ConvertColorIndicesFunction selectConvertColorIndices();
+
+	/**
+	 * @brief Convert a whole ColorIndex frame in one pass
+	 *
+	 * Meant for consumers that need colour from a frame kept as ColorIndex,
+	 * the PPU does the same conversion itself when rendering to a colour format.
+	 * @param source ColorIndex frame
+	 * @param palette Colours to convert with
+	 * @param destination RGB32, RGB565 or Grayscale frame
+	 */
+	void convertFrame(const FrameBuffer& source, const RgbPalette& palette, const FrameBuffer& destination);
+}
\ No newline at end of file
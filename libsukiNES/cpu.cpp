@@ -1428,6 +1428,9 @@ namespace sukiNES
 	, _inputIO(nullptr)
 	, _nmiOccured(false)
 	, _insideIrq(false)
+	, _pendingPpuDotFractions(0)
+	, _ppuDotFractionsPerCycle(regionTiming(Region::Ntsc).ppuDotFractionsPerCpuCycle)
+	, _isExecutingOpcode(false)
 	{
 		std::fill(std::begin(_buttonStatus), std::end(_buttonStatus), 0);
 		std::fill(std::begin(_inputReadCounter), std::end(_inputReadCounter), 0);
@@ -1462,6 +1465,8 @@ namespace sukiNES
 		_registers.ProcessorStatus.Unused = true;
 
 		_ppu->powerOn();
+		_pendingPpuDotFractions = 0;
+		_ppuDotFractionsPerCycle = regionTiming(_ppu->region()).ppuDotFractionsPerCpuCycle;
 
 		reset();
 	}
@@ -1486,6 +1491,8 @@ namespace sukiNES
 
 		sukiAssertWithMessage(_memory, "Please setup a memory for the CPU");
 
+		_isExecutingOpcode = true;
+
 		byte opcode = readMemory(_registers.ProgramCounter);
 
 		if (_instructions[opcode])
@@ -1499,6 +1506,9 @@ namespace sukiNES
 
 		_registers.ProgramCounter++;
 
+		// Leave the PPU at the end of the instruction so it can be observed between instructions
+		_syncPpu();
+
 		if (!_insideIrq)
 		{
 			if (_nmiOccured)
@@ -1507,10 +1517,13 @@ namespace sukiNES
 				nmiVectorAddress.setHighByte(0xFF);
 				nmiVectorAddress.setLowByte(0xFA);
 				doIrq(nmiVectorAddress);
+				_syncPpu();
 
 				_nmiOccured = false;
 			}
 		}
+
+		_isExecutingOpcode = false;
 	}
 
 	void Cpu::push(byte value)
@@ -1555,6 +1568,11 @@ namespace sukiNES
 	{
 		tick();
 
+		if (address >= 0x2000 && address < 0x4000)
+		{
+			_syncPpu();
+		}
+
 		byte readValue = 0;
 
 		if (address >= 0x4016 && address <= 0x4017)
@@ -1601,6 +1619,12 @@ namespace sukiNES
 	{
 		tick();
 
+		// Mappers can switch CHR banks and mirroring, so any write past the RAM
+		if (address >= 0x2000)
+		{
+			_syncPpu();
+		}
+
 		if (address == 0x4014)
 		{
 			dmaCopy(value);
@@ -1642,19 +1666,35 @@ namespace sukiNES
 #endif
 		sukiAssertWithMessage(_ppu, "Please set the PPU in the CPU");
 
-		// PPU is running 3 times faster than the CPU
-		for(int i=0; i<3; i++)
+		// PPU is running 3 times faster than the CPU, 3.2 times on PAL.
+		// Inside an instruction, the dots are run lazily by _syncPpu() when the PPU can be observed.
+		_pendingPpuDotFractions += _ppuDotFractionsPerCycle;
+		if (!_isExecutingOpcode)
 		{
-			_ppu->tick();
-			if ( _ppu->hasVBlankOccured())
-			{
-				_nmiOccured = true;
-			}
+			_syncPpu();
 		}
 
 		// TODO: Run APU tick
 	}
 
+	void Cpu::_syncPpu()
+	{
+		uint32 dotCount = _pendingPpuDotFractions / PpuDotFraction;
+		if (dotCount == 0)
+		{
+			return;
+		}
+
+		_ppu->run(dotCount);
+		_pendingPpuDotFractions -= dotCount * PpuDotFraction;
+
+		// The VBlank flag cannot both rise and fall between two syncs
+		if (_ppu->hasVBlankOccured())
+		{
+			_nmiOccured = true;
+		}
+	}
+
 	void Cpu::dmaCopy(byte memoryPage)
 	{
 		word ramAddress;
@@ -112,6 +112,8 @@ namespace sukiNES
 		void dmaCopy(byte memoryPage);
 		void doIrq(word vectorAddress);
 
+		void _syncPpu();
+
 		template<byte Opcode, class Instruction>
 		void registerOpcode()
 		{
@@ -133,6 +135,12 @@ namespace sukiNES
 		bool _nmiOccured;
 		bool _insideIrq;
 
+		// PPU dots owed since the last access that can observe the PPU, in PpuDotFraction units
+		uint32 _pendingPpuDotFractions;
+		// Taken from the PPU region at power on
+		uint32 _ppuDotFractionsPerCycle;
+		bool _isExecutingOpcode;
+
 		std::function<void(Cpu*)> _instructions[256];
 	};
 }
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "cpufeatures.h"
+
+#ifdef SUKINES_ARCH_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace sukiNES
+{
+#ifdef SUKINES_ARCH_X86
+	enum CpuidRegister
+	{
+		Eax = 0,
+		Ebx,
+		Ecx,
+		Edx
+	};
+
+	static void cpuid(uint32 leaf, uint32 subleaf, uint32 registers[4])
+	{
+#ifdef _MSC_VER
+		int result[4];
+		__cpuidex(result, leaf, subleaf);
+		for(uint32 i = 0; i < 4; ++i)
+		{
+			registers[i] = static_cast<uint32>(result[i]);
+		}
+#else
+		__cpuid_count(leaf, subleaf, registers[Eax], registers[Ebx], registers[Ecx], registers[Edx]);
+#endif
+	}
+
+	static uint32 readExtendedControlRegister()
+	{
+#ifdef _MSC_VER
+		return static_cast<uint32>(_xgetbv(0));
+#else
+		uint32 eax = 0;
+		uint32 edx = 0;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return eax;
+#endif
+	}
+#endif
+
+	static CpuFeatures detectCpuFeatures()
+	{
+		CpuFeatures features;
+		features.sse2 = false;
+		features.ssse3 = false;
+		features.avx2 = false;
+
+#ifdef SUKINES_ARCH_X86
+		uint32 registers[4];
+		cpuid(0, 0, registers);
+		uint32 maxLeaf = registers[Eax];
+
+		if (maxLeaf >= 1)
+		{
+			cpuid(1, 0, registers);
+			features.sse2 = (registers[Edx] & SUKINES_BIT(26)) != 0;
+			features.ssse3 = (registers[Ecx] & SUKINES_BIT(9)) != 0;
+
+			// AVX registers are only usable if the OS saves the YMM state
+			bool osSavesYmm = false;
+			if ((registers[Ecx] & SUKINES_BIT(27)) && (registers[Ecx] & SUKINES_BIT(28)))
+			{
+				osSavesYmm = (readExtendedControlRegister() & 0x6) == 0x6;
+			}
+
+			if (maxLeaf >= 7 && osSavesYmm)
+			{
+				cpuid(7, 0, registers);
+				features.avx2 = (registers[Ebx] & SUKINES_BIT(5)) != 0;
+			}
+		}
+#endif
+
+		return features;
+	}
+
+	const CpuFeatures& hostCpuFeatures()
+	{
+		static CpuFeatures features = detectCpuFeatures();
+		return features;
+	}
+}
\ No newline at end of file
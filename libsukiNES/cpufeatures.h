@@ -0,0 +1,33 @@
+#pragma once
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace sukiNES
+{
+	struct CpuFeatures
+	{
+		bool sse2;
+		bool ssse3;
+		bool avx2;
+	};
+
+	/**
+	 * @brief Instruction set extensions supported by the host CPU
+	 *
+	 * Queried once with CPUID, used to pick the SIMD kernels at runtime.
+	 */
+	const CpuFeatures& hostCpuFeatures();
+
+	inline uint32 lowestSetBit(uint32 value)
+	{
+#ifdef _MSC_VER
+		unsigned long index = 0;
+		_BitScanForward(&index, value);
+		return index;
+#else
+		return __builtin_ctz(value);
+#endif
+	}
+}
\ No newline at end of file
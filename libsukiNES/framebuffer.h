@@ -0,0 +1,69 @@
+#pragma once
+
+namespace sukiNES
+{
+	static const uint32 FrameWidth = 256;
+	static const uint32 FrameHeight = 240;
+
+	enum class PixelFormat
+	{
+		PaletteIndex,
+		ColorIndex,
+		RGB32,
+		RGB565,
+		Grayscale
+	};
+
+	/**
+	 * @brief Caller-provided memory the PPU renders into
+	 *
+	 * Each scanline starts at pixels + y * pitch.
+	 * - PaletteIndex: one byte per pixel, value read from palette RAM
+	 * - ColorIndex: one uint16 per pixel, RgbPalette::index() of the palette value and emphasis
+	 * - RGB32: one uint32 per pixel (0xFFRRGGBB), from the PPU RgbPalette
+	 * - RGB565: one uint16 per pixel, from the PPU RgbPalette
+	 * - Grayscale: one byte per pixel, luma of the PPU RgbPalette colour
+	 *
+	 * ColorIndex keeps everything needed to get the colour back with convertFrame(),
+	 * at half the size of RGB32.
+	 */
+	struct FrameBuffer
+	{
+		byte* pixels;
+		uint32 pitch;
+		PixelFormat format;
+
+		FrameBuffer()
+		: pixels(nullptr)
+		, pitch(0)
+		, format(PixelFormat::PaletteIndex)
+		{
+		}
+
+		FrameBuffer(byte* pixels, uint32 pitch, PixelFormat format)
+		: pixels(pixels)
+		, pitch(pitch)
+		, format(format)
+		{
+		}
+
+		byte* scanline(uint32 y) const
+		{
+			return pixels + y * pitch;
+		}
+
+		static uint32 bytesPerPixel(PixelFormat format)
+		{
+			switch(format)
+			{
+				case PixelFormat::ColorIndex:
+				case PixelFormat::RGB565:
+					return 2;
+				case PixelFormat::RGB32:
+					return 4;
+				default:
+					return 1;
+			}
+		}
+	};
+}
\ No newline at end of file
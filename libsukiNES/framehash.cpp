@@ -0,0 +1,121 @@
+#include "framehash.h"
+
+// STL includes
+#include <cstring>
+
+namespace sukiNES
+{
+	static const uint64 Prime1 = 11400714785074694791ULL;
+	static const uint64 Prime2 = 14029467366897019727ULL;
+	static const uint64 Prime3 = 1609587929392839161ULL;
+	static const uint64 Prime4 = 9650029242287828579ULL;
+	static const uint64 Prime5 = 2870177450012600261ULL;
+
+	static inline uint64 rotateLeft(uint64 value, uint32 bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	// Unaligned little-endian reads
+	static inline uint64 read64(const byte* data)
+	{
+		uint64 value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	static inline uint32 read32(const byte* data)
+	{
+		uint32 value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	static inline uint64 hashRound(uint64 accumulator, uint64 input)
+	{
+		accumulator += input * Prime2;
+		accumulator = rotateLeft(accumulator, 31);
+		return accumulator * Prime1;
+	}
+
+	static inline uint64 mergeRound(uint64 accumulator, uint64 value)
+	{
+		accumulator ^= hashRound(0, value);
+		return accumulator * Prime1 + Prime4;
+	}
+
+	uint64 hash64(const byte* data, uint32 size, uint64 seed)
+	{
+		const byte* end = data + size;
+		uint64 hash;
+
+		if (size >= 32)
+		{
+			// 4 independent lanes of 8 bytes
+			uint64 lanes[4] = { seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 };
+			const byte* lastStripe = end - 32;
+			do
+			{
+				lanes[0] = hashRound(lanes[0], read64(data));
+				lanes[1] = hashRound(lanes[1], read64(data + 8));
+				lanes[2] = hashRound(lanes[2], read64(data + 16));
+				lanes[3] = hashRound(lanes[3], read64(data + 24));
+				data += 32;
+			}
+			while (data <= lastStripe);
+
+			hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+			for (uint32 lane = 0; lane < 4; ++lane)
+			{
+				hash = mergeRound(hash, lanes[lane]);
+			}
+		}
+		else
+		{
+			hash = seed + Prime5;
+		}
+
+		hash += size;
+
+		for (; data + 8 <= end; data += 8)
+		{
+			hash ^= hashRound(0, read64(data));
+			hash = rotateLeft(hash, 27) * Prime1 + Prime4;
+		}
+
+		if (data + 4 <= end)
+		{
+			hash ^= static_cast<uint64>(read32(data)) * Prime1;
+			hash = rotateLeft(hash, 23) * Prime2 + Prime3;
+			data += 4;
+		}
+
+		for (; data < end; ++data)
+		{
+			hash ^= *data * Prime5;
+			hash = rotateLeft(hash, 11) * Prime1;
+		}
+
+		// Avalanche
+		hash ^= hash >> 33;
+		hash *= Prime2;
+		hash ^= hash >> 29;
+		hash *= Prime3;
+		hash ^= hash >> 32;
+
+		return hash;
+	}
+
+	uint64 hashFrame(const FrameBuffer& frameBuffer)
+	{
+		uint32 rowSize = FrameWidth * FrameBuffer::bytesPerPixel(frameBuffer.format);
+
+		uint64 hash = 0;
+		for (uint32 y = 0; y < FrameHeight; ++y)
+		{
+			hash = hash64(frameBuffer.scanline(y), rowSize, hash);
+		}
+
+		return hash;
+	}
+}
\ No newline at end of file
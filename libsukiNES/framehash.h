@@ -0,0 +1,20 @@
+#pragma once
+
+// Local includes
+#include "framebuffer.h"
+
+namespace sukiNES
+{
+	/**
+	 * @brief 64-bit xxHash (XXH64) of size bytes
+	 */
+	uint64 hash64(const byte* data, uint32 size, uint64 seed);
+
+	/**
+	 * @brief Hash of the visible scanlines of a frame buffer
+	 *
+	 * Each scanline is hashed with the previous scanline hash as seed,
+	 * so the padding between scanlines and the pitch do not matter.
+	 */
+	uint64 hashFrame(const FrameBuffer& frameBuffer);
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "frametriplebuffer.h"
+
+// STL includes
+#include <algorithm>
+
+// Local includes
+#include "rgbpalette.h"
+
+namespace sukiNES
+{
+	static const byte BlackPaletteValue = 0x0F;
+
+	// Opaque black, like the frames the PPU writes
+	FrameTripleBuffer::Frame FrameTripleBuffer::_blackFrame(PixelFormat format)
+	{
+		Frame frame;
+		frame.pixels.assign(FrameWidth * FrameHeight * FrameBuffer::bytesPerPixel(format), 0);
+		frame.burstPhase = 0;
+
+		if (format == PixelFormat::RGB32)
+		{
+			uint32* rgb32 = reinterpret_cast<uint32*>(frame.pixels.data());
+			std::fill(rgb32, rgb32 + FrameWidth * FrameHeight, 0xFF000000);
+		}
+		else if (format == PixelFormat::ColorIndex)
+		{
+			uint16* colorIndices = reinterpret_cast<uint16*>(frame.pixels.data());
+			std::fill(colorIndices, colorIndices + FrameWidth * FrameHeight, static_cast<uint16>(RgbPalette::index(BlackPaletteValue, 0)));
+		}
+
+		return frame;
+	}
+
+	FrameTripleBuffer::FrameTripleBuffer(PixelFormat format)
+	: _format(format)
+	, _frames(_blackFrame(format))
+	{
+		_publishedFrameCount.store(0);
+		_droppedFrameCount.store(0);
+		_duplicatedFrameCount.store(0);
+	}
+
+	FrameBuffer FrameTripleBuffer::publish(uint32 burstPhase)
+	{
+		_frames.back().burstPhase = burstPhase;
+
+		if (!_frames.publish())
+		{
+			_droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		_publishedFrameCount.fetch_add(1, std::memory_order_relaxed);
+
+		return backBuffer();
+	}
+
+	bool FrameTripleBuffer::acquire(bool isFrameExpected)
+	{
+		if (!_frames.acquire())
+		{
+			if (isFrameExpected)
+			{
+				_duplicatedFrameCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			return false;
+		}
+
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+#include <vector>
+
+// Local includes
+#include "framebuffer.h"
+#include "triplebuffer.h"
+
+namespace sukiNES
+{
+	/**
+	 * @brief Hands completed frames from the rendering thread to the display thread
+	 *
+	 * A TripleBuffer of frames: the producer renders into the back frame, the
+	 * consumer shows the front frame, neither side waits for the other.
+	 *
+	 * A frame published before the previous one was acquired replaces it, it is
+	 * counted as dropped. An acquire() expecting a new frame and finding none keeps
+	 * the front frame, it is counted as duplicated.
+	 */
+	class FrameTripleBuffer
+	{
+	public:
+		FrameTripleBuffer(PixelFormat format = PixelFormat::RGB32);
+
+		/**
+		 * @brief Frame to render into
+		 *
+		 * Producer thread only.
+		 */
+		FrameBuffer backBuffer()
+		{
+			return _frameBuffer(_frames.back());
+		}
+
+		/**
+		 * @brief Make the back frame the latest one
+		 * @param burstPhase FrameInfo::burstPhase of the frame, given back by frontBurstPhase()
+		 * @return The new back frame, holding an older frame
+		 *
+		 * Producer thread only.
+		 */
+		FrameBuffer publish(uint32 burstPhase = 0);
+
+		/**
+		 * @brief Make the latest published frame the front frame
+		 * @param isFrameExpected false when the display repaints for another reason than a new
+		 *        frame, the front frame staying is then not counted as duplicated
+		 * @return false when nothing was published since the previous call, the front frame stays
+		 *
+		 * Consumer thread only.
+		 */
+		bool acquire(bool isFrameExpected = true);
+
+		/**
+		 * @brief Frame to show, black until the first acquire()
+		 *
+		 * Consumer thread only.
+		 */
+		FrameBuffer frontBuffer()
+		{
+			return _frameBuffer(_frames.front());
+		}
+
+		/**
+		 * @brief Colour burst phase the front frame was published with, for the NTSC filter
+		 *
+		 * Consumer thread only.
+		 */
+		uint32 frontBurstPhase() const
+		{
+			return _frames.front().burstPhase;
+		}
+
+		PixelFormat format() const
+		{
+			return _format;
+		}
+
+		uint32 publishedFrameCount() const
+		{
+			return _publishedFrameCount.load(std::memory_order_relaxed);
+		}
+
+		uint32 droppedFrameCount() const
+		{
+			return _droppedFrameCount.load(std::memory_order_relaxed);
+		}
+
+		uint32 duplicatedFrameCount() const
+		{
+			return _duplicatedFrameCount.load(std::memory_order_relaxed);
+		}
+
+	private:
+		struct Frame
+		{
+			std::vector<byte> pixels;
+			uint32 burstPhase;
+		};
+
+		static Frame _blackFrame(PixelFormat format);
+
+		FrameBuffer _frameBuffer(Frame& frame) const
+		{
+			return FrameBuffer(frame.pixels.data(), FrameWidth * FrameBuffer::bytesPerPixel(_format), _format);
+		}
+
+	private:
+		PixelFormat _format;
+		TripleBuffer<Frame> _frames;
+
+		std::atomic<uint32> _publishedFrameCount;
+		std::atomic<uint32> _droppedFrameCount;
+		std::atomic<uint32> _duplicatedFrameCount;
+	};
+}
\ No newline at end of file
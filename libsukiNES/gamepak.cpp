@@ -11,6 +11,7 @@ namespace sukiNES
 	: _chrData(ChrBankSize)
 	, _chrBank(nullptr)
 	, _mirroring(0)
+	, _region(Region::Ntsc)
 	, _hasSaveRam(false)
 	, _mapperNumber(0)
 	, _mapper(nullptr)
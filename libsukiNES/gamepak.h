@@ -5,6 +5,7 @@
 
 // Local includes
 #include "memory.h"
+#include "regiontiming.h"
 
 namespace sukiNES
 {
@@ -36,6 +37,11 @@ namespace sukiNES
 		byte readChr(word address);
 		void writeChr(word address, byte value);
 
+		byte* chrBank() const
+		{
+			return _chrBank;
+		}
+
 		void setRomData(DynamicArray<byte>&& romData);
 
 		void setChrData(DynamicArray<byte>&& chrData)
@@ -66,6 +72,16 @@ namespace sukiNES
 			_mirroring = value;
 		}
 
+		Region region() const
+		{
+			return _region;
+		}
+
+		void setRegion(Region value)
+		{
+			_region = value;
+		}
+
 		size_t romPageCount() const
 		{
 			return _romData.size() / RomBankSize;
@@ -99,6 +115,7 @@ namespace sukiNES
 		byte* _chrBank;
 
 		byte _mirroring;
+		Region _region;
 		bool _hasSaveRam;
 		uint32 _mapperNumber;
 
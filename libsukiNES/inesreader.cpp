@@ -96,10 +96,9 @@ namespace sukiNES
 		byte controlByte2 = static_cast<byte>(file.getc());
 		byte wramPageCount = static_cast<byte>(file.getc());
 
-		for(int i=0; i<7; ++i)
-		{
-			file.getc();
-		}
+		// Bytes 9 to 15
+		byte extendedHeader[7];
+		file.read(extendedHeader, sizeof(byte), 7);
 
 		uint32 mapperNumber = (controlByte2 & 0xF0) | ((controlByte1 & 0xF0) >> 4);
 
@@ -120,6 +119,22 @@ namespace sukiNES
 		_gamePak->setMirroring(mirroring);
 		_gamePak->setHasSaveRam( (controlByte1 & SUKINES_BIT(1)) ? true : false );
 
+		Region region = Region::Ntsc;
+		if ((controlByte2 & 0x0C) == 0x08)
+		{
+			// NES 2.0 CPU/PPU timing in byte 12, multiple-region ROMs run as NTSC
+			static const Region Nes2Regions[] = { Region::Ntsc, Region::Pal, Region::Ntsc, Region::Dendy };
+			region = Nes2Regions[extendedHeader[3] & 0x3];
+		}
+		else if ((extendedHeader[0] & SUKINES_BIT(0))
+			&& (extendedHeader[3] | extendedHeader[4] | extendedHeader[5] | extendedHeader[6]) == 0)
+		{
+			// iNES TV system in byte 9, only trusted when the padding is clean as old dumps have garbage there
+			region = Region::Pal;
+		}
+
+		_gamePak->setRegion(region);
+
 		// Read ROM pages
 		uint32 romDataSize = romPageCount * RomBankSize;
 		DynamicArray<byte> romData(romDataSize);
@@ -142,6 +157,8 @@ namespace sukiNES
 		if (_ppu)
 		{
 			_ppu->setNametableMirroring(static_cast<PPU::NameTableMirroring>(mirroring));
+			_ppu->setRegion(region);
+			_ppu->mapChrBank(_gamePak->chrBank());
 		}
 
 		return true;
@@ -0,0 +1,296 @@
+#include "ntscfilter.h"
+
+#ifdef SUKINES_ARCH_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+// Local includes
+#include "assert.h"
+#include "cpufeatures.h"
+#include "rgbpalette.h"
+
+namespace sukiNES
+{
+	// See http://wiki.nesdev.com/w/index.php/NTSC_video
+	static const uint32 SamplesPerPixel = 8;
+	static const uint32 PhasesPerCycle = 12;
+	static const uint32 PhasesPerPixelPhase = PhasesPerCycle / NtscPhaseCount;
+	static const uint32 OutputPixelsPerPixel = NtscOutputWidth / FrameWidth;
+
+	// Composite voltage of the low and high half of the square wave, then the same attenuated by emphasis
+	static const float SignalLevels[16] =
+	{
+		0.228f, 0.312f, 0.552f, 0.880f,
+		0.616f, 0.840f, 1.100f, 1.100f,
+		0.192f, 0.256f, 0.448f, 0.712f,
+		0.500f, 0.676f, 0.896f, 0.896f
+	};
+	static const float BlackLevel = 0.312f;
+	static const float WhiteLevel = 1.100f;
+
+	// Colour burst phase, in twelfths of a cycle, fitted against the default palette
+	static const float HueOffset = 4.0f;
+	// Hann windows of the decoder, in samples. Luma keeps some subcarrier, hence the dot crawl.
+	static const float LumaWindow = 18.0f;
+	static const float ChromaWindow = 24.0f;
+
+	// Colour of the pixels past the sides of the picture
+	static const uint16 BorderColorIndex = 0x0F;
+
+	static const float Pi = 3.14159265358979f;
+
+	static bool isInColorPhase(uint32 color, uint32 phase)
+	{
+		return (color + phase) % PhasesPerCycle < PhasesPerCycle / 2;
+	}
+
+	// Signal of a colour index at one of the 12 subcarrier phases, 0 being black and 1 white
+	static float compositeSignal(uint16 colorIndex, uint32 phase)
+	{
+		uint32 color = colorIndex & 0x0F;
+		uint32 level = (colorIndex >> 4) & 0x03;
+		uint32 emphasis = (colorIndex >> 6) & 0x07;
+
+		if (color > 13)
+		{
+			level = 1;
+		}
+
+		bool isAttenuated = ((emphasis & SUKINES_BIT(0)) && isInColorPhase(0, phase))
+			|| ((emphasis & SUKINES_BIT(1)) && isInColorPhase(4, phase))
+			|| ((emphasis & SUKINES_BIT(2)) && isInColorPhase(8, phase));
+		uint32 attenuation = isAttenuated ? 8 : 0;
+
+		float low = SignalLevels[attenuation + level];
+		float high = SignalLevels[attenuation + 4 + level];
+		if (color == 0)
+		{
+			low = high;
+		}
+		if (color > 12)
+		{
+			high = low;
+		}
+
+		float signal = isInColorPhase(color, phase) ? high : low;
+		return (signal - BlackLevel) / (WhiteLevel - BlackLevel);
+	}
+
+	// Normalized so the weights of whole samples add up to 1
+	static float hannWindow(float offset, float width)
+	{
+		if (std::fabs(offset) >= width / 2.0f)
+		{
+			return 0.0f;
+		}
+
+		return (1.0f + std::cos(2.0f * Pi * offset / width)) / width;
+	}
+
+	static inline sint32 addSaturated(sint32 sum, sint32 value)
+	{
+		return std::min<sint32>(std::max<sint32>(sum + value, -32768), 32767);
+	}
+
+	void filterNtscScanlineScalar(const NtscKernel* const* pixelKernels, uint32* output)
+	{
+		for (uint32 x = 0; x < FrameWidth; ++x)
+		{
+			byte channels[12];
+			for (uint32 lane = 0; lane < 12; ++lane)
+			{
+				sint32 sum = 0;
+				for (uint32 k = 0; k < NtscKernelSize; ++k)
+				{
+					sum = addSaturated(sum, pixelKernels[x + k][k].values[lane]);
+				}
+
+				channels[lane] = static_cast<byte>(std::min<sint32>(std::max<sint32>(sum >> NtscFractionBits, 0), 255));
+			}
+
+			for (uint32 pixel = 0; pixel < OutputPixelsPerPixel; ++pixel)
+			{
+				const byte* bgra = channels + pixel * 4;
+				output[x * OutputPixelsPerPixel + pixel] = (bgra[3] << 24) | (bgra[2] << 16) | (bgra[1] << 8) | bgra[0];
+			}
+		}
+	}
+
+#ifdef SUKINES_ARCH_X86
+	// 16 bytes hold the 3 output pixels and one spare, the next pixel overwrites it
+	SUKINES_TARGET_SSE2 static inline void storeOutputPixels(__m128i pixels, uint32 x, uint32* output)
+	{
+		uint32* destination = output + x * OutputPixelsPerPixel;
+		if (x + 1 < FrameWidth)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination), pixels);
+		}
+		else
+		{
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(destination), pixels);
+			destination[2] = static_cast<uint32>(_mm_cvtsi128_si32(_mm_srli_si128(pixels, 8)));
+		}
+	}
+
+	SUKINES_TARGET_SSE2 void filterNtscScanlineSSE2(const NtscKernel* const* pixelKernels, uint32* output)
+	{
+		for (uint32 x = 0; x < FrameWidth; ++x)
+		{
+			const __m128i* kernel = reinterpret_cast<const __m128i*>(pixelKernels[x][0].values);
+			__m128i low = _mm_loadu_si128(kernel);
+			__m128i high = _mm_loadu_si128(kernel + 1);
+
+			for (uint32 k = 1; k < NtscKernelSize; ++k)
+			{
+				kernel = reinterpret_cast<const __m128i*>(pixelKernels[x + k][k].values);
+				low = _mm_adds_epi16(low, _mm_loadu_si128(kernel));
+				high = _mm_adds_epi16(high, _mm_loadu_si128(kernel + 1));
+			}
+
+			low = _mm_srai_epi16(low, NtscFractionBits);
+			high = _mm_srai_epi16(high, NtscFractionBits);
+			storeOutputPixels(_mm_packus_epi16(low, high), x, output);
+		}
+	}
+
+	SUKINES_TARGET_AVX2 void filterNtscScanlineAVX2(const NtscKernel* const* pixelKernels, uint32* output)
+	{
+		for (uint32 x = 0; x < FrameWidth; ++x)
+		{
+			__m256i sum = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixelKernels[x][0].values));
+
+			for (uint32 k = 1; k < NtscKernelSize; ++k)
+			{
+				sum = _mm256_adds_epi16(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixelKernels[x + k][k].values)));
+			}
+
+			sum = _mm256_srai_epi16(sum, NtscFractionBits);
+			storeOutputPixels(_mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1)), x, output);
+		}
+	}
+#endif
+
+	FilterNtscScanlineFunction selectFilterNtscScanline()
+	{
+#ifdef SUKINES_ARCH_X86
+		const CpuFeatures& features = hostCpuFeatures();
+		if (features.avx2)
+		{
+			return &filterNtscScanlineAVX2;
+		}
+		else if (features.sse2)
+		{
+			return &filterNtscScanlineSSE2;
+		}
+#endif
+		return &filterNtscScanlineScalar;
+	}
+
+	NtscFilter::NtscFilter()
+	: _kernels(RgbPalette::EntryCount * NtscPhaseCount * NtscKernelSize)
+	, _filterScanline(selectFilterNtscScanline())
+	{
+		_computeKernels();
+	}
+
+	void NtscFilter::filter(const FrameBuffer& source, uint32 burstPhase, const FrameBuffer& destination, uint32 firstY, uint32 lineCount) const
+	{
+		sukiAssert(source.format == PixelFormat::ColorIndex && destination.format == PixelFormat::RGB32);
+		sukiAssert(firstY + lineCount <= FrameHeight);
+
+		const NtscKernel* pixelKernels[FrameWidth + NtscKernelRadius * 2];
+
+		for (uint32 y = firstY; y < firstY + lineCount; ++y)
+		{
+			// Each scanline is 341 dots of 8 samples, 4 phases further than the previous one
+			uint32 linePhase = (burstPhase + y) % NtscPhaseCount;
+
+			scanlineKernels(reinterpret_cast<const uint16*>(source.scanline(y)), linePhase, pixelKernels);
+			_filterScanline(pixelKernels, reinterpret_cast<uint32*>(destination.scanline(y)));
+		}
+	}
+
+	void NtscFilter::scanlineKernels(const uint16* indices, uint32 linePhase, const NtscKernel** pixelKernels) const
+	{
+		// Each pixel is 8 samples, 2 thirds of a cycle further than the previous one
+		uint32 phase = (linePhase + NtscPhaseCount * NtscKernelRadius - 2 * NtscKernelRadius) % NtscPhaseCount;
+
+		for (uint32 paddedX = 0; paddedX < FrameWidth + NtscKernelRadius * 2; ++paddedX)
+		{
+			uint32 x = paddedX - NtscKernelRadius;
+			uint16 colorIndex = (x < FrameWidth) ? (indices[x] & (RgbPalette::EntryCount - 1)) : BorderColorIndex;
+
+			pixelKernels[paddedX] = &_kernels[(colorIndex * NtscPhaseCount + phase) * NtscKernelSize];
+			phase = (phase + 2) % NtscPhaseCount;
+		}
+	}
+
+	void NtscFilter::_computeKernels()
+	{
+		for (uint32 colorIndex = 0; colorIndex < RgbPalette::EntryCount; ++colorIndex)
+		{
+			for (uint32 pixelPhase = 0; pixelPhase < NtscPhaseCount; ++pixelPhase)
+			{
+				for (uint32 k = 0; k < NtscKernelSize; ++k)
+				{
+					NtscKernel& kernel = _kernels[(colorIndex * NtscPhaseCount + pixelPhase) * NtscKernelSize + k];
+					std::fill(std::begin(kernel.values), std::end(kernel.values), 0);
+
+					// Position of this pixel relative to the pixel whose output it contributes to, in samples
+					float distance = (static_cast<float>(k) - NtscKernelRadius) * SamplesPerPixel;
+
+					for (uint32 pixel = 0; pixel < OutputPixelsPerPixel; ++pixel)
+					{
+						float outputX = (pixel + 0.5f) * SamplesPerPixel / OutputPixelsPerPixel;
+
+						float y = 0.0f;
+						float i = 0.0f;
+						float q = 0.0f;
+						for (uint32 sample = 0; sample < SamplesPerPixel; ++sample)
+						{
+							uint32 phase = (pixelPhase * PhasesPerPixelPhase + sample) % PhasesPerCycle;
+							float offset = outputX - (distance + sample + 0.5f);
+							float signal = compositeSignal(static_cast<uint16>(colorIndex), phase);
+							float chroma = signal * hannWindow(offset, ChromaWindow);
+							float angle = 2.0f * Pi * (phase + HueOffset) / PhasesPerCycle;
+
+							y += signal * hannWindow(offset, LumaWindow);
+							i += chroma * std::cos(angle);
+							q += chroma * std::sin(angle);
+						}
+
+						float rgb[3] =
+						{
+							y + 0.956f * i + 0.621f * q,
+							y - 0.272f * i - 0.647f * q,
+							y - 1.106f * i + 1.703f * q
+						};
+
+						sint16* bgra = kernel.values + pixel * 4;
+						float scale = 255.0f * (1 << NtscFractionBits);
+						for (uint32 channel = 0; channel < 3; ++channel)
+						{
+							bgra[2 - channel] = static_cast<sint16>(std::floor(rgb[channel] * scale + 0.5f));
+						}
+
+						if (k == NtscKernelRadius)
+						{
+							// Rounding of the sum, and an opaque alpha
+							for (uint32 channel = 0; channel < 3; ++channel)
+							{
+								bgra[channel] += 1 << (NtscFractionBits - 1);
+							}
+							bgra[3] = 255 << NtscFractionBits;
+						}
+					}
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+// STL includes
+#include <vector>
+
+// Local includes
+#include "framebuffer.h"
+
+namespace sukiNES
+{
+	static const uint32 NtscOutputWidth = FrameWidth * 3;
+	// Colour subcarrier phases a pixel can start on, in thirds of a cycle
+	static const uint32 NtscPhaseCount = 3;
+	// Pixels on each side contributing to an output pixel
+	static const uint32 NtscKernelRadius = 2;
+	static const uint32 NtscKernelSize = NtscKernelRadius * 2 + 1;
+
+	/**
+	 * @brief Contribution of one pixel to the 3 output pixels of a neighbour
+	 *
+	 * BGRA of each output pixel in fixed point, NtscFractionBits bits of fraction.
+	 * The 4 last values are padding.
+	 */
+	struct NtscKernel
+	{
+		sint16 values[16];
+	};
+
+	static const uint32 NtscFractionBits = 5;
+
+	/**
+	 * @brief Filter one scanline
+	 * @param pixelKernels Kernels of the pixels from -NtscKernelRadius to FrameWidth + NtscKernelRadius - 1,
+	 *        output pixels of pixel x are the sum of kernel k of pixelKernels[x + k]
+	 * @param output NtscOutputWidth RGB32 pixels
+	 */
+	typedef void (*FilterNtscScanlineFunction)(const NtscKernel* const* pixelKernels, uint32* output);
+
+	void filterNtscScanlineScalar(const NtscKernel* const* pixelKernels, uint32* output);
+#ifdef SUKINES_ARCH_X86
+	void filterNtscScanlineSSE2(const NtscKernel* const* pixelKernels, uint32* output);
+	void filterNtscScanlineAVX2(const NtscKernel* const* pixelKernels, uint32* output);
+#endif
+
+	/**
+	 * @brief Fastest scanline kernel supported by the host CPU
+	 */
+	FilterNtscScanlineFunction selectFilterNtscScanline();
+
+	/**
+	 * @brief Composite video look: artifact colours, colour fringes and dot crawl
+	 *
+	 * Each pixel is turned into the 8 samples of the NES composite signal for its
+	 * colour index and emphasis, then decoded back to RGB at 3 output pixels per
+	 * pixel. Since decoding is linear, the output of every colour index and
+	 * subcarrier phase on its neighbours is computed once, filtering only adds them up.
+	 */
+	class NtscFilter
+	{
+	public:
+		NtscFilter();
+
+		/**
+		 * @brief Filter scanlines of a ColorIndex frame
+		 * @param source ColorIndex frame
+		 * @param burstPhase FrameInfo::burstPhase of the frame
+		 * @param destination RGB32 frame at least NtscOutputWidth pixels wide
+		 * @param firstY First scanline to filter
+		 * @param lineCount Number of scanlines to filter
+		 *
+		 * Safe to call from several threads on different scanlines.
+		 */
+		void filter(const FrameBuffer& source, uint32 burstPhase, const FrameBuffer& destination, uint32 firstY = 0, uint32 lineCount = FrameHeight) const;
+
+		/**
+		 * @brief Kernels of each pixel of a scanline, padded with black
+		 * @param indices FrameWidth colour indices
+		 * @param linePhase Subcarrier phase of the first pixel, in thirds of a cycle
+		 * @param pixelKernels FrameWidth + NtscKernelRadius * 2 pointers
+		 */
+		void scanlineKernels(const uint16* indices, uint32 linePhase, const NtscKernel** pixelKernels) const;
+
+	private:
+		void _computeKernels();
+
+	private:
+		std::vector<NtscKernel> _kernels;
+		FilterNtscScanlineFunction _filterScanline;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "ntscfilterpool.h"
+
+// STL includes
+#include <cstring>
+
+// Local includes
+#include "assert.h"
+
+namespace sukiNES
+{
+	NtscFilterPool::NtscFilterPool(uint32 threadCount)
+	: _threads(threadCount)
+	, _source(FrameWidth * FrameHeight, 0)
+	{
+	}
+
+	NtscFilterPool::~NtscFilterPool()
+	{
+		// The workers read the filter and the source copy
+		_threads.wait();
+	}
+
+	void NtscFilterPool::setDestination(const FrameBuffer& destination)
+	{
+		sukiAssert(destination.format == PixelFormat::RGB32);
+
+		_destination = destination;
+	}
+
+	void NtscFilterPool::setFrameFilteredCallback(const std::function<void()>& callback)
+	{
+		_threads.setJobDoneCallback(callback);
+	}
+
+	bool NtscFilterPool::submit(const FrameBuffer& source, uint32 burstPhase)
+	{
+		sukiAssert(source.format == PixelFormat::ColorIndex);
+
+		// Only this thread starts jobs, the workers cannot become busy meanwhile
+		if (_threads.isBusy() || !_destination.pixels)
+		{
+			return false;
+		}
+
+		// The workers are idle, the PPU may overwrite source as soon as this returns
+		for (uint32 y = 0; y < FrameHeight; ++y)
+		{
+			memcpy(&_source[y * FrameWidth], source.scanline(y), FrameWidth * sizeof(uint16));
+		}
+
+		FrameBuffer copy(reinterpret_cast<byte*>(_source.data()), FrameWidth * sizeof(uint16), PixelFormat::ColorIndex);
+		FrameBuffer destination = _destination;
+		const NtscFilter& filter = _filter;
+
+		return _threads.run([&filter, copy, burstPhase, destination] (uint32 firstY, uint32 lineCount) {
+			filter.filter(copy, burstPhase, destination, firstY, lineCount);
+		});
+	}
+}
\ No newline at end of file
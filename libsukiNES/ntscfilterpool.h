@@ -0,0 +1,76 @@
+#pragma once
+
+// STL includes
+#include <functional>
+#include <vector>
+
+// Local includes
+#include "bandthreadpool.h"
+#include "framebuffer.h"
+#include "ntscfilter.h"
+
+namespace sukiNES
+{
+	/**
+	 * @brief Runs an NtscFilter on worker threads, each filtering a band of scanlines
+	 *
+	 * submit() copies the frame and returns at once, so the emulation thread
+	 * never waits for the filter. A frame submitted while the previous one is
+	 * still being filtered is dropped.
+	 */
+	class NtscFilterPool
+	{
+	public:
+		/**
+		 * @param threadCount Worker threads, 0 for one per hardware thread besides the emulation thread
+		 */
+		explicit NtscFilterPool(uint32 threadCount = 0);
+		~NtscFilterPool();
+
+		/**
+		 * @brief RGB32 frame the workers write to, at least NtscOutputWidth pixels wide
+		 *
+		 * Only change it while the pool is idle.
+		 */
+		void setDestination(const FrameBuffer& destination);
+
+		/**
+		 * @brief Called on a worker thread once a frame is completely filtered
+		 *
+		 * The next frame is not accepted before the callback returns.
+		 */
+		void setFrameFilteredCallback(const std::function<void()>& callback);
+
+		/**
+		 * @brief Start filtering a ColorIndex frame
+		 * @param burstPhase FrameInfo::burstPhase of the frame
+		 * @return false when the previous frame is still being filtered, this one is dropped
+		 */
+		bool submit(const FrameBuffer& source, uint32 burstPhase);
+
+		bool isBusy() const
+		{
+			return _threads.isBusy();
+		}
+
+		/**
+		 * @brief Wait until the submitted frame is filtered
+		 */
+		void wait()
+		{
+			_threads.wait();
+		}
+
+		uint32 threadCount() const
+		{
+			return _threads.threadCount();
+		}
+
+	private:
+		NtscFilter _filter;
+		BandThreadPool _threads;
+
+		std::vector<uint16> _source;
+		FrameBuffer _destination;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "observation.h"
+
+#ifdef SUKINES_ARCH_X86
+#include <emmintrin.h>
+#endif
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+
+// Local includes
+#include "assert.h"
+#include "cpufeatures.h"
+#include "rgbpalette.h"
+
+namespace sukiNES
+{
+	static const uint32 DefaultObservationSize = 84;
+
+	// Sums of up to FrameHeight rows of bytes fit in 16 bits
+	static void accumulateRowScalar(const byte* row, uint32 count, uint16* sums)
+	{
+		for (uint32 x = 0; x < count; ++x)
+		{
+			sums[x] = static_cast<uint16>(sums[x] + row[x]);
+		}
+	}
+
+#ifdef SUKINES_ARCH_X86
+	SUKINES_TARGET_SSE2 static void accumulateRowSSE2(const byte* row, uint32 count, uint16* sums)
+	{
+		__m128i zero = _mm_setzero_si128();
+
+		uint32 x = 0;
+		for (; x + 16 <= count; x += 16)
+		{
+			__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+			__m128i* low = reinterpret_cast<__m128i*>(sums + x);
+			__m128i* high = reinterpret_cast<__m128i*>(sums + x + 8);
+
+			_mm_storeu_si128(low, _mm_add_epi16(_mm_loadu_si128(low), _mm_unpacklo_epi8(pixels, zero)));
+			_mm_storeu_si128(high, _mm_add_epi16(_mm_loadu_si128(high), _mm_unpackhi_epi8(pixels, zero)));
+		}
+
+		accumulateRowScalar(row + x, count - x, sums + x);
+	}
+#endif
+
+	ObservationSettings::ObservationSettings()
+	: cropX(0)
+	, cropY(0)
+	, cropWidth(FrameWidth)
+	, cropHeight(FrameHeight)
+	, width(DefaultObservationSize)
+	, height(DefaultObservationSize)
+	, filter(DownsampleFilter::AreaAverage)
+	, format(PixelFormat::Grayscale)
+	, stackSize(1)
+	{
+	}
+
+	ObservationStack::ObservationStack()
+	: _output(nullptr)
+	, _frameCount(0)
+	, _convertColorIndices(selectConvertColorIndices())
+	, _accumulateRow(&accumulateRowScalar)
+	{
+#ifdef SUKINES_ARCH_X86
+		if (hostCpuFeatures().sse2)
+		{
+			_accumulateRow = &accumulateRowSSE2;
+		}
+#endif
+		std::fill(std::begin(_grayscaleRow), std::end(_grayscaleRow), 0);
+		std::fill(std::begin(_columnSums), std::end(_columnSums), 0);
+	}
+
+	void ObservationStack::setup(const ObservationSettings& settings, byte* output)
+	{
+		sukiAssert(settings.cropX + settings.cropWidth <= FrameWidth && settings.cropY + settings.cropHeight <= FrameHeight);
+		sukiAssert(settings.width > 0 && settings.height > 0 && settings.stackSize > 0);
+		sukiAssert(settings.format == PixelFormat::Grayscale || settings.format == PixelFormat::PaletteIndex);
+		sukiAssertWithMessage(settings.filter == DownsampleFilter::Nearest || (settings.format == PixelFormat::Grayscale && settings.width <= settings.cropWidth && settings.height <= settings.cropHeight),
+			"AreaAverage only downsamples grayscale observations");
+
+		_settings = settings;
+		_output = output;
+
+		_columns.resize(settings.width + 1);
+		_rows.resize(settings.height + 1);
+
+		if (settings.filter == DownsampleFilter::Nearest)
+		{
+			// Centre of each observation pixel
+			for (uint32 x = 0; x < settings.width; ++x)
+			{
+				_columns[x] = settings.cropX + (2 * x + 1) * settings.cropWidth / (2 * settings.width);
+			}
+			for (uint32 y = 0; y < settings.height; ++y)
+			{
+				_rows[y] = settings.cropY + (2 * y + 1) * settings.cropHeight / (2 * settings.height);
+			}
+		}
+		else
+		{
+			// Box x covers the crop columns from _columns[x] up to _columns[x + 1]
+			for (uint32 x = 0; x <= settings.width; ++x)
+			{
+				_columns[x] = x * settings.cropWidth / settings.width;
+			}
+			for (uint32 y = 0; y <= settings.height; ++y)
+			{
+				_rows[y] = settings.cropY + y * settings.cropHeight / settings.height;
+			}
+		}
+
+		reset();
+	}
+
+	void ObservationStack::reset()
+	{
+		_frameCount = 0;
+
+		if (_output)
+		{
+			memset(_output, 0, _settings.outputSize());
+		}
+	}
+
+	void ObservationStack::addFrame(const FrameBuffer& frame, const RgbPalette& palette)
+	{
+		sukiAssert(frame.format == PixelFormat::ColorIndex || frame.format == PixelFormat::PaletteIndex);
+
+		if (!_output)
+		{
+			return;
+		}
+
+		byte* output = _output + (_frameCount % _settings.stackSize) * _settings.width * _settings.height;
+		if (_settings.filter == DownsampleFilter::Nearest)
+		{
+			_sampleNearest(frame, palette, output);
+		}
+		else
+		{
+			_averageArea(frame, palette, output);
+		}
+
+		++_frameCount;
+	}
+
+	void ObservationStack::_sampleNearest(const FrameBuffer& frame, const RgbPalette& palette, byte* output) const
+	{
+		bool isGrayscale = _settings.format == PixelFormat::Grayscale;
+		const byte* grayscale = palette.grayscale();
+
+		for (uint32 y = 0; y < _settings.height; ++y)
+		{
+			const byte* scanline = frame.scanline(_rows[y]);
+			byte* outputRow = output + y * _settings.width;
+
+			if (frame.format == PixelFormat::ColorIndex)
+			{
+				const uint16* indices = reinterpret_cast<const uint16*>(scanline);
+				for (uint32 x = 0; x < _settings.width; ++x)
+				{
+					uint16 index = indices[_columns[x]];
+					outputRow[x] = isGrayscale ? grayscale[index & (RgbPalette::EntryCount - 1)] : static_cast<byte>(index & (RgbPalette::ColorCount - 1));
+				}
+			}
+			else
+			{
+				for (uint32 x = 0; x < _settings.width; ++x)
+				{
+					byte paletteValue = scanline[_columns[x]];
+					outputRow[x] = isGrayscale ? grayscale[paletteValue & (RgbPalette::ColorCount - 1)] : paletteValue;
+				}
+			}
+		}
+	}
+
+	void ObservationStack::_averageArea(const FrameBuffer& frame, const RgbPalette& palette, byte* output)
+	{
+		for (uint32 y = 0; y < _settings.height; ++y)
+		{
+			// Column sums of the rows in the box, then the sum of each box
+			std::fill(_columnSums, _columnSums + _settings.cropWidth, 0);
+			for (uint32 frameY = _rows[y]; frameY < _rows[y + 1]; ++frameY)
+			{
+				_convertRowToGrayscale(frame, palette, frameY);
+				_accumulateRow(_grayscaleRow, _settings.cropWidth, _columnSums);
+			}
+
+			uint32 boxHeight = _rows[y + 1] - _rows[y];
+			byte* outputRow = output + y * _settings.width;
+
+			for (uint32 x = 0; x < _settings.width; ++x)
+			{
+				uint32 sum = 0;
+				for (uint32 column = _columns[x]; column < _columns[x + 1]; ++column)
+				{
+					sum += _columnSums[column];
+				}
+
+				uint32 area = (_columns[x + 1] - _columns[x]) * boxHeight;
+				outputRow[x] = static_cast<byte>((sum + area / 2) / area);
+			}
+		}
+	}
+
+	void ObservationStack::_convertRowToGrayscale(const FrameBuffer& frame, const RgbPalette& palette, uint32 y)
+	{
+		const byte* scanline = frame.scanline(y);
+
+		if (frame.format == PixelFormat::ColorIndex)
+		{
+			const uint16* indices = reinterpret_cast<const uint16*>(scanline) + _settings.cropX;
+			_convertColorIndices(indices, _settings.cropWidth, palette, PixelFormat::Grayscale, _grayscaleRow);
+		}
+		else
+		{
+			const byte* grayscale = palette.grayscale();
+			for (uint32 x = 0; x < _settings.cropWidth; ++x)
+			{
+				_grayscaleRow[x] = grayscale[scanline[_settings.cropX + x] & (RgbPalette::ColorCount - 1)];
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+// STL includes
+#include <vector>
+
+// Local includes
+#include "colorconversion.h"
+#include "framebuffer.h"
+
+namespace sukiNES
+{
+	class RgbPalette;
+
+	enum class DownsampleFilter
+	{
+		Nearest,
+		AreaAverage
+	};
+
+	/**
+	 * @brief Shape of the observations built from each frame
+	 *
+	 * Defaults to the whole frame downsampled to 84x84 grayscale with area averaging.
+	 */
+	struct ObservationSettings
+	{
+		// Part of the frame kept
+		uint32 cropX;
+		uint32 cropY;
+		uint32 cropWidth;
+		uint32 cropHeight;
+
+		// Size of an observation, at most the crop size with AreaAverage
+		uint32 width;
+		uint32 height;
+		DownsampleFilter filter;
+		// Grayscale or PaletteIndex, one byte per pixel. AreaAverage needs Grayscale.
+		PixelFormat format;
+		// Observations of the last frames kept in the output
+		uint32 stackSize;
+
+		ObservationSettings();
+
+		/**
+		 * @brief Bytes needed for stackSize observations
+		 */
+		uint32 outputSize() const
+		{
+			return stackSize * width * height;
+		}
+	};
+
+	/**
+	 * @brief Small observations of the last frames, for machine learning agents
+	 *
+	 * Each frame added is cropped, downsampled and written to the next slot of
+	 * a ring of stackSize observations in caller-provided memory. Slot N starts
+	 * at output + N * width * height, rows are width bytes apart.
+	 */
+	class ObservationStack
+	{
+	public:
+		ObservationStack();
+
+		/**
+		 * @brief Write observations of the following frames to output
+		 * @param output settings.outputSize() bytes, nullptr stops
+		 */
+		void setup(const ObservationSettings& settings, byte* output);
+
+		const ObservationSettings& settings() const
+		{
+			return _settings;
+		}
+
+		/**
+		 * @brief Clear the output and start again from slot 0, for a new episode
+		 */
+		void reset();
+
+		/**
+		 * @brief Add the observation of a ColorIndex or PaletteIndex frame
+		 *
+		 * Emphasis is only part of the grayscale of ColorIndex frames.
+		 */
+		void addFrame(const FrameBuffer& frame, const RgbPalette& palette);
+
+		/**
+		 * @brief Frames added since the last reset
+		 */
+		uint32 frameCount() const
+		{
+			return _frameCount;
+		}
+
+		/**
+		 * @brief Slot of the last frame added, the previous frames are in the slots before it
+		 */
+		uint32 newestSlot() const
+		{
+			return _frameCount > 0 ? (_frameCount - 1) % _settings.stackSize : 0;
+		}
+
+		const byte* observation(uint32 slot) const
+		{
+			return _output + slot * _settings.width * _settings.height;
+		}
+
+	private:
+		void _sampleNearest(const FrameBuffer& frame, const RgbPalette& palette, byte* output) const;
+		void _averageArea(const FrameBuffer& frame, const RgbPalette& palette, byte* output);
+		void _convertRowToGrayscale(const FrameBuffer& frame, const RgbPalette& palette, uint32 y);
+
+	private:
+		typedef void (*AccumulateRowFunction)(const byte* row, uint32 count, uint16* sums);
+
+		ObservationSettings _settings;
+		byte* _output;
+		uint32 _frameCount;
+
+		ConvertColorIndicesFunction _convertColorIndices;
+		AccumulateRowFunction _accumulateRow;
+
+		// Frame columns and rows sampled by Nearest, boundaries of the boxes averaged by AreaAverage
+		std::vector<uint32> _columns;
+		std::vector<uint32> _rows;
+
+		byte _grayscaleRow[FrameWidth];
+		uint16 _columnSums[FrameWidth];
+	};
+}
\ No newline at end of file
@@ -0,0 +1,613 @@
+#include "pixelscaler.h"
+
+#ifdef SUKINES_ARCH_X86
+#include <emmintrin.h>
+#endif
+
+// STL includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// Local includes
+#include "assert.h"
+#include "cpufeatures.h"
+
+namespace sukiNES
+{
+	static const uint32 PaddedWidth = FrameWidth + ScaleBorder * 2;
+	static const uint32 PaddedHeight = FrameHeight + ScaleBorder * 2;
+
+	// Weights of the YUV distance used by xBR
+	static const uint32 LumaWeight = 48;
+	static const uint32 BlueDifferenceWeight = 7;
+	static const uint32 RedDifferenceWeight = 6;
+	// xBR sums its distances on 16 bits, saturating
+	static const uint32 MaxDistanceSum = 0xFFFF;
+
+	static inline const uint32* pixelAt(const ScaleRows& rows, sint32 x, sint32 dx, sint32 dy)
+	{
+		return rows.pixels[ScaleBorder + dy] + x + dx;
+	}
+
+	// Average of each channel, rounded up like _mm_avg_epu8
+	static inline uint32 average(uint32 a, uint32 b)
+	{
+		return (a | b) - (((a ^ b) & 0xFEFEFEFE) >> 1);
+	}
+
+	static void nearest2xScalar(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		const uint32* row = rows.pixels[ScaleBorder];
+		for (uint32 x = 0; x < FrameWidth; ++x)
+		{
+			outputRows[0][x * 2] = outputRows[0][x * 2 + 1] = row[x];
+			outputRows[1][x * 2] = outputRows[1][x * 2 + 1] = row[x];
+		}
+	}
+
+	static void nearest3xScalar(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		const uint32* row = rows.pixels[ScaleBorder];
+		for (uint32 y = 0; y < 3; ++y)
+		{
+			for (uint32 x = 0; x < FrameWidth; ++x)
+			{
+				outputRows[y][x * 3] = outputRows[y][x * 3 + 1] = outputRows[y][x * 3 + 2] = row[x];
+			}
+		}
+	}
+
+	// See http://scale2x.sourceforge.net/algorithm.html
+	// A B C
+	// D E F
+	// G H I
+	static void scale2xScalar(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		for (uint32 x = 0; x < FrameWidth; ++x)
+		{
+			uint32 B = *pixelAt(rows, x, 0, -1);
+			uint32 D = *pixelAt(rows, x, -1, 0);
+			uint32 E = *pixelAt(rows, x, 0, 0);
+			uint32 F = *pixelAt(rows, x, 1, 0);
+			uint32 H = *pixelAt(rows, x, 0, 1);
+
+			uint32* top = outputRows[0] + x * 2;
+			uint32* bottom = outputRows[1] + x * 2;
+
+			if (B != H && D != F)
+			{
+				top[0] = D == B ? D : E;
+				top[1] = B == F ? F : E;
+				bottom[0] = D == H ? D : E;
+				bottom[1] = H == F ? F : E;
+			}
+			else
+			{
+				top[0] = top[1] = bottom[0] = bottom[1] = E;
+			}
+		}
+	}
+
+	static void scale3xScalar(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		for (uint32 x = 0; x < FrameWidth; ++x)
+		{
+			uint32 A = *pixelAt(rows, x, -1, -1);
+			uint32 B = *pixelAt(rows, x, 0, -1);
+			uint32 C = *pixelAt(rows, x, 1, -1);
+			uint32 D = *pixelAt(rows, x, -1, 0);
+			uint32 E = *pixelAt(rows, x, 0, 0);
+			uint32 F = *pixelAt(rows, x, 1, 0);
+			uint32 G = *pixelAt(rows, x, -1, 1);
+			uint32 H = *pixelAt(rows, x, 0, 1);
+			uint32 I = *pixelAt(rows, x, 1, 1);
+
+			uint32* top = outputRows[0] + x * 3;
+			uint32* middle = outputRows[1] + x * 3;
+			uint32* bottom = outputRows[2] + x * 3;
+
+			if (B != H && D != F)
+			{
+				top[0] = D == B ? D : E;
+				top[1] = (D == B && E != C) || (B == F && E != A) ? B : E;
+				top[2] = B == F ? F : E;
+				middle[0] = (D == B && E != G) || (D == H && E != A) ? D : E;
+				middle[1] = E;
+				middle[2] = (B == F && E != I) || (H == F && E != C) ? F : E;
+				bottom[0] = D == H ? D : E;
+				bottom[1] = (D == H && E != I) || (H == F && E != G) ? H : E;
+				bottom[2] = H == F ? F : E;
+			}
+			else
+			{
+				top[0] = top[1] = top[2] = E;
+				middle[0] = middle[1] = middle[2] = E;
+				bottom[0] = bottom[1] = bottom[2] = E;
+			}
+		}
+	}
+
+	// YUV distance used by xBR, fits in 15 bits
+	static void yuvDistancesScalar(const sint16* const* first, const sint16* const* second, uint32 count, uint16* output)
+	{
+		for (uint32 x = 0; x < count; ++x)
+		{
+			output[x] = static_cast<uint16>(std::abs(first[0][x] - second[0][x]) * LumaWeight
+				+ std::abs(first[1][x] - second[1][x]) * BlueDifferenceWeight
+				+ std::abs(first[2][x] - second[2][x]) * RedDifferenceWeight);
+		}
+	}
+
+	// Distance between neighbours (ax, ay) and (bx, by) of pixel x
+	static inline const uint16* neighbourDistance(const ScaleRows& rows, sint32 x, sint32 ax, sint32 ay, sint32 bx, sint32 by)
+	{
+		// Distances are stored on the upper pixel, or the left one on the same scanline
+		if (by < ay || (by == ay && bx < ax))
+		{
+			std::swap(ax, bx);
+			std::swap(ay, by);
+		}
+
+		const uint16* const* plane = rows.downLeftDistance;
+		if (by == ay)
+		{
+			plane = rows.rightDistance;
+		}
+		else if (bx == ax)
+		{
+			plane = rows.downDistance;
+		}
+		else if (bx > ax)
+		{
+			plane = rows.downRightDistance;
+		}
+
+		return plane[ScaleBorder + ay] + x + ax;
+	}
+
+	static inline uint32 yuvDistance(const ScaleRows& rows, sint32 x, sint32 ax, sint32 ay, sint32 bx, sint32 by)
+	{
+		return *neighbourDistance(rows, x, ax, ay, bx, by);
+	}
+
+	static inline uint32 addSaturated(uint32 a, uint32 b)
+	{
+		uint32 sum = a + b;
+		return sum > MaxDistanceSum ? MaxDistanceSum : sum;
+	}
+
+	// xBR by Hyllian, level 1 edge rule
+	// Output pixel in the corner of E towards (sx, sy), here the bottom right one:
+	//      A1 B1 C1
+	//   A0 A  B  C  C4
+	//   D0 D  E  F  F4
+	//   G0 G  H  I  I4
+	//      G5 H5 I5
+	// An edge runs along H-F when E, I and their neighbours differ more across
+	// it than along it, E is then blended with the closest of F and H.
+	static inline uint32 xbrCorner(const ScaleRows& rows, sint32 x, sint32 sx, sint32 sy)
+	{
+		uint32 E = *pixelAt(rows, x, 0, 0);
+		uint32 F = *pixelAt(rows, x, sx, 0);
+		uint32 H = *pixelAt(rows, x, 0, sy);
+
+		if (E == F || E == H)
+		{
+			return E;
+		}
+
+		uint32 alongEdge = yuvDistance(rows, x, 0, 0, sx, -sy);
+		alongEdge = addSaturated(alongEdge, yuvDistance(rows, x, 0, 0, -sx, sy));
+		alongEdge = addSaturated(alongEdge, yuvDistance(rows, x, sx, sy, sx * 2, 0));
+		alongEdge = addSaturated(alongEdge, yuvDistance(rows, x, sx, sy, 0, sy * 2));
+		alongEdge = addSaturated(alongEdge, yuvDistance(rows, x, 0, sy, sx, 0) * 4);
+
+		uint32 acrossEdge = yuvDistance(rows, x, 0, sy, -sx, 0);
+		acrossEdge = addSaturated(acrossEdge, yuvDistance(rows, x, 0, sy, sx, sy * 2));
+		acrossEdge = addSaturated(acrossEdge, yuvDistance(rows, x, sx, 0, sx * 2, sy));
+		acrossEdge = addSaturated(acrossEdge, yuvDistance(rows, x, sx, 0, 0, -sy));
+		acrossEdge = addSaturated(acrossEdge, yuvDistance(rows, x, 0, 0, sx, sy) * 4);
+
+		if (alongEdge >= acrossEdge)
+		{
+			return E;
+		}
+
+		uint32 closest = yuvDistance(rows, x, 0, 0, sx, 0) <= yuvDistance(rows, x, 0, 0, 0, sy) ? F : H;
+		return average(E, closest);
+	}
+
+	static void xbr2xScalar(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		for (uint32 x = 0; x < FrameWidth; ++x)
+		{
+			outputRows[0][x * 2] = xbrCorner(rows, x, -1, -1);
+			outputRows[0][x * 2 + 1] = xbrCorner(rows, x, 1, -1);
+			outputRows[1][x * 2] = xbrCorner(rows, x, -1, 1);
+			outputRows[1][x * 2 + 1] = xbrCorner(rows, x, 1, 1);
+		}
+	}
+
+#ifdef SUKINES_ARCH_X86
+	SUKINES_TARGET_SSE2 static inline __m128i loadPixels(const ScaleRows& rows, sint32 x, sint32 dx, sint32 dy)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixelAt(rows, x, dx, dy)));
+	}
+
+	SUKINES_TARGET_SSE2 static inline void storePixels(uint32* output, __m128i pixels)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(output), pixels);
+	}
+
+	SUKINES_TARGET_SSE2 static inline __m128i selectPixels(__m128i mask, __m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	// Stores a0 b0 a1 b1 a2 b2 a3 b3
+	SUKINES_TARGET_SSE2 static inline void storeInterleaved2(uint32* output, __m128i a, __m128i b)
+	{
+		storePixels(output, _mm_unpacklo_epi32(a, b));
+		storePixels(output + 4, _mm_unpackhi_epi32(a, b));
+	}
+
+	// Stores a0 b0 c0 a1 b1 c1 a2 b2 c2 a3 b3 c3
+	SUKINES_TARGET_SSE2 static inline void storeInterleaved3(uint32* output, __m128i a, __m128i b, __m128i c)
+	{
+		__m128 ab = _mm_castsi128_ps(_mm_unpacklo_epi32(a, b));
+		__m128 abHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(a, b));
+		__m128 bc = _mm_castsi128_ps(_mm_unpacklo_epi32(b, c));
+		__m128 bcHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(b, c));
+		__m128 ca = _mm_castsi128_ps(_mm_unpacklo_epi32(c, a));
+		__m128 caHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(c, a));
+
+		storePixels(output, _mm_castps_si128(_mm_shuffle_ps(ab, ca, _MM_SHUFFLE(3, 0, 1, 0))));
+		storePixels(output + 4, _mm_castps_si128(_mm_shuffle_ps(bc, abHigh, _MM_SHUFFLE(1, 0, 3, 2))));
+		storePixels(output + 8, _mm_castps_si128(_mm_shuffle_ps(caHigh, bcHigh, _MM_SHUFFLE(3, 2, 3, 0))));
+	}
+
+	SUKINES_TARGET_SSE2 static void nearest2xSSE2(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		for (uint32 x = 0; x < FrameWidth; x += 4)
+		{
+			__m128i E = loadPixels(rows, x, 0, 0);
+			storeInterleaved2(outputRows[0] + x * 2, E, E);
+			storeInterleaved2(outputRows[1] + x * 2, E, E);
+		}
+	}
+
+	SUKINES_TARGET_SSE2 static void nearest3xSSE2(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		for (uint32 x = 0; x < FrameWidth; x += 4)
+		{
+			__m128i E = loadPixels(rows, x, 0, 0);
+			for (uint32 y = 0; y < 3; ++y)
+			{
+				storeInterleaved3(outputRows[y] + x * 3, E, E, E);
+			}
+		}
+	}
+
+	SUKINES_TARGET_SSE2 static void scale2xSSE2(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		for (uint32 x = 0; x < FrameWidth; x += 4)
+		{
+			__m128i B = loadPixels(rows, x, 0, -1);
+			__m128i D = loadPixels(rows, x, -1, 0);
+			__m128i E = loadPixels(rows, x, 0, 0);
+			__m128i F = loadPixels(rows, x, 1, 0);
+			__m128i H = loadPixels(rows, x, 0, 1);
+
+			__m128i unchanged = _mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F));
+
+			__m128i topLeft = selectPixels(_mm_andnot_si128(unchanged, _mm_cmpeq_epi32(D, B)), D, E);
+			__m128i topRight = selectPixels(_mm_andnot_si128(unchanged, _mm_cmpeq_epi32(B, F)), F, E);
+			__m128i bottomLeft = selectPixels(_mm_andnot_si128(unchanged, _mm_cmpeq_epi32(D, H)), D, E);
+			__m128i bottomRight = selectPixels(_mm_andnot_si128(unchanged, _mm_cmpeq_epi32(H, F)), F, E);
+
+			storeInterleaved2(outputRows[0] + x * 2, topLeft, topRight);
+			storeInterleaved2(outputRows[1] + x * 2, bottomLeft, bottomRight);
+		}
+	}
+
+	SUKINES_TARGET_SSE2 static void scale3xSSE2(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		for (uint32 x = 0; x < FrameWidth; x += 4)
+		{
+			__m128i A = loadPixels(rows, x, -1, -1);
+			__m128i B = loadPixels(rows, x, 0, -1);
+			__m128i C = loadPixels(rows, x, 1, -1);
+			__m128i D = loadPixels(rows, x, -1, 0);
+			__m128i E = loadPixels(rows, x, 0, 0);
+			__m128i F = loadPixels(rows, x, 1, 0);
+			__m128i G = loadPixels(rows, x, -1, 1);
+			__m128i H = loadPixels(rows, x, 0, 1);
+			__m128i I = loadPixels(rows, x, 1, 1);
+
+			__m128i unchanged = _mm_or_si128(_mm_cmpeq_epi32(B, H), _mm_cmpeq_epi32(D, F));
+			__m128i DB = _mm_andnot_si128(unchanged, _mm_cmpeq_epi32(D, B));
+			__m128i BF = _mm_andnot_si128(unchanged, _mm_cmpeq_epi32(B, F));
+			__m128i DH = _mm_andnot_si128(unchanged, _mm_cmpeq_epi32(D, H));
+			__m128i HF = _mm_andnot_si128(unchanged, _mm_cmpeq_epi32(H, F));
+
+			__m128i EA = _mm_cmpeq_epi32(E, A);
+			__m128i EC = _mm_cmpeq_epi32(E, C);
+			__m128i EG = _mm_cmpeq_epi32(E, G);
+			__m128i EI = _mm_cmpeq_epi32(E, I);
+
+			__m128i top = selectPixels(_mm_or_si128(_mm_andnot_si128(EC, DB), _mm_andnot_si128(EA, BF)), B, E);
+			__m128i left = selectPixels(_mm_or_si128(_mm_andnot_si128(EG, DB), _mm_andnot_si128(EA, DH)), D, E);
+			__m128i right = selectPixels(_mm_or_si128(_mm_andnot_si128(EI, BF), _mm_andnot_si128(EC, HF)), F, E);
+			__m128i bottom = selectPixels(_mm_or_si128(_mm_andnot_si128(EI, DH), _mm_andnot_si128(EG, HF)), H, E);
+
+			storeInterleaved3(outputRows[0] + x * 3, selectPixels(DB, D, E), top, selectPixels(BF, F, E));
+			storeInterleaved3(outputRows[1] + x * 3, left, E, right);
+			storeInterleaved3(outputRows[2] + x * 3, selectPixels(DH, D, E), bottom, selectPixels(HF, F, E));
+		}
+	}
+
+	SUKINES_TARGET_SSE2 static inline __m128i weightedDifference(const sint16* first, const sint16* second, uint32 weight)
+	{
+		__m128i difference = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(second)));
+		__m128i absolute = _mm_max_epi16(difference, _mm_sub_epi16(_mm_setzero_si128(), difference));
+		return _mm_mullo_epi16(absolute, _mm_set1_epi16(static_cast<short>(weight)));
+	}
+
+	SUKINES_TARGET_SSE2 static void yuvDistancesSSE2(const sint16* const* first, const sint16* const* second, uint32 count, uint16* output)
+	{
+		uint32 x = 0;
+		for (; x + 8 <= count; x += 8)
+		{
+			__m128i luma = weightedDifference(first[0] + x, second[0] + x, LumaWeight);
+			__m128i blue = weightedDifference(first[1] + x, second[1] + x, BlueDifferenceWeight);
+			__m128i red = weightedDifference(first[2] + x, second[2] + x, RedDifferenceWeight);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(output + x), _mm_add_epi16(_mm_add_epi16(luma, blue), red));
+		}
+
+		const sint16* firstTail[3] = { first[0] + x, first[1] + x, first[2] + x };
+		const sint16* secondTail[3] = { second[0] + x, second[1] + x, second[2] + x };
+		yuvDistancesScalar(firstTail, secondTail, count - x, output + x);
+	}
+
+	SUKINES_TARGET_SSE2 static inline __m128i yuvDistance8(const ScaleRows& rows, sint32 x, sint32 ax, sint32 ay, sint32 bx, sint32 by)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(neighbourDistance(rows, x, ax, ay, bx, by)));
+	}
+
+	SUKINES_TARGET_SSE2 static inline __m128i compareLessUnsigned16(__m128i a, __m128i b)
+	{
+		__m128i signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+		return _mm_cmplt_epi16(_mm_xor_si128(a, signBit), _mm_xor_si128(b, signBit));
+	}
+
+	// Same as xbrCorner() for 8 pixels, returned as two halves of 4
+	SUKINES_TARGET_SSE2 static inline void xbrCorners8(const ScaleRows& rows, sint32 x, sint32 sx, sint32 sy, __m128i& low, __m128i& high)
+	{
+		__m128i E[2] = { loadPixels(rows, x, 0, 0), loadPixels(rows, x + 4, 0, 0) };
+		__m128i F[2] = { loadPixels(rows, x, sx, 0), loadPixels(rows, x + 4, sx, 0) };
+		__m128i H[2] = { loadPixels(rows, x, 0, sy), loadPixels(rows, x + 4, 0, sy) };
+
+		__m128i flat = _mm_packs_epi32(
+			_mm_or_si128(_mm_cmpeq_epi32(E[0], F[0]), _mm_cmpeq_epi32(E[0], H[0])),
+			_mm_or_si128(_mm_cmpeq_epi32(E[1], F[1]), _mm_cmpeq_epi32(E[1], H[1])));
+
+		__m128i alongEdge = yuvDistance8(rows, x, 0, 0, sx, -sy);
+		alongEdge = _mm_adds_epu16(alongEdge, yuvDistance8(rows, x, 0, 0, -sx, sy));
+		alongEdge = _mm_adds_epu16(alongEdge, yuvDistance8(rows, x, sx, sy, sx * 2, 0));
+		alongEdge = _mm_adds_epu16(alongEdge, yuvDistance8(rows, x, sx, sy, 0, sy * 2));
+		alongEdge = _mm_adds_epu16(alongEdge, _mm_slli_epi16(yuvDistance8(rows, x, 0, sy, sx, 0), 2));
+
+		__m128i acrossEdge = yuvDistance8(rows, x, 0, sy, -sx, 0);
+		acrossEdge = _mm_adds_epu16(acrossEdge, yuvDistance8(rows, x, 0, sy, sx, sy * 2));
+		acrossEdge = _mm_adds_epu16(acrossEdge, yuvDistance8(rows, x, sx, 0, sx * 2, sy));
+		acrossEdge = _mm_adds_epu16(acrossEdge, yuvDistance8(rows, x, sx, 0, 0, -sy));
+		acrossEdge = _mm_adds_epu16(acrossEdge, _mm_slli_epi16(yuvDistance8(rows, x, 0, 0, sx, sy), 2));
+
+		__m128i isEdge = _mm_andnot_si128(flat, compareLessUnsigned16(alongEdge, acrossEdge));
+		__m128i isHCloser = _mm_cmpgt_epi16(yuvDistance8(rows, x, 0, 0, sx, 0), yuvDistance8(rows, x, 0, 0, 0, sy));
+
+		__m128i isEdgeHalves[2] = { _mm_unpacklo_epi16(isEdge, isEdge), _mm_unpackhi_epi16(isEdge, isEdge) };
+		__m128i isHCloserHalves[2] = { _mm_unpacklo_epi16(isHCloser, isHCloser), _mm_unpackhi_epi16(isHCloser, isHCloser) };
+
+		__m128i corners[2];
+		for (uint32 half = 0; half < 2; ++half)
+		{
+			__m128i closest = selectPixels(isHCloserHalves[half], H[half], F[half]);
+			corners[half] = selectPixels(isEdgeHalves[half], _mm_avg_epu8(E[half], closest), E[half]);
+		}
+
+		low = corners[0];
+		high = corners[1];
+	}
+
+	SUKINES_TARGET_SSE2 static void xbr2xSSE2(const ScaleRows& rows, uint32* const* outputRows)
+	{
+		for (uint32 x = 0; x < FrameWidth; x += 8)
+		{
+			__m128i topLeft[2], topRight[2], bottomLeft[2], bottomRight[2];
+			xbrCorners8(rows, x, -1, -1, topLeft[0], topLeft[1]);
+			xbrCorners8(rows, x, 1, -1, topRight[0], topRight[1]);
+			xbrCorners8(rows, x, -1, 1, bottomLeft[0], bottomLeft[1]);
+			xbrCorners8(rows, x, 1, 1, bottomRight[0], bottomRight[1]);
+
+			for (uint32 half = 0; half < 2; ++half)
+			{
+				storeInterleaved2(outputRows[0] + (x + half * 4) * 2, topLeft[half], topRight[half]);
+				storeInterleaved2(outputRows[1] + (x + half * 4) * 2, bottomLeft[half], bottomRight[half]);
+			}
+		}
+	}
+#endif
+
+	ScaleRowFunction selectScaleRow(ScaleFilter filter, bool allowSimd)
+	{
+#ifdef SUKINES_ARCH_X86
+		if (allowSimd && hostCpuFeatures().sse2)
+		{
+			switch(filter)
+			{
+				case ScaleFilter::Nearest2x:
+					return &nearest2xSSE2;
+				case ScaleFilter::Nearest3x:
+					return &nearest3xSSE2;
+				case ScaleFilter::Scale2x:
+					return &scale2xSSE2;
+				case ScaleFilter::Scale3x:
+					return &scale3xSSE2;
+				case ScaleFilter::Xbr2x:
+					return &xbr2xSSE2;
+			}
+		}
+#endif
+
+		switch(filter)
+		{
+			case ScaleFilter::Nearest2x:
+				return &nearest2xScalar;
+			case ScaleFilter::Scale2x:
+				return &scale2xScalar;
+			case ScaleFilter::Scale3x:
+				return &scale3xScalar;
+			case ScaleFilter::Xbr2x:
+				return &xbr2xScalar;
+			default:
+				return &nearest3xScalar;
+		}
+	}
+
+	// Planes of neighbourDistance(), for rowCount padded scanlines from source
+	static void computeNeighbourDistances(const uint32* source, uint32 rowCount, bool allowSimd, uint16* distances)
+	{
+		typedef void (*YuvDistancesFunction)(const sint16* const* first, const sint16* const* second, uint32 count, uint16* output);
+		YuvDistancesFunction yuvDistances = &yuvDistancesScalar;
+#ifdef SUKINES_ARCH_X86
+		if (allowSimd && hostCpuFeatures().sse2)
+		{
+			yuvDistances = &yuvDistancesSSE2;
+		}
+#endif
+
+		uint32 planeSize = PaddedWidth * rowCount;
+		std::vector<sint16> yuv(planeSize * 3);
+		for (uint32 index = 0; index < planeSize; ++index)
+		{
+			sint32 red = (source[index] >> 16) & 0xFF;
+			sint32 green = (source[index] >> 8) & 0xFF;
+			sint32 blue = source[index] & 0xFF;
+
+			yuv[index] = static_cast<sint16>((77 * red + 150 * green + 29 * blue) >> 8);
+			yuv[index + planeSize] = static_cast<sint16>((-38 * red - 74 * green + 112 * blue) >> 8);
+			yuv[index + planeSize * 2] = static_cast<sint16>((157 * red - 132 * green - 26 * blue) >> 8);
+		}
+
+		// Distances to missing neighbours are left at 0, they are never read
+		uint16* right = distances;
+		uint16* down = right + planeSize;
+		uint16* downRight = down + planeSize;
+		uint16* downLeft = downRight + planeSize;
+		for (uint32 row = 0; row < rowCount; ++row)
+		{
+			uint32 index = row * PaddedWidth;
+			const sint16* pixel[3] = { &yuv[index], &yuv[index + planeSize], &yuv[index + planeSize * 2] };
+			const sint16* next[3] = { pixel[0] + 1, pixel[1] + 1, pixel[2] + 1 };
+			yuvDistances(pixel, next, PaddedWidth - 1, right + index);
+
+			if (row + 1 == rowCount)
+			{
+				break;
+			}
+
+			const sint16* below[3] = { pixel[0] + PaddedWidth, pixel[1] + PaddedWidth, pixel[2] + PaddedWidth };
+			const sint16* belowNext[3] = { below[0] + 1, below[1] + 1, below[2] + 1 };
+			yuvDistances(pixel, below, PaddedWidth, down + index);
+			yuvDistances(pixel, belowNext, PaddedWidth - 1, downRight + index);
+			yuvDistances(next, below, PaddedWidth - 1, downLeft + index + 1);
+		}
+	}
+
+	PixelScaler::PixelScaler(ScaleFilter filter)
+	: _filter(filter)
+	, _scaleRow(selectScaleRow(filter))
+	, _isSimdAllowed(true)
+	, _source(PaddedWidth * PaddedHeight, 0)
+	{
+	}
+
+	uint32 PixelScaler::scaleFactor(ScaleFilter filter)
+	{
+		switch(filter)
+		{
+			case ScaleFilter::Nearest3x:
+			case ScaleFilter::Scale3x:
+				return 3;
+			default:
+				return 2;
+		}
+	}
+
+	void PixelScaler::setFilter(ScaleFilter filter, bool allowSimd)
+	{
+		_filter = filter;
+		_scaleRow = selectScaleRow(filter, allowSimd);
+		_isSimdAllowed = allowSimd;
+	}
+
+	void PixelScaler::prepare(const FrameBuffer& source)
+	{
+		sukiAssert(source.format == PixelFormat::RGB32);
+
+		for (uint32 y = 0; y < PaddedHeight; ++y)
+		{
+			uint32 sourceY = y < ScaleBorder ? 0 : std::min(y - ScaleBorder, FrameHeight - 1);
+			const uint32* sourceRow = reinterpret_cast<const uint32*>(source.scanline(sourceY));
+			uint32* row = &_source[y * PaddedWidth];
+
+			memcpy(row + ScaleBorder, sourceRow, FrameWidth * sizeof(uint32));
+			for (uint32 x = 0; x < ScaleBorder; ++x)
+			{
+				row[x] = sourceRow[0];
+				row[ScaleBorder + FrameWidth + x] = sourceRow[FrameWidth - 1];
+			}
+		}
+	}
+
+	void PixelScaler::scale(const FrameBuffer& destination, uint32 firstY, uint32 lineCount) const
+	{
+		sukiAssert(destination.format == PixelFormat::RGB32);
+		sukiAssert(firstY + lineCount <= FrameHeight);
+
+		// xBR compares neighbours in YUV, once for the band and its borders
+		uint32 planeRowCount = lineCount + ScaleBorder * 2;
+		uint32 planeSize = PaddedWidth * planeRowCount;
+		std::vector<uint16> distances;
+		if (_filter == ScaleFilter::Xbr2x)
+		{
+			distances.resize(planeSize * 4);
+			computeNeighbourDistances(&_source[firstY * PaddedWidth], planeRowCount, _isSimdAllowed, distances.data());
+		}
+
+		uint32 factor = scaleFactor();
+		for (uint32 y = firstY; y < firstY + lineCount; ++y)
+		{
+			ScaleRows rows;
+			for (uint32 dy = 0; dy < ScaleWindowSize; ++dy)
+			{
+				rows.pixels[dy] = &_source[(y + dy) * PaddedWidth + ScaleBorder];
+
+				const uint16* planes = distances.empty() ? nullptr : &distances[(y - firstY + dy) * PaddedWidth + ScaleBorder];
+				rows.rightDistance[dy] = planes;
+				rows.downDistance[dy] = planes ? planes + planeSize : nullptr;
+				rows.downRightDistance[dy] = planes ? planes + planeSize * 2 : nullptr;
+				rows.downLeftDistance[dy] = planes ? planes + planeSize * 3 : nullptr;
+			}
+			uint32* outputRows[3];
+			for (uint32 row = 0; row < factor; ++row)
+			{
+				outputRows[row] = reinterpret_cast<uint32*>(destination.scanline(y * factor + row));
+			}
+
+			_scaleRow(rows, outputRows);
+		}
+	}
+}
\ No newline at end of file
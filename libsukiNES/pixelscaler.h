@@ -0,0 +1,103 @@
+#pragma once
+
+// STL includes
+#include <vector>
+
+// Local includes
+#include "framebuffer.h"
+
+namespace sukiNES
+{
+	enum class ScaleFilter
+	{
+		Nearest2x,
+		Nearest3x,
+		Scale2x,
+		Scale3x,
+		Xbr2x
+	};
+
+	// Source pixels read on each side of a pixel
+	static const uint32 ScaleBorder = 2;
+	static const uint32 ScaleWindowSize = ScaleBorder * 2 + 1;
+
+	/**
+	 * @brief Source scanlines around the one being scaled
+	 *
+	 * Entry ScaleBorder + dy points at pixel 0 of scanline y + dy, readable
+	 * from x = -ScaleBorder to FrameWidth + ScaleBorder - 1.
+	 * The distances are only filled for xBR: YUV distance of each pixel to its
+	 * neighbour on the right, below, below right and below left.
+	 */
+	struct ScaleRows
+	{
+		const uint32* pixels[ScaleWindowSize];
+		const uint16* rightDistance[ScaleWindowSize];
+		const uint16* downDistance[ScaleWindowSize];
+		const uint16* downRightDistance[ScaleWindowSize];
+		const uint16* downLeftDistance[ScaleWindowSize];
+	};
+
+	/**
+	 * @brief Scale one scanline
+	 * @param outputRows One RGB32 scanline per scale factor, FrameWidth times the factor wide
+	 */
+	typedef void (*ScaleRowFunction)(const ScaleRows& rows, uint32* const* outputRows);
+
+	/**
+	 * @brief Scanline kernel of a filter
+	 * @param allowSimd Use SSE2 when the host CPU supports it
+	 */
+	ScaleRowFunction selectScaleRow(ScaleFilter filter, bool allowSimd = true);
+
+	/**
+	 * @brief Pixel art upscalers for RGB32 frames
+	 *
+	 * prepare() keeps a copy of the frame with its edge pixels repeated around it,
+	 * scale() then writes any band of scanlines from that copy, so several threads
+	 * can scale the same frame.
+	 */
+	class PixelScaler
+	{
+	public:
+		explicit PixelScaler(ScaleFilter filter = ScaleFilter::Nearest3x);
+
+		static uint32 scaleFactor(ScaleFilter filter);
+
+		uint32 scaleFactor() const
+		{
+			return scaleFactor(_filter);
+		}
+
+		/**
+		 * @param allowSimd false forces the scalar kernels
+		 */
+		void setFilter(ScaleFilter filter, bool allowSimd = true);
+
+		ScaleFilter filter() const
+		{
+			return _filter;
+		}
+
+		/**
+		 * @brief Copy the RGB32 frame to scale
+		 */
+		void prepare(const FrameBuffer& source);
+
+		/**
+		 * @brief Scale scanlines of the prepared frame
+		 * @param destination RGB32 frame scaleFactor() times the size of the source
+		 * @param firstY First source scanline to scale
+		 * @param lineCount Number of source scanlines to scale
+		 *
+		 * Safe to call from several threads on different scanlines.
+		 */
+		void scale(const FrameBuffer& destination, uint32 firstY = 0, uint32 lineCount = FrameHeight) const;
+
+	private:
+		ScaleFilter _filter;
+		ScaleRowFunction _scaleRow;
+		bool _isSimdAllowed;
+		std::vector<uint32> _source;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "pixelscalerpool.h"
+
+// Local includes
+#include "assert.h"
+
+namespace sukiNES
+{
+	PixelScalerPool::PixelScalerPool(uint32 threadCount)
+	: _threads(threadCount)
+	{
+	}
+
+	PixelScalerPool::~PixelScalerPool()
+	{
+		// The workers read the scaler
+		_threads.wait();
+	}
+
+	void PixelScalerPool::setFilter(ScaleFilter filter)
+	{
+		sukiAssert(!_threads.isBusy());
+
+		_scaler.setFilter(filter);
+	}
+
+	void PixelScalerPool::setDestination(const FrameBuffer& destination)
+	{
+		sukiAssert(destination.format == PixelFormat::RGB32);
+
+		_destination = destination;
+	}
+
+	void PixelScalerPool::setFrameScaledCallback(const std::function<void()>& callback)
+	{
+		_threads.setJobDoneCallback(callback);
+	}
+
+	bool PixelScalerPool::submit(const FrameBuffer& source)
+	{
+		// Only this thread starts jobs, the workers cannot become busy meanwhile
+		if (_threads.isBusy() || !_destination.pixels)
+		{
+			return false;
+		}
+
+		// The workers are idle, the source may be overwritten as soon as this returns
+		_scaler.prepare(source);
+
+		FrameBuffer destination = _destination;
+		const PixelScaler& scaler = _scaler;
+
+		return _threads.run([&scaler, destination] (uint32 firstY, uint32 lineCount) {
+			scaler.scale(destination, firstY, lineCount);
+		});
+	}
+}
\ No newline at end of file
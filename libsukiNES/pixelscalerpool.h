@@ -0,0 +1,84 @@
+#pragma once
+
+// STL includes
+#include <functional>
+
+// Local includes
+#include "bandthreadpool.h"
+#include "framebuffer.h"
+#include "pixelscaler.h"
+
+namespace sukiNES
+{
+	/**
+	 * @brief Runs a PixelScaler on worker threads, each scaling a band of scanlines
+	 *
+	 * submit() copies the frame and returns at once. A frame submitted while the
+	 * previous one is still being scaled is dropped.
+	 */
+	class PixelScalerPool
+	{
+	public:
+		/**
+		 * @param threadCount Worker threads, 0 for one per hardware thread besides the emulation thread
+		 */
+		explicit PixelScalerPool(uint32 threadCount = 0);
+		~PixelScalerPool();
+
+		/**
+		 * @brief Only change the filter and the destination while the pool is idle
+		 */
+		void setFilter(ScaleFilter filter);
+
+		ScaleFilter filter() const
+		{
+			return _scaler.filter();
+		}
+
+		uint32 scaleFactor() const
+		{
+			return _scaler.scaleFactor();
+		}
+
+		/**
+		 * @brief RGB32 frame the workers write to, scaleFactor() times the size of a frame
+		 */
+		void setDestination(const FrameBuffer& destination);
+
+		/**
+		 * @brief Called on a worker thread once a frame is completely scaled
+		 *
+		 * The next frame is not accepted before the callback returns.
+		 */
+		void setFrameScaledCallback(const std::function<void()>& callback);
+
+		/**
+		 * @brief Start scaling a RGB32 frame
+		 * @return false when the previous frame is still being scaled, this one is dropped
+		 */
+		bool submit(const FrameBuffer& source);
+
+		bool isBusy() const
+		{
+			return _threads.isBusy();
+		}
+
+		/**
+		 * @brief Wait until the submitted frame is scaled
+		 */
+		void wait()
+		{
+			_threads.wait();
+		}
+
+		uint32 threadCount() const
+		{
+			return _threads.threadCount();
+		}
+
+	private:
+		PixelScaler _scaler;
+		BandThreadPool _threads;
+		FrameBuffer _destination;
+	};
+}
\ No newline at end of file
@@ -4,6 +4,10 @@
 #define SUKINES_PLATFORM_WINDOWS
 #endif
 
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SUKINES_ARCH_X86
+#endif
+
 #if defined(DEBUG) || defined(_DEBUG) || defined(_SUKINES_DEBUG)
 #define SUKINES_DEBUG
 #elif defined(_SUKINES_FINAL)
@@ -18,6 +22,8 @@ typedef unsigned short uint16;
 typedef signed short sint16;
 typedef unsigned int uint32;
 typedef signed int sint32;
+typedef unsigned long long uint64;
+typedef signed long long sint64;
 
 typedef uint8 byte;
 typedef sint8 offset;
@@ -30,12 +36,24 @@ static_assert(sizeof(uint16) == 2, "uint16 is not equals to 2 bytes on this plat
 static_assert(sizeof(sint16) == 2, "sint16 is not equals to 2 bytes on this platform");
 static_assert(sizeof(uint32) == 4, "uint32 is not equals to 4 bytes on this platform");
 static_assert(sizeof(sint32) == 4, "sint32 is not equals to 4 bytes on this platform");
+static_assert(sizeof(uint64) == 8, "uint64 is not equals to 8 bytes on this platform");
+static_assert(sizeof(sint64) == 8, "sint64 is not equals to 8 bytes on this platform");
 
 #define SUKINES_KB(x) (x * 1024u)
 #define SUKINES_BIT(x) (1 << x)
 
 #define ForceBreakpoint() __debugbreak()
 
+#ifdef _MSC_VER
+#define SUKINES_ALIGN(x) __declspec(align(x))
+#define SUKINES_TARGET_SSE2
+#define SUKINES_TARGET_AVX2
+#else
+#define SUKINES_ALIGN(x) __attribute__((aligned(x)))
+#define SUKINES_TARGET_SSE2 __attribute__((target("sse2")))
+#define SUKINES_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
 #include "types.h"
 
 typedef ManagedWord word;
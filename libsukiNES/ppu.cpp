@@ -2,15 +2,23 @@
 
 // STL includes
 #include <algorithm>
+#include <type_traits>
 
 // Local includes
+#include "framehash.h"
+#include "frametriplebuffer.h"
 #include "gamepak.h"
+#include "ntscfilter.h"
+#include "observation.h"
+#include "ppudebugstate.h"
 #include "ppuio.h"
 
 namespace sukiNES
 {
 	static const uint32 CyclesPerScanline = 340;
-	static const sint32 ScanlinePerFrame = 260;
+	static const uint32 DotsPerScanline = CyclesPerScanline + 1;
+	// Last scanline of the longest frame, PAL and Dendy
+	static const sint32 MaxLastScanline = 310;
 	static const sint32 PostRenderScanline = 240;
 	static const sint32 PreRenderScanline = -1;
 
@@ -18,16 +26,237 @@ namespace sukiNES
 	static const byte PpuRegisterMask = 0x7;
 	static const byte PaletteMask = 0x1F;
 	static const byte OamDataAttributeReadMask = 0xE3;
-	static const uint32 NametableAddressMask = 0xFFF;
-	static const uint32 NametableHorizontalMask = 0x3FF;
-	static const uint32 NametableVerticalMask = 0x7FF;
-	static const uint32 NametableSingleScreenMask = 0x3FF;
+	static const byte SpriteSizeMask = 0x20;
+	static const uint32 SpriteEvaluationDots = 192;
+	static const uint32 NametablePage = 0x2000 / PpuPageSize;
+	static const uint32 NametableMirrorPage = 0x3000 / PpuPageSize;
+	static const uint32 PaletteAddress = 0x3F00;
 
 	static byte PaletteAtPowerOn[32] = {
 		0x9,0x1,0x0,0x1,0x0,0x2,0x2,0xD,0x8,0x10,0x8,0x24,0x0,0x0,0x4,0x2C,
 		0x9,0x1,0x34,0x3,0x0,0x4,0x0,0x14,0x8,0x3A,0x0,0x2,0x0,0x20,0x2C,0x8
 	};
 
+	// Work done by the PPU on a dot
+	namespace DotAction
+	{
+		enum
+		{
+			StartFrame = SUKINES_BIT(0),
+			StartScanline = SUKINES_BIT(1),
+			RenderPixel = SUKINES_BIT(2),
+			FinishScanline = SUKINES_BIT(3),
+			ClearStatus = SUKINES_BIT(4),
+			StartVBlank = SUKINES_BIT(5),
+			EndFrame = SUKINES_BIT(6),
+
+			// Memory accesses, only done when rendering is enabled
+			ClearSecondaryOAM = SUKINES_BIT(8),
+			EvaluateSprites = SUKINES_BIT(9),
+			ResetOamAddress = SUKINES_BIT(10),
+			ResetVertical = SUKINES_BIT(11),
+			StartSpriteFetch = SUKINES_BIT(12),
+			ClearBackgroundQueues = SUKINES_BIT(13),
+			StartSpriteEvaluation = SUKINES_BIT(14),
+
+			// DotFetch done on the dot
+			FetchShift = 16,
+
+			RenderingActions = 0xFFFF00
+		};
+	}
+
+	// Memory fetch of a dot, the 8 dot fetch pattern is a single switch
+	enum class DotFetch
+	{
+		None,
+		Nametable,
+		Attribute,
+		LowTile,
+		HighTile,
+		LastHighTile,
+		SpriteAttributes,
+		SpriteLowTile,
+		SpriteHighTile
+	};
+
+	// Actions of every dot, for each kind of scanline.
+	// All visible scanlines but the first do the same work, as do the idle ones,
+	// so the 262 scanlines of a NTSC frame, or 312 on PAL and Dendy, share 5 rows of 341 dots.
+	class DotActionTable
+	{
+	public:
+		DotActionTable()
+		{
+			for (uint32 dot = 0; dot < DotsPerScanline; ++dot)
+			{
+				uint32 renderingActions = _memoryAccessActions(dot);
+
+				uint32 visibleActions = renderingActions;
+				if (dot == 0)
+				{
+					visibleActions |= DotAction::StartScanline;
+				}
+				if (dot < ScanlineWidth)
+				{
+					visibleActions |= DotAction::RenderPixel;
+				}
+				if (dot == ScanlineWidth - 1)
+				{
+					visibleActions |= DotAction::FinishScanline;
+				}
+
+				uint32 preRenderActions = renderingActions;
+				if (dot == 1)
+				{
+					preRenderActions |= DotAction::ClearStatus;
+				}
+				if (dot >= 280 && dot < 305)
+				{
+					preRenderActions |= DotAction::ResetVertical;
+				}
+				if (dot == 339)
+				{
+					preRenderActions |= DotAction::EndFrame;
+				}
+
+				_actions[FirstVisibleKind][dot] = visibleActions | (dot == 0 ? DotAction::StartFrame : 0);
+				_actions[VisibleKind][dot] = visibleActions;
+				_actions[IdleKind][dot] = 0;
+				_actions[VBlankKind][dot] = (dot == 1) ? DotAction::StartVBlank : 0;
+				_actions[PreRenderKind][dot] = preRenderActions;
+			}
+
+			// Scanlines -1 to the last one of each region
+			for (uint32 region = 0; region < RegionCount; ++region)
+			{
+				const RegionTiming& timing = regionTiming(static_cast<Region>(region));
+				byte* scanlineKinds = _scanlineKinds[region];
+
+				scanlineKinds[0] = PreRenderKind;
+				for (sint32 scanline = 0; scanline <= timing.lastScanline; ++scanline)
+				{
+					byte kind = IdleKind;
+					if (scanline == 0)
+					{
+						kind = FirstVisibleKind;
+					}
+					else if (scanline < PostRenderScanline)
+					{
+						kind = VisibleKind;
+					}
+					else if (scanline == timing.vblankScanline)
+					{
+						kind = VBlankKind;
+					}
+
+					scanlineKinds[scanline + 1] = kind;
+				}
+			}
+		}
+
+		const uint32* scanlineActions(Region region, sint32 scanline) const
+		{
+			return _actions[_scanlineKinds[static_cast<uint32>(region)][scanline + 1]];
+		}
+
+	private:
+		enum ScanlineKind
+		{
+			FirstVisibleKind,
+			VisibleKind,
+			IdleKind,
+			VBlankKind,
+			PreRenderKind,
+			KindCount
+		};
+
+		static uint32 _fetchAction(DotFetch fetch)
+		{
+			return static_cast<uint32>(fetch) << DotAction::FetchShift;
+		}
+
+		static uint32 _memoryAccessActions(uint32 dot)
+		{
+			uint32 actions = 0;
+
+			if (dot >= 1 && dot <= 64)
+			{
+				actions |= DotAction::ClearSecondaryOAM;
+			}
+			else if (dot >= 65 && dot <= 256)
+			{
+				actions |= DotAction::EvaluateSprites;
+				if (dot == 65)
+				{
+					actions |= DotAction::StartSpriteEvaluation;
+				}
+			}
+
+			// Background tiles of the scanline, then the first two tiles of the next one
+			if ((dot >= 1 && dot < 256) || (dot >= 321 && dot < 337))
+			{
+				switch(dot % 8)
+				{
+					case 2:
+						actions |= _fetchAction(DotFetch::Nametable);
+						break;
+					case 4:
+						actions |= _fetchAction(DotFetch::Attribute);
+						break;
+					case 6:
+						actions |= _fetchAction(DotFetch::LowTile);
+						break;
+					case 0:
+						actions |= _fetchAction(DotFetch::HighTile);
+						break;
+				}
+			}
+			else if (dot == 256)
+			{
+				actions |= _fetchAction(DotFetch::LastHighTile);
+			}
+			else if (dot >= 257 && dot < 321)
+			{
+				actions |= DotAction::ResetOamAddress;
+				if (dot == 257)
+				{
+					actions |= DotAction::StartSpriteFetch;
+				}
+
+				switch(dot % 8)
+				{
+					case 2:
+						actions |= _fetchAction(DotFetch::SpriteAttributes);
+						break;
+					case 6:
+						actions |= _fetchAction(DotFetch::SpriteLowTile);
+						break;
+					case 0:
+						actions |= _fetchAction(DotFetch::SpriteHighTile);
+						break;
+				}
+			}
+			else if (dot == 338 || dot == 340)
+			{
+				actions |= _fetchAction(DotFetch::Nametable);
+			}
+
+			if (dot == 321)
+			{
+				actions |= DotAction::ClearBackgroundQueues;
+			}
+
+			return actions;
+		}
+
+	private:
+		uint32 _actions[KindCount][DotsPerScanline];
+		byte _scanlineKinds[RegionCount][MaxLastScanline + 2];
+	};
+
+	static const DotActionTable DotActions;
+
 	enum class PpuRegister
 	{
 		PpuControl = 0,
@@ -41,13 +270,29 @@ namespace sukiNES
 	};
 
 	PPU::PPU()
-	: _rawOAM(nullptr)
-	, _rawSecondaryOAM(nullptr)
+	: _hot()
+	, _cold()
 	, _gamePak(nullptr)
 	, _io(nullptr)
+	, _writeLog(nullptr)
+	, _observationStack(nullptr)
+	, _frameTripleBuffer(nullptr)
+	, _findSpritesInRange(selectFindSpritesInRange())
+	, _compositeScanline(selectCompositeScanline())
+	, _isTimingOnly(false)
+	, _isFrameHashing(false)
+	, _frameHash(0)
+	, _stateGeneration(0)
 	{
-		_rawOAM = reinterpret_cast<byte*>(_sprites);
-		_rawSecondaryOAM = reinterpret_cast<byte*>(_secondaryOAM);
+		static_assert(std::is_trivially_copyable<HotState>::value, "PPU hot state must be copyable with memcpy");
+		static_assert(std::is_trivially_copyable<ColdState>::value, "PPU cold state must be copyable with memcpy");
+
+		_cold.region = Region::Ntsc;
+		_cold.timing = &regionTiming(Region::Ntsc);
+		_cold.spriteLineGeneration = 1;
+
+		std::fill(std::begin(_pageTable), std::end(_pageTable), nullptr);
+		setNametableMirroring(NameTableMirroring::Horizontal);
 
 		powerOn();
 	}
@@ -56,38 +301,163 @@ namespace sukiNES
 	{
 	}
 
+	void PPU::setFrameTripleBuffer(FrameTripleBuffer* buffer)
+	{
+		_frameTripleBuffer = buffer;
+		_publishedFrame = FrameBuffer();
+
+		if (buffer)
+		{
+			_frameBuffer = buffer->backBuffer();
+		}
+
+		// The new frame buffer does not hold the previous frame
+		_markStateChanged();
+	}
+
+	void PPU::captureDebugState(PPUDebugState& state) const
+	{
+		state.ppuControl.raw = _hot.ppuControl.raw;
+		state.ppuMask.raw = _hot.ppuMask.raw;
+		state.ppuStatus.raw = _hot.ppuStatus.raw;
+		state.temporaryPpuAddress.raw = _hot.temporaryPpuAddress.raw;
+		state.currentPpuAddress.raw = _hot.currentPpuAddress.raw;
+		state.firstWrite = _hot.firstWrite;
+		state.fineXScroll = _hot.fineXScroll;
+
+		state.cycle = _hot.cycleCountPerScanline;
+		state.scanline = _hot.currentScanline;
+		state.isEvenFrame = _hot.isEvenFrame;
+
+		state.nametableMirroring = _cold.nametableMirroring;
+
+		memcpy(state.palette, _cold.palette, sizeof(state.palette));
+		memcpy(state.colors, _rgbPalette.rgb32(), sizeof(state.colors));
+
+		// Straight from the pages, reading through PPUDATA would change the read buffer
+		for (uint32 page = 0; page < sizeof(state.memory) / PpuPageSize; ++page)
+		{
+			const byte* pageMemory = _pageTable[page];
+			if (pageMemory)
+			{
+				memcpy(state.memory + page * PpuPageSize, pageMemory, PpuPageSize);
+			}
+			else
+			{
+				memset(state.memory + page * PpuPageSize, 0, PpuPageSize);
+			}
+		}
+	}
+
+	void PPU::setFrameHashing(bool value)
+	{
+		_isFrameHashing = value;
+		_frameHash = 0;
+
+		// Compose the next frame even if unchanged, so that it gets hashed
+		_markStateChanged();
+	}
+
+	void PPU::setRegion(Region region)
+	{
+		_logEntry(PPUWriteLog::EntryType::Region, _hot.dotCount, 0, static_cast<byte>(region));
+
+		_cold.region = region;
+		_cold.timing = &regionTiming(region);
+		_hot.scanlineActions = DotActions.scanlineActions(_cold.region, _hot.currentScanline);
+	}
+
+	void PPU::setNametableMirroring(PPU::NameTableMirroring value)
+	{
+		_markStateChanged();
+		_logEntry(PPUWriteLog::EntryType::Mirroring, _hot.dotCount, 0, static_cast<byte>(value));
+
+		// CIRAM page used by each of the four logical nametables
+		static const byte NametablePages[][4] =
+		{
+			{ 0, 0, 1, 1 }, // Horizontal
+			{ 0, 1, 0, 1 }, // Vertical
+			{ 0, 1, 2, 3 }, // FourScreen
+			{ 0, 0, 0, 0 }, // SingleScreen
+			{ 0, 0, 0, 0 }  // ChrRomMirroring, not supported
+		};
+
+		_cold.nametableMirroring = value;
+
+		const byte* pages = NametablePages[static_cast<uint32>(value)];
+		for (uint32 whichNametable = 0; whichNametable < 4; ++whichNametable)
+		{
+			byte* nametable = _cold.nametable + pages[whichNametable] * PpuPageSize;
+
+			// $3000-$3EFF mirrors $2000-$2EFF
+			_pageTable[NametablePage + whichNametable] = nametable;
+			_pageTable[NametableMirrorPage + whichNametable] = nametable;
+		}
+	}
+
+	void PPU::setGamePak(GamePak* gamePak)
+	{
+		_gamePak = gamePak;
+
+		if (_gamePak)
+		{
+			mapChrBank(_gamePak->chrBank());
+		}
+	}
+
 	void PPU::powerOn()
 	{
-		_ppuControl.raw = 0;
-		_ppuMask.raw = 0;
-		_ppuStatus.raw = 0;
-		_temporaryPpuAddress.raw = 0;
-		_currentPpuAddress.raw = 0;
-
-		_fineXScroll = 0;
-		_oamAddress = 0;
-		_secondaryOAMIndex = 0;
-		_cycleCountPerScanline = 0;
-		_currentScanline = PreRenderScanline;
-		_isEvenFrame = true;
-		_skipNmi = false;
-		_irqNotRead = false;
-		_firstWrite = true;
-		_readBuffer = 0xFF;
-		_lastReadNametableByte = 0;
-		_currentAttribute = 0;
-		_currentAttributeBits = 0;
-		_currentSpriteFetched = 0;
-
-		_spriteEval.clear();
+		_hot.ppuControl.raw = 0;
+		_hot.ppuMask.raw = 0;
+		_hot.ppuStatus.raw = 0;
+		_hot.temporaryPpuAddress.raw = 0;
+		_hot.currentPpuAddress.raw = 0;
+
+		_hot.fineXScroll = 0;
+		_hot.oamAddress = 0;
+		_hot.secondaryOAMIndex = 0;
+		_hot.cycleCountPerScanline = 0;
+		_hot.currentScanline = PreRenderScanline;
+		_hot.scanlineActions = DotActions.scanlineActions(_cold.region, _hot.currentScanline);
+		_hot.dotCount = 0;
+		_hot.isEvenFrame = true;
+		_cold.burstPhase = 0;
+		_cold.frameCount = 0;
+		_hot.skipNmi = false;
+		_hot.irqNotRead = false;
+		_hot.firstWrite = true;
+		_hot.readBuffer = 0xFF;
+		_hot.lastReadNametableByte = 0;
+		_hot.currentAttribute = 0;
+		_hot.currentAttributeBits = 0;
+		_hot.currentSpriteFetched = 0;
+		_hot.compositedX = 0;
+		_cold.outputStartX = 0;
+		_hot.isTimingOnlyFrame = _isTimingOnly;
+		_hot.hasSprite0OnScanline = false;
+		_frameGeneration = _stateGeneration;
+		_frameRegisters = _pictureRegisters();
+		_isFrameComplete = false;
+		_hot.isUnchangedFrame = false;
+
+		_hot.spriteEval.clear();
 		for(uint32 i = 0; i < 8; ++i)
 		{
-			_spritesToRender[i].clear();
+			_hot.spritesToRender[i].clear();
 		}
 
-		memcpy(_palette, PaletteAtPowerOn, sizeof(PaletteAtPowerOn) / sizeof(byte));
+		memcpy(_cold.palette, PaletteAtPowerOn, sizeof(PaletteAtPowerOn) / sizeof(byte));
+
+		std::fill(std::begin(_cold.nametable), std::end(_cold.nametable), 0);
+
+		std::fill(std::begin(_cold.backgroundLayer), std::end(_cold.backgroundLayer), 0);
+		std::fill(std::begin(_cold.spriteLayer), std::end(_cold.spriteLayer), 0);
+		std::fill(std::begin(_cold.frontSpriteLayer), std::end(_cold.frontSpriteLayer), 0);
+		std::fill(std::begin(_cold.sprite0Layer), std::end(_cold.sprite0Layer), 0);
+		std::fill(std::begin(_cold.scanlineOutput), std::end(_cold.scanlineOutput), 0);
+		std::fill(std::begin(_cold.scanlineEmphasis), std::end(_cold.scanlineEmphasis), 0);
 
-		std::fill(std::begin(_nametable), std::end(_nametable), 0);
+		_logEntry(PPUWriteLog::EntryType::PowerOn, _hot.dotCount, 0, 0);
 	}
 
 	byte PPU::read(word address)
@@ -98,38 +468,47 @@ namespace sukiNES
 		{
 			case PpuRegister::PpuStatus:
 			{
-				_firstWrite = true;
+				_logEntry(PPUWriteLog::EntryType::Read, _hot.dotCount, ppuRegister, 0);
+				_catchUpComposition();
+
+				_hot.firstWrite = true;
 				
-				if (_currentScanline == 241 && _cycleCountPerScanline == 0)
+				if (_hot.currentScanline == _cold.timing->vblankScanline && _hot.cycleCountPerScanline == 0)
 				{
-					_ppuStatus.vblankStarted = false;
-					_skipNmi = true;
+					_hot.ppuStatus.vblankStarted = false;
+					_hot.skipNmi = true;
 				}
-				else if (_currentScanline == 241 && _cycleCountPerScanline == 1)
+				else if (_hot.currentScanline == _cold.timing->vblankScanline && _hot.cycleCountPerScanline == 1)
 				{
-					_ppuStatus.vblankStarted = true;
-					_skipNmi = true;
+					_hot.ppuStatus.vblankStarted = true;
+					_hot.skipNmi = true;
 				}
 				
-				auto ppuStatus = _ppuStatus.raw;
-				_ppuStatus.vblankStarted = false;
+				auto ppuStatus = _hot.ppuStatus.raw;
+				_hot.ppuStatus.vblankStarted = false;
 				return ppuStatus;
 			}
 			case PpuRegister::OamData:
 				if (_isRenderingEnabled()
-					&& (_cycleCountPerScanline >= 1 && _cycleCountPerScanline <= 64)
-					&& (_currentScanline >= 0 && _currentScanline < PostRenderScanline)
+					&& (_hot.cycleCountPerScanline >= 1 && _hot.cycleCountPerScanline <= 64)
+					&& (_hot.currentScanline >= 0 && _hot.currentScanline < PostRenderScanline)
 					)
 				{
 					return 0xFF;
 				}
 				else
 				{
-					return ((_oamAddress+1) % 3 == 0) ? _rawOAM[_oamAddress] & OamDataAttributeReadMask : _rawOAM[_oamAddress];
+					return ((_hot.oamAddress+1) % 3 == 0) ? _oamByte(_hot.oamAddress) & OamDataAttributeReadMask : _oamByte(_hot.oamAddress);
 				}
 			case PpuRegister::PpuData:
-				byte readValue = _internalRead(_currentPpuAddress.raw, PPU::ReadSource::FromRegister);
+				_logEntry(PPUWriteLog::EntryType::Read, _hot.dotCount, ppuRegister, 0);
+
+				PictureRegisters pictureRegisters = _pictureRegisters();
+
+				byte readValue = _internalRead(_hot.currentPpuAddress.raw, PPU::ReadSource::FromRegister);
 				_incrementPpuAddressOnReadWrite();
+
+				_markRegistersChanged(pictureRegisters);
 				return readValue;
 		}
 
@@ -140,55 +519,83 @@ namespace sukiNES
 	{
 		byte ppuRegister = address & PpuRegisterMask;
 
+		_logEntry(PPUWriteLog::EntryType::Write, _hot.dotCount, ppuRegister, value);
+
+		PictureRegisters pictureRegisters = _pictureRegisters();
+
 		switch(ppuRegister)
 		{
 			case PpuRegister::PpuControl:
-				_ppuControl.raw = value;
-				_temporaryPpuAddress.nametableSelect = (unsigned)_ppuControl.baseNametableAddress;
+				if ((value ^ _hot.ppuControl.raw) & SpriteSizeMask)
+				{
+					_catchUpSpriteEvaluation();
+					++_cold.spriteLineGeneration;
+				}
+				_hot.ppuControl.raw = value;
+				_hot.temporaryPpuAddress.nametableSelect = (unsigned)_hot.ppuControl.baseNametableAddress;
 				break;
 			case PpuRegister::PpuMask:
-				_ppuMask.raw = value;
+				_catchUpComposition();
+				_catchUpSpriteEvaluation();
+				_hot.ppuMask.raw = value;
 				break;
 			case PpuRegister::OamAddress:
-				_oamAddress = value;
+				if (_hot.oamAddress != value)
+				{
+					_hot.oamAddress = value;
+					_markStateChanged();
+				}
 				break;
 			case PpuRegister::OamData:
-				_rawOAM[_oamAddress] = value;
-				++_oamAddress;
+				if (_oamByte(_hot.oamAddress) != value)
+				{
+					_catchUpSpriteEvaluation();
+					_oamByte(_hot.oamAddress) = value;
+					if ((_hot.oamAddress & 0x3) == 0)
+					{
+						_cold.spriteY[_hot.oamAddress >> 2] = value;
+						++_cold.spriteLineGeneration;
+					}
+					_markStateChanged();
+				}
+				++_hot.oamAddress;
 				break;
 			case PpuRegister::Scroll:
-				if (_firstWrite)
+				if (_hot.firstWrite)
 				{
-					_temporaryPpuAddress.coarseXScroll = (value & 0xF8) >> 3;
-					_fineXScroll = value & 0x7;
-					_firstWrite = !_firstWrite;
+					_hot.temporaryPpuAddress.coarseXScroll = (value & 0xF8) >> 3;
+					_hot.fineXScroll = value & 0x7;
+					_hot.firstWrite = !_hot.firstWrite;
 				}
 				else
 				{
-					_temporaryPpuAddress.coarseYScroll = (value & 0xF8) >> 3;
-					_temporaryPpuAddress.fineYScroll = value & 0x7;
-					_firstWrite = !_firstWrite;
+					_hot.temporaryPpuAddress.coarseYScroll = (value & 0xF8) >> 3;
+					_hot.temporaryPpuAddress.fineYScroll = value & 0x7;
+					_hot.firstWrite = !_hot.firstWrite;
 				}
 				break;
 			case PpuRegister::PpuAddress:
-				if (_firstWrite)
+				if (_hot.firstWrite)
 				{
-					_temporaryPpuAddress.highByteAddress = value & 0x3F;
-					_temporaryPpuAddress.clearBit14 = 0;
-					_firstWrite = !_firstWrite;
+					_hot.temporaryPpuAddress.highByteAddress = value & 0x3F;
+					_hot.temporaryPpuAddress.clearBit14 = 0;
+					_hot.firstWrite = !_hot.firstWrite;
 				}
 				else
 				{
-					_temporaryPpuAddress.lowByteAddress = value;
-					_currentPpuAddress.raw = _temporaryPpuAddress.raw;
-					_firstWrite = !_firstWrite;
+					_hot.temporaryPpuAddress.lowByteAddress = value;
+					_hot.currentPpuAddress.raw = _hot.temporaryPpuAddress.raw;
+					_hot.firstWrite = !_hot.firstWrite;
 				}
 				break;
 			case PpuRegister::PpuData:
-				_internalWrite(_currentPpuAddress.raw, value);
+				_catchUpComposition();
+				_internalWrite(_hot.currentPpuAddress.raw, value);
 				_incrementPpuAddressOnReadWrite();
 				break;
 			}
+
+		_markRegistersChanged(pictureRegisters);
 	}
 
 	void PPU::tick()
@@ -196,318 +603,503 @@ namespace sukiNES
 		// See http://wiki.nesdev.com/w/images/d/d1/Ntsc_timing.png
 		// and http://wiki.nesdev.com/w/index.php/PPU_rendering
 		// for more details on how this works.
+		uint32 actions = _hot.scanlineActions[_hot.cycleCountPerScanline];
 
-		if (_currentScanline >= 0 && _currentScanline < PostRenderScanline)
+		if (actions & DotAction::EndFrame)
 		{
-			if (_cycleCountPerScanline >= 0 && _cycleCountPerScanline < 256)
-			{
-				if (_isRenderingEnabled())
-				{
-					auto currentPixel = (_cycleCountPerScanline+_fineXScroll) & 7;
-					if (_cycleCountPerScanline == 0)
-					{
-						_prepareNextTile();
-					}
-					else if (currentPixel == 0)
-					{
-						_prepareNextTile();
-					}
+			// The odd frame skip jumps to the last dot of the pre-render scanline
+			_endFrame();
+			actions = _hot.scanlineActions[_hot.cycleCountPerScanline] & ~DotAction::EndFrame;
+		}
 
-					_renderPixel();
-				}
-				else
-				{
-					_renderBackground();
-				}
-			}
+		if (!_isRenderingEnabled())
+		{
+			actions &= ~DotAction::RenderingActions;
+		}
 
-			if (_isRenderingEnabled())
-			{
-				_memoryAccess();
-			}
+		if (actions & DotAction::StartFrame)
+		{
+			_startFrame();
 		}
-		else if (_currentScanline == PostRenderScanline)
+		if (actions & DotAction::StartScanline)
 		{
-			// Do nothing
+			_prepareSpriteLayers();
 		}
-		else if (_currentScanline >= 241 && _currentScanline <= 260)
+		if (actions & DotAction::RenderPixel)
 		{
-			// In VBlank
-			if (_currentScanline == 241 && _cycleCountPerScanline == 1)
+			if (_isRenderingEnabled())
 			{
-				if (!_skipNmi)
+				auto currentPixel = (_hot.cycleCountPerScanline+_hot.fineXScroll) & 7;
+				if (_hot.cycleCountPerScanline == 0 || currentPixel == 0)
 				{
-					_ppuStatus.vblankStarted = true;
-					_irqNotRead = true;
-				}
-				else
-				{
-					_skipNmi = false;
+					_prepareNextTile();
 				}
 
-				if (_io)
+				// When composition is skipped the background is only needed for sprite 0 hit
+				if (!_isSkippingComposition() || _hot.hasSprite0OnScanline)
 				{
-					_io->onVBlank();
+					_fetchBackgroundPixel();
 				}
 			}
-		}
-		else if(_currentScanline == PreRenderScanline)
-		{
-			if (_cycleCountPerScanline == 339)
+			else
 			{
-				if (!_isEvenFrame && _isRenderingEnabled())
-				{
-					++_cycleCountPerScanline;
-				}
-				_isEvenFrame = !_isEvenFrame;
+				_renderBackground(_hot.cycleCountPerScanline + 1);
 			}
+		}
+		if (actions & DotAction::FinishScanline)
+		{
+			_finishScanline();
+		}
+		if (actions & DotAction::ClearStatus)
+		{
+			_hot.ppuStatus.raw = 0;
+		}
+		if (actions & DotAction::StartVBlank)
+		{
+			_startVBlank();
+		}
 
-			if (_cycleCountPerScanline == 1)
+		if (actions & DotAction::RenderingActions)
+		{
+			if (actions & DotAction::ClearSecondaryOAM)
 			{
-				_ppuStatus.raw = 0;
+				_clearSecondaryOAM();
 			}
-
-			if (_isRenderingEnabled())
+			else if (actions & DotAction::EvaluateSprites)
 			{
-				if (_cycleCountPerScanline >= 280 && _cycleCountPerScanline < 305)
+				if (actions & DotAction::StartSpriteEvaluation)
 				{
-					_resetVerticalPpuAddress();
+					_startSpriteEvaluation();
 				}
 
-				_memoryAccess();
+				// Nothing left to do once done, but setting the overflow flag of a cached evaluation
+				if (_hot.spriteEval.currentState != SpriteEvaluation::Done || _hot.dotCount == _hot.spriteEval.overflowDot)
+				{
+					_spriteEvaluation();
+				}
 			}
-		}
-
-		_incrementCycleAndScanline();
-	}
 
-	void PPU::_memoryAccess()
-	{
-		if (_cycleCountPerScanline == 0)
-		{
-		}
-		else if(_cycleCountPerScanline >= 1 && _cycleCountPerScanline < 256)
-		{
-			if (_cycleCountPerScanline >= 1 && _cycleCountPerScanline <= 64)
+			if (actions & DotAction::ResetOamAddress)
 			{
-				_rawSecondaryOAM[_secondaryOAMIndex] = 0xFF;
-				++_secondaryOAMIndex;
-				if (_secondaryOAMIndex > 32)
-				{
-					_secondaryOAMIndex = 0;
-					_spriteEval.oamIndex = _oamAddress / 4;
-				}
+				_hot.oamAddress = 0;
 			}
-			else
+			if (actions & DotAction::ResetVertical)
+			{
+				_resetVerticalPpuAddress();
+			}
+			if (actions & DotAction::StartSpriteFetch)
+			{
+				_startSpriteFetch();
+			}
+			if (actions & DotAction::ClearBackgroundQueues)
 			{
-				_spriteEvaluation();
+				_clearBackgroundQueues();
 			}
 
-			auto whichAction = static_cast<PPU::MemoryAccessAction>(_cycleCountPerScanline % 8);
-			switch(whichAction)
+			switch(static_cast<DotFetch>(actions >> DotAction::FetchShift))
 			{
-				case MemoryAccessAction::NametableFetch:
+				case DotFetch::Nametable:
 					_nametableFetch();
 					break;
-				case MemoryAccessAction::AttributeFetch:
+				case DotFetch::Attribute:
 					_attributeFetch();
 					break;
-				case MemoryAccessAction::LowTileFetch:
-					_backgroundByteFetch(whichAction);
+				case DotFetch::LowTile:
+					_backgroundByteFetch(MemoryAccessAction::LowTileFetch);
 					break;
-				case MemoryAccessAction::HighTileFetch:
-					_backgroundByteFetch(whichAction);
+				case DotFetch::HighTile:
+					_backgroundByteFetch(MemoryAccessAction::HighTileFetch);
 
 					_incrementPpuAddressHorizontal();
 					break;
+				case DotFetch::LastHighTile:
+					_backgroundByteFetch(MemoryAccessAction::HighTileFetch);
+
+					_incrementPpuAddressHorizontal();
+					_incrementPpuAddressVertical();
+					break;
+				case DotFetch::SpriteAttributes:
+					_latchSprite();
+					break;
+				case DotFetch::SpriteLowTile:
+					_fetchSprite(MemoryAccessAction::LowTileFetch);
+					break;
+				case DotFetch::SpriteHighTile:
+					_fetchSprite(MemoryAccessAction::HighTileFetch);
+					break;
 				default:
 					break;
 			}
 		}
-		else if(_cycleCountPerScanline == 256)
+
+		_incrementCycleAndScanline();
+	}
+
+	void PPU::forceCurrentScanline(sint32 value)
+	{
+		_hot.cycleCountPerScanline = 0;
+		_hot.currentScanline = value;
+		_hot.scanlineActions = DotActions.scanlineActions(_cold.region, _hot.currentScanline);
+	}
+
+	void PPU::run(uint32 dotCount)
+	{
+		while (dotCount > 0)
+		{
+			uint32 idleDots = std::min(_idleDotCount(), dotCount);
+			if (idleDots == 0)
+			{
+				tick();
+				--dotCount;
+				continue;
+			}
+
+			// Only the backdrop is drawn on a visible scanline with rendering disabled
+			if (_hot.currentScanline >= 0 && _hot.currentScanline < PostRenderScanline
+				&& _hot.cycleCountPerScanline < ScanlineWidth)
+			{
+				_renderBackground(_hot.cycleCountPerScanline + idleDots);
+			}
+
+			_advanceDots(idleDots);
+			dotCount -= idleDots;
+		}
+	}
+
+	void PPU::replay(const PPUWriteLog::Entry& entry)
+	{
+		// The dot count restarts at power on
+		if (entry.type == PPUWriteLog::EntryType::PowerOn)
+		{
+			powerOn();
+			return;
+		}
+
+		// Both PPUs ran the same dots before the access
+		run(entry.dot - _hot.dotCount);
+
+		switch(entry.type)
+		{
+			case PPUWriteLog::EntryType::Write:
+				write(entry.address, entry.value);
+				break;
+			case PPUWriteLog::EntryType::Read:
+				read(entry.address);
+				break;
+			case PPUWriteLog::EntryType::Mirroring:
+				setNametableMirroring(static_cast<NameTableMirroring>(entry.value));
+				break;
+			case PPUWriteLog::EntryType::Region:
+				setRegion(static_cast<Region>(entry.value));
+				break;
+			case PPUWriteLog::EntryType::TimingOnly:
+				setTimingOnly(entry.value != 0);
+				break;
+			default:
+				break;
+		}
+	}
+
+	void PPU::_startFrame()
+	{
+		_hot.isTimingOnlyFrame = _isTimingOnly;
+
+		// Nothing changed since the previous frame started: the frame buffer already holds this frame
+		PictureRegisters pictureRegisters = _pictureRegisters();
+		_hot.isUnchangedFrame = !_hot.isTimingOnlyFrame && _isFrameComplete
+			&& _stateGeneration == _frameGeneration && pictureRegisters == _frameRegisters;
+		_frameGeneration = _stateGeneration;
+		_frameRegisters = pictureRegisters;
+	}
+
+	void PPU::_startVBlank()
+	{
+		if (!_hot.skipNmi)
+		{
+			_hot.ppuStatus.vblankStarted = true;
+			_hot.irqNotRead = true;
+		}
+		else
+		{
+			_hot.skipNmi = false;
+		}
+
+		_isFrameComplete = !_hot.isTimingOnlyFrame;
+
+		// The frame buffer of an unchanged frame still holds the hashed frame
+		if (_isFrameHashing && _isFrameComplete && !_hot.isUnchangedFrame && _frameBuffer.pixels)
+		{
+			_frameHash = hashFrame(_frameBuffer);
+		}
+
+		// The back frame of an unchanged frame is older, the frame is the one published last
+		FrameBuffer completedFrame = _frameBuffer;
+		if (_frameTripleBuffer && _isFrameComplete)
+		{
+			if (!_hot.isUnchangedFrame)
+			{
+				_publishedFrame = _frameBuffer;
+				_frameBuffer = _frameTripleBuffer->publish(_cold.burstPhase);
+			}
+			completedFrame = _publishedFrame;
+		}
+
+		if (_observationStack && _isFrameComplete && completedFrame.pixels)
 		{
-			_spriteEvaluation();
+			_observationStack->addFrame(completedFrame, _rgbPalette);
+		}
 
-			_backgroundByteFetch(MemoryAccessAction::HighTileFetch);
+		// The frame is complete once this dot has run
+		_logEntry(PPUWriteLog::EntryType::Frame, _hot.dotCount + 1, 0, 0);
 
-			_incrementPpuAddressHorizontal();
-			_incrementPpuAddressVertical();
+		if (_io)
+		{
+			FrameInfo frameInfo;
+			frameInfo.frameBuffer = completedFrame;
+			frameInfo.isRendered = !_hot.isTimingOnlyFrame;
+			frameInfo.isUnchanged = _hot.isUnchangedFrame;
+			frameInfo.hash = frameInfo.isRendered ? _frameHash : 0;
+			frameInfo.burstPhase = _cold.burstPhase;
+
+			_io->onFrame(frameInfo);
 		}
-		else if(_cycleCountPerScanline >= 257 && _cycleCountPerScanline < 321)
+	}
+
+	void PPU::_endFrame()
+	{
+		// A scanline is 341 dots of 8 subcarrier samples, 4 twelfths of a cycle
+		uint32 phaseAdvance = _cold.timing->lastScanline + 2;
+
+		if (!_hot.isEvenFrame && _cold.timing->skipsOddFrameDot && _isRenderingEnabled())
 		{
-			if (_cycleCountPerScanline == 257)
-			{
-				_resetHorizontalPpuAddress();
+			++_hot.cycleCountPerScanline;
+			// One dot less moves the phase back by 8 twelfths
+			phaseAdvance += 1;
+		}
+		_hot.isEvenFrame = !_hot.isEvenFrame;
 
-				_spriteEval.clear();
-				_currentSpriteFetched = 0;
-				for (uint32 i = 0; i < 8; ++i)
-				{
-					_spritesToRender[i].clear();
-				}
-			}
+		_cold.burstPhase = (_cold.burstPhase + phaseAdvance) % NtscPhaseCount;
+		++_cold.frameCount;
+	}
 
-			_oamAddress = 0;
+	void PPU::_clearSecondaryOAM()
+	{
+		if (_hot.secondaryOAMIndex < sizeof(_hot.secondaryOAM))
+		{
+			_secondaryOAMByte(_hot.secondaryOAMIndex) = 0xFF;
+		}
+		++_hot.secondaryOAMIndex;
+		if (_hot.secondaryOAMIndex > 32)
+		{
+			_hot.secondaryOAMIndex = 0;
+			_hot.spriteEval.oamIndex = _hot.oamAddress / 4;
+		}
+	}
 
-			auto whichAction = static_cast<PPU::MemoryAccessAction>(_cycleCountPerScanline % 8);
-			switch(whichAction)
-			{
-				case MemoryAccessAction::NametableFetch:
-					{
-						if (!_secondaryOAM[_currentSpriteFetched].isNull())
-						{
-							_spritesToRender[_currentSpriteFetched].x = _secondaryOAM[_currentSpriteFetched].x;
-							_spritesToRender[_currentSpriteFetched].attribute = _secondaryOAM[_currentSpriteFetched].attributes;
-							_spritesToRender[_currentSpriteFetched].isFirstSprite = (unsigned)_secondaryOAM[_currentSpriteFetched].attributes.unimplemented;
-						}
-						break;
-					}
-				case MemoryAccessAction::LowTileFetch:
-					if (!_secondaryOAM[_currentSpriteFetched].isNull())
-					{
-						_spriteByteFetch(whichAction);
-					}
-					break;
-				case MemoryAccessAction::HighTileFetch:
-					if (!_secondaryOAM[_currentSpriteFetched].isNull())
-					{
-						_spriteByteFetch(whichAction);
+	void PPU::_startSpriteFetch()
+	{
+		_resetHorizontalPpuAddress();
 
-						++_currentSpriteFetched;
-					}
-					break;
-				default:
-					break;
-			}
+		_hot.spriteEval.clear();
+		_hot.currentSpriteFetched = 0;
+		for (uint32 i = 0; i < 8; ++i)
+		{
+			_hot.spritesToRender[i].clear();
 		}
-		else if(_cycleCountPerScanline >= 321 && _cycleCountPerScanline < 337)
+	}
+
+	void PPU::_latchSprite()
+	{
+		// Rendering enabled after dot 257 skips _startSpriteFetch(), the 8 slots may already be fetched
+		if (_hot.currentSpriteFetched >= 8)
 		{
-			if (_cycleCountPerScanline == 321)
-			{
-				while (!_backgroundAttributeQueue.empty())
-				{
-					_backgroundAttributeQueue.pop();
-				}
-				while (!_backgroundPatternQueue.empty())
-				{
-					_backgroundPatternQueue.pop();
-				}
-				while(!_attributeBitsQueue.empty())
-				{
-					_attributeBitsQueue.pop();
-				}
-			}
+			return;
+		}
 
-			auto whichAction = _cycleCountPerScanline % 8;
-			switch(whichAction)
-			{
-				case MemoryAccessAction::NametableFetch:
-					_nametableFetch();
-					break;
-				case MemoryAccessAction::AttributeFetch:
-					_attributeFetch();
-					break;
-				case MemoryAccessAction::LowTileFetch:
-					_backgroundByteFetch(MemoryAccessAction::LowTileFetch);
-					break;
-				case MemoryAccessAction::HighTileFetch:
-					_backgroundByteFetch(MemoryAccessAction::HighTileFetch);
+		if (!_hot.secondaryOAM[_hot.currentSpriteFetched].isNull())
+		{
+			_hot.spritesToRender[_hot.currentSpriteFetched].x = _hot.secondaryOAM[_hot.currentSpriteFetched].x;
+			_hot.spritesToRender[_hot.currentSpriteFetched].attribute = _hot.secondaryOAM[_hot.currentSpriteFetched].attributes;
+			// Only the first slot can hold sprite 0, the others may keep 0xFF bytes of a partial clear
+			_hot.spritesToRender[_hot.currentSpriteFetched].isFirstSprite = _hot.currentSpriteFetched == 0
+				&& (unsigned)_hot.secondaryOAM[_hot.currentSpriteFetched].attributes.unimplemented;
+		}
+	}
 
-					_incrementPpuAddressHorizontal();
-					break;
-				default:
-					break;
-			}
+	void PPU::_fetchSprite(PPU::MemoryAccessAction memoryAccess)
+	{
+		if (_hot.currentSpriteFetched >= 8)
+		{
+			return;
 		}
-		else
+
+		if (!_hot.secondaryOAM[_hot.currentSpriteFetched].isNull())
 		{
-			switch(_cycleCountPerScanline)
+			_spriteByteFetch(memoryAccess);
+
+			if (memoryAccess == MemoryAccessAction::HighTileFetch)
 			{
-				case 338:
-				case 340:
-					_nametableFetch();
-					break;
-				default:
-					break;
+				++_hot.currentSpriteFetched;
 			}
 		}
 	}
 
+	void PPU::_clearBackgroundQueues()
+	{
+		_hot.backgroundAttributeQueue.clear();
+		_hot.backgroundPatternQueue.clear();
+		_hot.attributeBitsQueue.clear();
+	}
+
 	void PPU::_spriteEvaluation()
 	{
-		auto spriteSize = (unsigned)_ppuControl.spriteSize ? 16 : 8;
+		auto spriteSize = (unsigned)_hot.ppuControl.spriteSize ? 16 : 8;
 
-		switch(_spriteEval.currentState)
+		switch(_hot.spriteEval.currentState)
 		{
 		case SpriteEvaluation::CheckSpriteInRange:
 			{
-				byte y = _sprites[_spriteEval.oamIndex].y;
-				auto range = _currentScanline - y;
+				byte y = _cold.sprites[_hot.spriteEval.oamIndex].y;
+				auto range = _hot.currentScanline - y;
 				if (range >= 0 && range < spriteSize)
 				{
-					if (_spriteEval.spritesFound < 8)
+					if (_hot.spriteEval.spritesFound < 8)
 					{
-						_secondaryOAM[_spriteEval.spritesFound] = _sprites[_spriteEval.oamIndex];
-						_secondaryOAM[_spriteEval.spritesFound].attributes.unimplemented = static_cast<byte>((_spriteEval.oamIndex == 0));
+						_hot.secondaryOAM[_hot.spriteEval.spritesFound] = _cold.sprites[_hot.spriteEval.oamIndex];
+						_hot.secondaryOAM[_hot.spriteEval.spritesFound].attributes.unimplemented = static_cast<byte>((_hot.spriteEval.oamIndex == 0));
 
-						++_spriteEval.spritesFound;
+						++_hot.spriteEval.spritesFound;
 					}
 				}
-				_spriteEval.currentState = SpriteEvaluation::GotoNextSprite;
+				_hot.spriteEval.currentState = SpriteEvaluation::GotoNextSprite;
 				break;
 			}
 		case SpriteEvaluation::GotoNextSprite:
 			{
-				++_spriteEval.oamIndex;
-				if (_spriteEval.oamIndex >= 64)
+				++_hot.spriteEval.oamIndex;
+				if (_hot.spriteEval.oamIndex >= 64)
 				{
-					_spriteEval.oamIndex = 0;
+					_hot.spriteEval.oamIndex = 0;
 				}
 
-				if (_spriteEval.oamIndex == 0)
+				if (_hot.spriteEval.oamIndex == 0)
 				{
-					_spriteEval.currentState = SpriteEvaluation::Done;
+					_hot.spriteEval.currentState = SpriteEvaluation::Done;
 				}
-				else if (_spriteEval.spritesFound < 8)
+				else if (_hot.spriteEval.spritesFound < 8)
 				{
-					_spriteEval.currentState = SpriteEvaluation::CheckSpriteInRange;
+					_hot.spriteEval.currentState = SpriteEvaluation::CheckSpriteInRange;
 				}
-				else if (_spriteEval.spritesFound == 8)
+				else if (_hot.spriteEval.spritesFound == 8)
 				{
-					_spriteEval.currentState = SpriteEvaluation::CheckSpriteOverflow;
+					_hot.spriteEval.currentState = SpriteEvaluation::CheckSpriteOverflow;
 				}
 				break;
 			}
 		case SpriteEvaluation::CheckSpriteOverflow:
 			{
-				byte y = _sprites[_spriteEval.oamIndex].y;
-				auto range = _currentScanline - y;
+				byte y = _cold.sprites[_hot.spriteEval.oamIndex].y;
+				auto range = _hot.currentScanline - y;
 				if (range >= 0 && range < spriteSize)
 				{
-					_ppuStatus.spriteOverflow = true;
+					_hot.ppuStatus.spriteOverflow = true;
 				}
 
-				++_spriteEval.oamIndex;
-				if (_spriteEval.oamIndex > 64)
+				++_hot.spriteEval.oamIndex;
+				if (_hot.spriteEval.oamIndex > 64)
 				{
-					_spriteEval.oamIndex = 0;
-					_spriteEval.currentState = SpriteEvaluation::Done;
+					_hot.spriteEval.oamIndex = 0;
+					_hot.spriteEval.currentState = SpriteEvaluation::Done;
 				}
 				break;
 			}
 		case SpriteEvaluation::Done:
+			if (_hot.spriteEval.isCached && _hot.dotCount == _hot.spriteEval.overflowDot)
+			{
+				_hot.ppuStatus.spriteOverflow = true;
+			}
 			break;
 		}
 	}
 
-	bool PPU::_isRenderingEnabled() const
+	void PPU::_startSpriteEvaluation()
+	{
+		// Evaluation starting past sprite 0 is left to the state machine, as is the pre-render scanline.
+		// The state machine was not reset when rendering was disabled at dot 257.
+		if (_hot.spriteEval.currentState != SpriteEvaluation::CheckSpriteInRange
+			|| _hot.spriteEval.spritesFound != 0 || _hot.spriteEval.oamIndex != 0 || _hot.currentScanline < 0)
+		{
+			return;
+		}
+
+		memcpy(_hot.spriteEval.secondaryOAM, _hot.secondaryOAM, sizeof(_hot.spriteEval.secondaryOAM));
+
+		const SpritesInRange& line = _spritesInRange(_hot.currentScanline);
+
+		byte spritesFound = std::min<byte>(line.count, 8);
+		for (byte index = 0; index < spritesFound; ++index)
+		{
+			byte oamIndex = line.oamIndices[index];
+			_hot.secondaryOAM[index] = _cold.sprites[oamIndex];
+			_hot.secondaryOAM[index].attributes.unimplemented = static_cast<byte>(oamIndex == 0);
+		}
+
+		_hot.spriteEval.spritesFound = spritesFound;
+		_hot.spriteEval.currentState = SpriteEvaluation::Done;
+		_hot.spriteEval.isCached = true;
+		_hot.spriteEval.startDot = _hot.dotCount;
+
+		// Dot where the state machine sets the overflow flag: 2 dots per sprite up to the 8th found,
+		// then 1 dot per sprite. The 8th found being the last sprite ends the evaluation instead.
+		_hot.spriteEval.overflowDot = _hot.dotCount + SpriteEvaluationDots;
+		if (spritesFound == 8 && line.oamIndices[7] < 63)
+		{
+			_hot.spriteEval.overflowDot = _hot.dotCount + 1 + line.oamIndices[7] + line.overflowIndex;
+		}
+	}
+
+	const SpritesInRange& PPU::_spritesInRange(uint32 scanline)
+	{
+		SpritesInRange& line = _cold.spriteLines[scanline];
+		if (_cold.spriteLineStamps[scanline] != _cold.spriteLineGeneration)
+		{
+			_findSpritesInRange(_cold.spriteY, scanline, (unsigned)_hot.ppuControl.spriteSize ? 16 : 8, line);
+			_cold.spriteLineStamps[scanline] = _cold.spriteLineGeneration;
+		}
+
+		return line;
+	}
+
+	void PPU::_catchUpSpriteEvaluation()
 	{
-		return (unsigned)_ppuMask.showBackground || (unsigned)_ppuMask.showSprites;
+		if (!_hot.spriteEval.isCached)
+		{
+			return;
+		}
+
+		_hot.spriteEval.isCached = false;
+
+		// The whole evaluation ran with the same state, the cached result stands
+		uint32 evaluatedDots = _hot.dotCount - _hot.spriteEval.startDot;
+		if (evaluatedDots >= SpriteEvaluationDots)
+		{
+			return;
+		}
+
+		// OAM, the sprite size or rendering is about to change: run the state machine
+		// over the dots done so far so it can carry on from the current dot
+		memcpy(_hot.secondaryOAM, _hot.spriteEval.secondaryOAM, sizeof(_hot.spriteEval.secondaryOAM));
+		_hot.spriteEval.clear();
+
+		for (uint32 dot = 0; dot < evaluatedDots; ++dot)
+		{
+			_spriteEvaluation();
+		}
 	}
 
 	bool PPU::_isOutsideRendering() const
 	{
-		if ((_currentScanline >= PostRenderScanline && _currentScanline <= ScanlinePerFrame) || (_currentScanline == PreRenderScanline))
+		if ((_hot.currentScanline >= PostRenderScanline && _hot.currentScanline <= _cold.timing->lastScanline) || (_hot.currentScanline == PreRenderScanline))
 		{
 			return true;
 		}
@@ -519,38 +1111,38 @@ namespace sukiNES
 
 	void PPU::_nametableFetch()
 	{
-		word nametableAddress = 0x2000 | (_currentPpuAddress.raw & 0x0FFF);
-		_lastReadNametableByte = _internalRead(nametableAddress);
+		word nametableAddress = 0x2000 | (_hot.currentPpuAddress.raw & 0x0FFF);
+		_hot.lastReadNametableByte = _readPage(nametableAddress);
 	}
 
 	void PPU::_attributeFetch()
 	{
 		word attributeAddress = 0x23C0
-			| (_currentPpuAddress.raw & 0x0C00) // Nametable select
-			| ((_currentPpuAddress.raw >> 4) & 0x38) // High 3 bits of Coarse Y (y/4)
-			| ((_currentPpuAddress.raw >> 2) & 0x07); // High 3 bits of Coarse X (x/4)
-		_backgroundAttributeQueue.push( _internalRead(attributeAddress) );
+			| (_hot.currentPpuAddress.raw & 0x0C00) // Nametable select
+			| ((_hot.currentPpuAddress.raw >> 4) & 0x38) // High 3 bits of Coarse Y (y/4)
+			| ((_hot.currentPpuAddress.raw >> 2) & 0x07); // High 3 bits of Coarse X (x/4)
+		_hot.backgroundAttributeQueue.push( _readPage(attributeAddress) );
 
-		auto attributeX = (unsigned)_currentPpuAddress.coarseXScroll % 4;
-		auto attributeY = (unsigned)_currentPpuAddress.coarseYScroll % 4;
+		auto attributeX = (unsigned)_hot.currentPpuAddress.coarseXScroll % 4;
+		auto attributeY = (unsigned)_hot.currentPpuAddress.coarseYScroll % 4;
 		byte whichAttributeBits = (attributeX >> 1) | (attributeY & 2);
 
-		_attributeBitsQueue.push(whichAttributeBits);
+		_hot.attributeBitsQueue.push(whichAttributeBits);
 	}
 
 	void PPU::_backgroundByteFetch(PPU::MemoryAccessAction memoryAccess)
 	{
-		byte readTile = _readTile((unsigned)_ppuControl.backgroundPatternTable, _lastReadNametableByte, (unsigned)_currentPpuAddress.fineYScroll, memoryAccess);
+		byte readTile = _readTile((unsigned)_hot.ppuControl.backgroundPatternTable, _hot.lastReadNametableByte, (unsigned)_hot.currentPpuAddress.fineYScroll, memoryAccess);
 
 		switch(memoryAccess)
 		{
 		case MemoryAccessAction::LowTileFetch:
-			_tempBackgroundPattern.lowByte = readTile;
+			_hot.tempBackgroundPattern.lowByte = readTile;
 			break;
 		case MemoryAccessAction::HighTileFetch:
-			_tempBackgroundPattern.highByte = readTile;
+			_hot.tempBackgroundPattern.highByte = readTile;
 
-			_backgroundPatternQueue.push(_tempBackgroundPattern);
+			_hot.backgroundPatternQueue.push(_hot.tempBackgroundPattern);
 			break;
 		default:
 			break;
@@ -559,21 +1151,21 @@ namespace sukiNES
 
 	void PPU::_spriteByteFetch(PPU::MemoryAccessAction memoryAccess)
 	{
-		auto spriteSize = (unsigned)_ppuControl.spriteSize ? 16 : 8;
+		auto spriteSize = (unsigned)_hot.ppuControl.spriteSize ? 16 : 8;
 
 		byte bank = 0;
 		byte tileNumber = 0;
 
-		byte fineY = _currentScanline - _secondaryOAM[_currentSpriteFetched].y;
-		if ((unsigned)_secondaryOAM[_currentSpriteFetched].attributes.flipVertical)
+		byte fineY = _hot.currentScanline - _hot.secondaryOAM[_hot.currentSpriteFetched].y;
+		if ((unsigned)_hot.secondaryOAM[_hot.currentSpriteFetched].attributes.flipVertical)
 		{
 			fineY ^= 0xF;
 		}
 
 		if (spriteSize == 16)
 		{
-			bank = _secondaryOAM[_currentSpriteFetched].tileIndex & 1;
-			tileNumber = (_secondaryOAM[_currentSpriteFetched].tileIndex & 0xFE);
+			bank = _hot.secondaryOAM[_hot.currentSpriteFetched].tileIndex & 1;
+			tileNumber = (_hot.secondaryOAM[_hot.currentSpriteFetched].tileIndex & 0xFE);
 
 			if (fineY & 8)
 			{
@@ -582,8 +1174,8 @@ namespace sukiNES
 		}
 		else
 		{
-			bank = (unsigned)_ppuControl.spritePatternTable;
-			tileNumber = _secondaryOAM[_currentSpriteFetched].tileIndex;
+			bank = (unsigned)_hot.ppuControl.spritePatternTable;
+			tileNumber = _hot.secondaryOAM[_hot.currentSpriteFetched].tileIndex;
 		}
 
 		fineY &= 7;
@@ -592,10 +1184,10 @@ namespace sukiNES
 		switch(memoryAccess)
 		{
 		case MemoryAccessAction::LowTileFetch:
-			_spritesToRender[_currentSpriteFetched].pattern.lowByte = readTile;
+			_hot.spritesToRender[_hot.currentSpriteFetched].pattern.lowByte = readTile;
 			break;
 		case MemoryAccessAction::HighTileFetch:
-			_spritesToRender[_currentSpriteFetched].pattern.highByte = readTile;
+			_hot.spritesToRender[_hot.currentSpriteFetched].pattern.highByte = readTile;
 			break;
 		default:
 			break;
@@ -608,73 +1200,139 @@ namespace sukiNES
 
 		uint16 chrAddress = patternBank*0x1000 | (tileNumber*16 + fineY + highTileOffset);
 
-		return _internalRead(chrAddress);
+		return _readPage(chrAddress);
 	}
 
 	void PPU::_prepareNextTile()
 	{
-		if (!_backgroundPatternQueue.empty())
+		if (!_hot.backgroundPatternQueue.empty())
 		{
-			_currentBackgroundPattern = _backgroundPatternQueue.front();
-			_backgroundPatternQueue.pop();
+			_hot.currentBackgroundPattern = _hot.backgroundPatternQueue.front();
+			_hot.backgroundPatternQueue.pop();
 		}
 
-		if (!_backgroundAttributeQueue.empty())
+		if (!_hot.backgroundAttributeQueue.empty())
 		{
-			_currentAttribute = _backgroundAttributeQueue.front();
-			_backgroundAttributeQueue.pop();
+			_hot.currentAttribute = _hot.backgroundAttributeQueue.front();
+			_hot.backgroundAttributeQueue.pop();
 		}
 
-		if (!_attributeBitsQueue.empty())
+		if (!_hot.attributeBitsQueue.empty())
 		{
-			_currentAttributeBits = _attributeBitsQueue.front();
-			_attributeBitsQueue.pop();
+			_hot.currentAttributeBits = _hot.attributeBitsQueue.front();
+			_hot.attributeBitsQueue.pop();
 		}
 	}
 
 	void PPU::_incrementCycleAndScanline()
 	{
-		_cycleCountPerScanline++;
-		if (_cycleCountPerScanline > CyclesPerScanline)
+		++_hot.dotCount;
+		_hot.cycleCountPerScanline++;
+		if (_hot.cycleCountPerScanline > CyclesPerScanline)
+		{
+			_hot.cycleCountPerScanline = 0;
+			_hot.currentScanline++;
+			if (_hot.currentScanline > _cold.timing->lastScanline)
+			{
+				_hot.currentScanline = -1;
+			}
+			_hot.scanlineActions = DotActions.scanlineActions(_cold.region, _hot.currentScanline);
+		}
+	}
+
+	void PPU::_advanceDots(uint32 dotCount)
+	{
+		_hot.dotCount += dotCount;
+		_hot.cycleCountPerScanline += dotCount;
+		while (_hot.cycleCountPerScanline > CyclesPerScanline)
+		{
+			_hot.cycleCountPerScanline -= DotsPerScanline;
+			_hot.currentScanline++;
+			if (_hot.currentScanline > _cold.timing->lastScanline)
+			{
+				_hot.currentScanline = -1;
+			}
+			_hot.scanlineActions = DotActions.scanlineActions(_cold.region, _hot.currentScanline);
+		}
+	}
+
+	uint32 PPU::_idleDotCount() const
+	{
+		// Number of dots ahead for which tick() has no effect besides drawing the backdrop
+		if (_hot.currentScanline >= 0 && _hot.currentScanline < PostRenderScanline)
+		{
+			// Dot 0 prepares the sprite layers and dot 255 outputs the scanline
+			if (_isRenderingEnabled() || _hot.cycleCountPerScanline == 0 || _hot.cycleCountPerScanline == 255)
+			{
+				return 0;
+			}
+
+			return _hot.cycleCountPerScanline < 255 ? 255 - _hot.cycleCountPerScanline : DotsPerScanline - _hot.cycleCountPerScanline;
+		}
+		else if (_hot.currentScanline == PreRenderScanline)
 		{
-			_cycleCountPerScanline = 0;
-			_currentScanline++;
-			if (_currentScanline > ScanlinePerFrame)
+			// Dot 1 clears PPUSTATUS and dot 339 ends the frame
+			if (_isRenderingEnabled() || _hot.cycleCountPerScanline == 1 || _hot.cycleCountPerScanline == 339)
 			{
-				_currentScanline = -1;
+				return 0;
 			}
+
+			if (_hot.cycleCountPerScanline < 1)
+			{
+				return 1 - _hot.cycleCountPerScanline;
+			}
+
+			return _hot.cycleCountPerScanline < 339 ? 339 - _hot.cycleCountPerScanline : DotsPerScanline - _hot.cycleCountPerScanline;
+		}
+
+		// From the post-render scanline to the end of VBlank, only the start of VBlank matters
+		sint32 vblankScanline = _cold.timing->vblankScanline;
+		if (_hot.currentScanline < vblankScanline || (_hot.currentScanline == vblankScanline && _hot.cycleCountPerScanline < 1))
+		{
+			return _dotsUntil(vblankScanline, 1);
+		}
+		else if (_hot.currentScanline == vblankScanline && _hot.cycleCountPerScanline == 1)
+		{
+			return 0;
 		}
+
+		return _dotsUntil(_cold.timing->lastScanline + 1, 0);
+	}
+
+	uint32 PPU::_dotsUntil(sint32 scanline, uint32 cycle) const
+	{
+		return (scanline - _hot.currentScanline) * DotsPerScanline + cycle - _hot.cycleCountPerScanline;
 	}
 
 	void PPU::_incrementPpuAddressHorizontal()
 	{
-		if ((unsigned)_currentPpuAddress.coarseXScroll == 31)
+		if ((unsigned)_hot.currentPpuAddress.coarseXScroll == 31)
 		{
-			_currentPpuAddress.coarseXScroll = 0;
+			_hot.currentPpuAddress.coarseXScroll = 0;
 			// Switch horizontal nametable
-			_currentPpuAddress.nametableSelect = (unsigned)_currentPpuAddress.nametableSelect ^ SUKINES_BIT(0);
+			_hot.currentPpuAddress.nametableSelect = (unsigned)_hot.currentPpuAddress.nametableSelect ^ SUKINES_BIT(0);
 		}
 		else
 		{
-			_currentPpuAddress.coarseXScroll = (unsigned)_currentPpuAddress.coarseXScroll + 1;
+			_hot.currentPpuAddress.coarseXScroll = (unsigned)_hot.currentPpuAddress.coarseXScroll + 1;
 		}
 	}
 
 	void PPU::_incrementPpuAddressVertical()
 	{
-		if ((unsigned)_currentPpuAddress.fineYScroll < 7)
+		if ((unsigned)_hot.currentPpuAddress.fineYScroll < 7)
 		{
-			_currentPpuAddress.fineYScroll = ((unsigned)_currentPpuAddress.fineYScroll) + 1;
+			_hot.currentPpuAddress.fineYScroll = ((unsigned)_hot.currentPpuAddress.fineYScroll) + 1;
 		}
 		else
 		{
-			_currentPpuAddress.fineYScroll = 0;
-			unsigned y = (unsigned)_currentPpuAddress.coarseYScroll;
+			_hot.currentPpuAddress.fineYScroll = 0;
+			unsigned y = (unsigned)_hot.currentPpuAddress.coarseYScroll;
 			if (y == 29)
 			{
 				y = 0;
 				// Switch vertical nametable
-				_currentPpuAddress.nametableSelect = (unsigned)_currentPpuAddress.nametableSelect ^ SUKINES_BIT(1);
+				_hot.currentPpuAddress.nametableSelect = (unsigned)_hot.currentPpuAddress.nametableSelect ^ SUKINES_BIT(1);
 			}
 			else if (y == 31)
 			{
@@ -685,34 +1343,34 @@ namespace sukiNES
 				++y;
 			}
 
-			_currentPpuAddress.coarseYScroll = y;
+			_hot.currentPpuAddress.coarseYScroll = y;
 		}
 	}
 
 	void PPU::_resetHorizontalPpuAddress()
 	{
-		_currentPpuAddress.coarseXScroll = (unsigned)_temporaryPpuAddress.coarseXScroll;
-		_currentPpuAddress.nametableSelect = ((unsigned)_currentPpuAddress.nametableSelect & ~SUKINES_BIT(0)) | ((unsigned)_temporaryPpuAddress.nametableSelect & SUKINES_BIT(0));
+		_hot.currentPpuAddress.coarseXScroll = (unsigned)_hot.temporaryPpuAddress.coarseXScroll;
+		_hot.currentPpuAddress.nametableSelect = ((unsigned)_hot.currentPpuAddress.nametableSelect & ~SUKINES_BIT(0)) | ((unsigned)_hot.temporaryPpuAddress.nametableSelect & SUKINES_BIT(0));
 	}
 
 	void PPU::_resetVerticalPpuAddress()
 	{
-		_currentPpuAddress.coarseYScroll = (unsigned)_temporaryPpuAddress.coarseYScroll;
-		_currentPpuAddress.fineYScroll = (unsigned)_temporaryPpuAddress.fineYScroll;
-		_currentPpuAddress.nametableSelect = ((unsigned)_currentPpuAddress.nametableSelect & ~SUKINES_BIT(1)) | ((unsigned)_temporaryPpuAddress.nametableSelect & SUKINES_BIT(1));
+		_hot.currentPpuAddress.coarseYScroll = (unsigned)_hot.temporaryPpuAddress.coarseYScroll;
+		_hot.currentPpuAddress.fineYScroll = (unsigned)_hot.temporaryPpuAddress.fineYScroll;
+		_hot.currentPpuAddress.nametableSelect = ((unsigned)_hot.currentPpuAddress.nametableSelect & ~SUKINES_BIT(1)) | ((unsigned)_hot.temporaryPpuAddress.nametableSelect & SUKINES_BIT(1));
 	}
 
 	void PPU::_incrementPpuAddressOnReadWrite()
 	{
 		if (_isOutsideRendering())
 		{
-			if ((unsigned)_ppuControl.addressIncrement)
+			if ((unsigned)_hot.ppuControl.addressIncrement)
 			{
-				_currentPpuAddress.raw += 32;
+				_hot.currentPpuAddress.raw += 32;
 			}
 			else
 			{
-				++_currentPpuAddress.raw;
+				++_hot.currentPpuAddress.raw;
 			}
 		}
 		else
@@ -721,166 +1379,284 @@ namespace sukiNES
 		}
 	}
 
-	void PPU::_renderPixel()
+	void PPU::_prepareSpriteLayers()
 	{
-		union
-		{
-			byte raw;
-			RegBit<0,2> pixelTile;
-			RegBit<2,2> paletteNumber;
-			RegBit<4> isSpritePalette;
-		} paletteIndex;
-
-		paletteIndex.raw = 0;
-
-		bool renderSprite = false;
-		byte backgroundPixel = 0;
-		byte backgroundAttribute = 0;
-		byte spritePixel = 0;
-		byte spriteAttribute = 0;
+		_hot.compositedX = 0;
+		_cold.outputStartX = 0;
 
-		if ((unsigned)_ppuMask.showBackground)
+		if (_isSkippingComposition())
 		{
-			uint32 backgroundColumn = 7 - ((_cycleCountPerScanline+_fineXScroll) % 8);
-			backgroundPixel = _currentBackgroundPattern.pixel(backgroundColumn);
-			backgroundAttribute = (_currentAttribute >> (_currentAttributeBits * 2)) & 0x3;
+			_prepareSprite0Layer();
+			return;
 		}
 
-		if ((unsigned)_ppuMask.showSprites)
+		std::fill(std::begin(_cold.spriteLayer), std::end(_cold.spriteLayer), 0);
+		std::fill(std::begin(_cold.frontSpriteLayer), std::end(_cold.frontSpriteLayer), 0);
+		std::fill(std::begin(_cold.sprite0Layer), std::end(_cold.sprite0Layer), 0);
+
+		// Sprites are stored in priority order: the first opaque sprite covering a pixel
+		// is drawn when the background is transparent, the first opaque front sprite otherwise.
+		for (uint32 spriteIndex = 0; spriteIndex < 8; ++spriteIndex)
 		{
-			if (!((unsigned)_ppuMask.showSpritesLeftmost) && _cycleCountPerScanline < 8)
+			const SpriteRenderingEntry& sprite = _hot.spritesToRender[spriteIndex];
+			if (sprite.x < 0)
 			{
+				continue;
 			}
-			else
+
+			byte spritePalette = 0x10 | ((unsigned)sprite.attribute.palette << 2);
+			bool isInFront = !(unsigned)sprite.attribute.priority;
+
+			sint32 endX = std::min<sint32>(sprite.x + 8, ScanlineWidth);
+			for (sint32 screenX = sprite.x; screenX < endX; ++screenX)
 			{
-				for (uint32 spriteIndex = 0; spriteIndex < 8; ++spriteIndex)
+				byte spritePixel = sprite.pixel(screenX);
+				if (!spritePixel)
 				{
-					if (_spritesToRender[spriteIndex].inRange(_cycleCountPerScanline))
-					{
-						spritePixel = _spritesToRender[spriteIndex].pixel(_cycleCountPerScanline);
-						spriteAttribute = (unsigned)_spritesToRender[spriteIndex].attribute.palette;
-
-						if (_spritesToRender[spriteIndex].isFirstSprite
-							&& backgroundPixel > 0
-							&& spritePixel > 0
-							&& _cycleCountPerScanline < 255
-							&& (unsigned)_ppuMask.showBackground)
-						{
-							_ppuStatus.sprite0Hit = true;
-						}
-
-						if (backgroundPixel == 0 && spritePixel > 0)
-						{
-							renderSprite = true;
-							break;
-						}
-						if (backgroundPixel > 0 && spritePixel > 0 && !(unsigned)_spritesToRender[spriteIndex].attribute.priority)
-						{
-							renderSprite = true;
-							break;
-						}
-					}
+					continue;
+				}
+
+				// Sprite 0 is only tested when no front sprite before it covers the pixel
+				if (sprite.isFirstSprite && !_cold.frontSpriteLayer[screenX])
+				{
+					_cold.sprite0Layer[screenX] = 0xFF;
+				}
+
+				if (!_cold.spriteLayer[screenX])
+				{
+					_cold.spriteLayer[screenX] = spritePixel | spritePalette;
+				}
+
+				if (isInFront && !_cold.frontSpriteLayer[screenX])
+				{
+					_cold.frontSpriteLayer[screenX] = spritePixel | spritePalette;
 				}
 			}
 		}
+	}
+
+	void PPU::_prepareSprite0Layer()
+	{
+		std::fill(std::begin(_cold.sprite0Layer), std::end(_cold.sprite0Layer), 0);
+
+		// Sprite 0 is always the first sprite to render when it is on the scanline
+		const SpriteRenderingEntry& sprite = _hot.spritesToRender[0];
+		_hot.hasSprite0OnScanline = sprite.x >= 0 && sprite.isFirstSprite;
+		if (!_hot.hasSprite0OnScanline)
+		{
+			return;
+		}
 
-		if (renderSprite)
+		sint32 endX = std::min<sint32>(sprite.x + 8, ScanlineWidth);
+		for (sint32 screenX = sprite.x; screenX < endX; ++screenX)
 		{
-			paletteIndex.pixelTile = spritePixel;
-			paletteIndex.paletteNumber = spriteAttribute;
+			_cold.sprite0Layer[screenX] = sprite.pixel(screenX) ? 0xFF : 0;
 		}
-		else if ((unsigned)_ppuMask.showBackground)
+	}
+
+	void PPU::_fetchBackgroundPixel()
+	{
+		uint32 backgroundColumn = 7 - ((_hot.cycleCountPerScanline+_hot.fineXScroll) % 8);
+		byte backgroundAttribute = (_hot.currentAttribute >> (_hot.currentAttributeBits * 2)) & 0x3;
+
+		_cold.backgroundLayer[_hot.cycleCountPerScanline] = _hot.currentBackgroundPattern.pixel(backgroundColumn) | (backgroundAttribute << 2);
+	}
+
+	void PPU::_compositeUpTo(uint32 endX)
+	{
+		if (endX <= _hot.compositedX)
 		{
-			paletteIndex.pixelTile = backgroundPixel;
-			paletteIndex.paletteNumber = backgroundAttribute;
+			return;
+		}
 
-			if (!((unsigned)_ppuMask.showBackgroundLeftmost) && _cycleCountPerScanline < 8)
+		if (_isSkippingComposition())
+		{
+			if (_hot.hasSprite0OnScanline && !(unsigned)_hot.ppuStatus.sprite0Hit)
 			{
-				paletteIndex.raw = 0;
+				ScanlineLayers layers = { _cold.backgroundLayer, nullptr, nullptr, _cold.sprite0Layer };
+				if (detectSprite0Hit(layers, _hot.ppuMask.raw, _hot.compositedX, endX) >= 0)
+				{
+					_hot.ppuStatus.sprite0Hit = true;
+				}
 			}
-		}
 
-		paletteIndex.isSpritePalette = renderSprite;
+			_hot.compositedX = endX;
+			return;
+		}
 
-		if ( !((paletteIndex.raw & 0x1F) & 0x3) )
+		ScanlineLayers layers = { _cold.backgroundLayer, _cold.spriteLayer, _cold.frontSpriteLayer, _cold.sprite0Layer };
+		if (_compositeScanline(layers, _cold.palette, _hot.ppuMask.raw, _hot.compositedX, endX, _cold.scanlineOutput) >= 0)
 		{
-			paletteIndex.raw = 0;
+			_hot.ppuStatus.sprite0Hit = true;
 		}
 
-		_drawPixel(_palette[paletteIndex.raw]);
+		std::fill(_cold.scanlineEmphasis + _hot.compositedX, _cold.scanlineEmphasis + endX, _emphasis());
+
+		_hot.compositedX = endX;
 	}
 
-	void PPU::_renderBackground()
+	void PPU::_catchUpComposition()
 	{
-		if (_currentPpuAddress.raw >= 0x3F00 && _currentPpuAddress.raw  < 0x4000)
+		// Composition is deferred until something can observe it:
+		// a PPUSTATUS read (sprite 0 hit), a PPUMASK or palette write, or the end of the scanline.
+		if (_hot.currentScanline >= 0 && _hot.currentScanline < PostRenderScanline && _isRenderingEnabled())
 		{
-			auto temp = _internalRead(_currentPpuAddress.raw);
-			_drawPixel(temp);
+			_compositeUpTo(std::min<uint32>(_hot.cycleCountPerScanline, ScanlineWidth));
 		}
-		else
+	}
+
+	void PPU::_finishScanline()
+	{
+		if (_isRenderingEnabled())
+		{
+			_compositeUpTo(ScanlineWidth);
+		}
+
+		if (_isSkippingComposition() || !_frameBuffer.pixels)
+		{
+			return;
+		}
+
+		byte* scanline = _frameBuffer.scanline(_hot.currentScanline);
+		switch(_frameBuffer.format)
+		{
+			case PixelFormat::ColorIndex:
+				_outputColorIndices(reinterpret_cast<uint16*>(scanline));
+				break;
+			case PixelFormat::RGB32:
+				_convertScanline(_rgbPalette.rgb32(), reinterpret_cast<uint32*>(scanline));
+				break;
+			case PixelFormat::RGB565:
+				_convertScanline(_rgbPalette.rgb565(), reinterpret_cast<uint16*>(scanline));
+				break;
+			case PixelFormat::Grayscale:
+				_convertScanline(_rgbPalette.grayscale(), scanline);
+				break;
+			default:
+				std::copy(_cold.scanlineOutput + _cold.outputStartX, std::end(_cold.scanlineOutput), scanline + _cold.outputStartX);
+				break;
+		}
+
+		if (_io)
 		{
-			_drawPixel(_palette[0]);
+			_io->onScanline(_hot.currentScanline, scanline);
 		}
 	}
 
-	void PPU::_drawPixel(byte paletteValue)
+	void PPU::_renderBackground(uint32 endX)
 	{
-		if (_io)
+		// Without composition these pixels are still covered, so that sprite 0 hit
+		// is not tested on stale background when rendering is enabled again
+		if (_isSkippingComposition())
 		{
-			if ((unsigned)_ppuMask.greyscale)
-			{
-				paletteValue &= 0x30;
-			}
+			_hot.compositedX = endX;
+			return;
+		}
+
+		// When rendering is off and the PPU address points to the palette, that colour is displayed
+		byte paletteValue = _cold.palette[0];
+		if (_hot.currentPpuAddress.raw >= PaletteAddress && _hot.currentPpuAddress.raw  < 0x4000)
+		{
+			paletteValue = _cold.palette[_hot.currentPpuAddress.raw & PaletteMask];
+		}
 
-			_io->putPixel(_cycleCountPerScanline, _currentScanline, paletteValue);
+		if ((unsigned)_hot.ppuMask.greyscale)
+		{
+			paletteValue &= 0x30;
 		}
+
+		std::fill(_cold.scanlineOutput + _hot.cycleCountPerScanline, _cold.scanlineOutput + endX, paletteValue);
+		std::fill(_cold.scanlineEmphasis + _hot.cycleCountPerScanline, _cold.scanlineEmphasis + endX, _emphasis());
+		_hot.compositedX = endX;
 	}
 
-	byte PPU::_internalRead(word ppuAddress, PPU::ReadSource readSource)
+	PPU::PictureRegisters PPU::_pictureRegisters() const
 	{
-		word realAddress = ppuAddress & PpuMirroringMask;
+		PictureRegisters registers;
 
-		byte returnValue = _readBuffer;
+		// NMI enable and the VRAM increment do not change the picture
+		registers.control = _hot.ppuControl.raw & 0x38;
+		registers.mask = _hot.ppuMask.raw;
+		registers.fineXScroll = _hot.fineXScroll;
+		registers.temporaryPpuAddress = _hot.temporaryPpuAddress.raw;
 
-		if (realAddress < 0x2000)
+		// The PPU address is reloaded from the temporary address when rendering,
+		// otherwise it selects the backdrop colour
+		registers.currentPpuAddress = _isRenderingEnabled() ? 0 : _hot.currentPpuAddress.raw;
+
+		return registers;
+	}
+
+	void PPU::_markStateChanged()
+	{
+		++_stateGeneration;
+
+		if (_hot.isUnchangedFrame)
+		{
+			_resumeComposition();
+		}
+	}
+
+	void PPU::_markRegistersChanged(const PictureRegisters& previous)
+	{
+		// Between frames only the register values at the start of the next frame matter,
+		// they are compared with the previous frame then
+		if (_hot.currentScanline >= PostRenderScanline || _pictureRegisters() == previous)
 		{
-			_readBuffer = _gamePak->readChr(realAddress);
+			return;
 		}
-		else if (realAddress >= 0x2000 && realAddress < 0x3F00)
+
+		_markStateChanged();
+	}
+
+	void PPU::_resumeComposition()
+	{
+		// Scanlines already output are the same as in the previous frame,
+		// compose the rest of the frame starting at the current dot
+		_hot.isUnchangedFrame = false;
+
+		// Only the published frame holds the previous frame, the back frame is older
+		if (_frameTripleBuffer && _publishedFrame.pixels && _hot.currentScanline >= 0)
 		{
-			uint32 nameTableAddress = realAddress & NametableAddressMask;
-			switch(_nametableMirroring)
+			uint32 lineCount = std::min(static_cast<uint32>(_hot.currentScanline) + 1, FrameHeight);
+			for (uint32 y = 0; y < lineCount; ++y)
 			{
-				case PPU::NameTableMirroring::Horizontal:
-				{
-					uint32 inSecondNametable =  ((nameTableAddress & 0x800) >> 1);
-					_readBuffer = _nametable[(nameTableAddress & NametableHorizontalMask) | inSecondNametable];
-					break;
-				}
-				case PPU::NameTableMirroring::Vertical:
-					_readBuffer = _nametable[nameTableAddress & NametableVerticalMask];
-					break;
-				case PPU::NameTableMirroring::FourScreen:
-					break;
-				case PPU::NameTableMirroring::SingleScreen:
-					_readBuffer = _nametable[nameTableAddress & NametableSingleScreenMask];
-					break;
+				memcpy(_frameBuffer.scanline(y), _publishedFrame.scanline(y), FrameWidth * FrameBuffer::bytesPerPixel(_frameBuffer.format));
 			}
 		}
-		else if (realAddress >= 0x3F00 && realAddress < 0x4000)
+
+		if (_hot.currentScanline >= 0 && _hot.currentScanline < PostRenderScanline
+			&& _hot.cycleCountPerScanline > 0 && _hot.cycleCountPerScanline < ScanlineWidth)
+		{
+			_prepareSpriteLayers();
+
+			_hot.compositedX = _hot.cycleCountPerScanline;
+			_cold.outputStartX = _hot.cycleCountPerScanline;
+		}
+	}
+
+	byte PPU::_internalRead(word ppuAddress, PPU::ReadSource readSource)
+	{
+		uint32 realAddress = ppuAddress & PpuMirroringMask;
+
+		byte returnValue = _hot.readBuffer;
+
+		if (realAddress >= PaletteAddress)
 		{
 			// When reading palette data, we need to update 
 			// the read buffer but the data read into the buffer
 			// is the data found at 0x2F[lowerbyte]
 			// This is like we were reading the nametable at the same address
-			_internalRead(0x2F00 | (realAddress & 0xFF));
-			return _palette[(realAddress & PaletteMask)];
+			_hot.readBuffer = _readPage(0x2F00 | (realAddress & 0xFF));
+			return _cold.palette[(realAddress & PaletteMask)];
 		}
 
+		_hot.readBuffer = _readPage(realAddress);
+
 		switch(readSource)
 		{
 		case PPU::ReadSource::FromPPU:
-			return _readBuffer;
+			return _hot.readBuffer;
 		default:
 			return returnValue;
 		}
@@ -888,39 +1664,31 @@ namespace sukiNES
 
 	void PPU::_internalWrite(word ppuAddress, byte value)
 	{
-		word realAddress = ppuAddress & PpuMirroringMask;
-		if (realAddress < 0x2000)
+		uint32 realAddress = ppuAddress & PpuMirroringMask;
+		if (realAddress >= PaletteAddress)
 		{
-			_gamePak->writeChr(ppuAddress, value);
-		}
-		else if (realAddress >= 0x2000 && realAddress < 0x3F00)
-		{
-			uint32 nameTableAddress = realAddress & NametableAddressMask;
-			switch(_nametableMirroring)
+			if (_cold.palette[(realAddress & PaletteMask)] == value)
 			{
-				case PPU::NameTableMirroring::Horizontal:
-				{
-					uint32 inSecondNametable =  ((nameTableAddress & 0x800) >> 1);
-					_nametable[(nameTableAddress & NametableHorizontalMask) | inSecondNametable] = value;
-					break;
-				}
-				case PPU::NameTableMirroring::Vertical:
-					_nametable[nameTableAddress & NametableVerticalMask] = value;
-					break;
-				case PPU::NameTableMirroring::FourScreen:
-					break;
-				case PPU::NameTableMirroring::SingleScreen:
-					_nametable[nameTableAddress & NametableSingleScreenMask] = value;
-					break;
+				return;
+			}
+
+			_cold.palette[(realAddress & PaletteMask)] = value;
+			if (!((realAddress & PaletteMask) & 0x3))
+			{
+				_cold.palette[(realAddress & PaletteMask) ^ 0x10] = value;
 			}
 		}
-		else if (realAddress >= 0x3F00 && realAddress < 0x4000)
+		else
 		{
-			_palette[(realAddress & PaletteMask)] = value;
-			if (!((realAddress & PaletteMask) & 0x3))
+			byte& memory = _pageTable[realAddress >> 10][realAddress & (PpuPageSize - 1)];
+			if (memory == value)
 			{
-				_palette[(realAddress & PaletteMask) ^ 0x10] = value;
+				return;
 			}
+
+			memory = value;
 		}
+
+		_markStateChanged();
 	}
 }
\ No newline at end of file
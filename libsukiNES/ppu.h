@@ -1,15 +1,25 @@
 #pragma once
 
-// STL includes
-#include <queue>
-
 // Local includes
+#include "framebuffer.h"
 #include "memory.h"
+#include "ppuwritelog.h"
+#include "regiontiming.h"
+#include "rgbpalette.h"
+#include "scanlinecompositor.h"
+#include "spriterange.h"
 
 namespace sukiNES
 {
+	static const uint32 PpuPageSize = SUKINES_KB(1);
+	static const uint32 PpuPageCount = 16;
+	static const uint32 ChrPageCount = 8;
+
+	class FrameTripleBuffer;
 	class GamePak;
+	class ObservationStack;
 	class PPUIO;
+	struct PPUDebugState;
 
 	class PPU : public IMemory
 	{
@@ -24,20 +34,32 @@ namespace sukiNES
 
 		void tick();
 
-		void forceCurrentScanline(sint32 value)
-		{
-			_cycleCountPerScanline = 0;
-			_currentScanline = value;
-		}
+		/**
+		 * @brief Advance the PPU by dotCount dots
+		 *
+		 * Same result as calling tick() dotCount times, but dots where
+		 * nothing observable happens are skipped in one step.
+		 */
+		void run(uint32 dotCount);
+
+		void forceCurrentScanline(sint32 value);
 
 		uint32 cyclesCountPerScanline() const
 		{
-			return _cycleCountPerScanline;
+			return _hot.cycleCountPerScanline;
 		}
 
 		sint32 currentScanline() const
 		{
-			return _currentScanline;
+			return _hot.currentScanline;
+		}
+
+		/**
+		 * @brief Frames completed since power on, counted at the end of the pre-render scanline
+		 */
+		uint32 frameCount() const
+		{
+			return _cold.frameCount;
 		}
 
 		enum class NameTableMirroring
@@ -49,26 +71,165 @@ namespace sukiNES
 			ChrRomMirroring
 		};
 
-		void setNametableMirroring(NameTableMirroring value)
+		void setNametableMirroring(NameTableMirroring value);
+
+		NameTableMirroring nametableMirroring() const
+		{
+			return _cold.nametableMirroring;
+		}
+
+		/**
+		 * @brief Select the frame timing of a console region, before power on
+		 */
+		void setRegion(Region region);
+
+		Region region() const
+		{
+			return _cold.region;
+		}
+
+		/**
+		 * @brief Map 1 KB of CHR memory at $0000-$1FFF
+		 * @param page Page number (0-7), $0000 + page * 1 KB
+		 * @param memory Host memory of at least 1 KB
+		 */
+		void mapChrPage(uint32 page, byte* memory)
 		{
-			_nametableMirroring = value;
+			if (_pageTable[page] != memory)
+			{
+				_pageTable[page] = memory;
+				_markStateChanged();
+			}
 		}
 
-		void setGamePak(GamePak* gamePak)
+		/**
+		 * @brief Map a whole 8 KB CHR bank at $0000-$1FFF
+		 */
+		void mapChrBank(byte* memory)
 		{
-			_gamePak = gamePak;
+			for (uint32 page = 0; page < ChrPageCount; ++page)
+			{
+				mapChrPage(page, memory + page * PpuPageSize);
+			}
 		}
 
+		void setGamePak(GamePak* gamePak);
+
 		void setIO(PPUIO* io)
 		{
 			_io = io;
 		}
 
+		void setFrameBuffer(const FrameBuffer& frameBuffer)
+		{
+			_frameBuffer = frameBuffer;
+			_markStateChanged();
+		}
+
+		const FrameBuffer& frameBuffer() const
+		{
+			return _frameBuffer;
+		}
+
+		/**
+		 * @brief Render into the back frame of buffer and publish each changed frame when VBlank starts
+		 *
+		 * Replaces the frame buffer, FrameInfo gives the published frame. nullptr stops,
+		 * call setFrameBuffer() then.
+		 */
+		void setFrameTripleBuffer(FrameTripleBuffer* buffer);
+
+		FrameTripleBuffer* frameTripleBuffer() const
+		{
+			return _frameTripleBuffer;
+		}
+
+		/**
+		 * @brief Skip pixel composition and frame buffer writes
+		 *
+		 * VBlank, NMI, sprite 0 hit and sprite overflow behave the same.
+		 * Takes effect at the start of the next frame.
+		 */
+		void setTimingOnly(bool value)
+		{
+			_isTimingOnly = value;
+		}
+
+		bool isTimingOnly() const
+		{
+			return _isTimingOnly;
+		}
+
+		/**
+		 * @brief Hash the frame buffer with hashFrame() when VBlank starts
+		 *
+		 * Unchanged frames keep the hash of the previous frame, timing-only frames are not hashed.
+		 */
+		void setFrameHashing(bool value);
+
+		/**
+		 * @brief Hash of the last rendered frame, 0 when frame hashing is disabled
+		 */
+		uint64 frameHash() const
+		{
+			return _frameHash;
+		}
+
+		/**
+		 * @brief Add each rendered frame to stack when VBlank starts
+		 *
+		 * The frame buffer must be ColorIndex or PaletteIndex. nullptr stops.
+		 */
+		void setObservationStack(ObservationStack* stack)
+		{
+			_observationStack = stack;
+		}
+
+		/**
+		 * @brief Record the accesses that change the picture in log
+		 *
+		 * Another PPU given the same CHR memory and palette renders the
+		 * frames by replaying the log, usually on another thread while
+		 * this one runs timing-only. CHR pages mapped after the log is
+		 * set are not recorded. nullptr stops recording.
+		 */
+		void setWriteLog(PPUWriteLog* log)
+		{
+			_writeLog = log;
+		}
+
+		/**
+		 * @brief Have the PPU replaying the log run timing-only or not
+		 *
+		 * Logged at the current dot, the replaying PPU calls setTimingOnly()
+		 * when it gets there. Lets it skip frames without this PPU rendering.
+		 */
+		void logTimingOnly(bool value)
+		{
+			_logEntry(PPUWriteLog::EntryType::TimingOnly, _hot.dotCount, 0, static_cast<byte>(value));
+		}
+
+		/**
+		 * @brief Run up to the dot of entry and repeat its access
+		 */
+		void replay(const PPUWriteLog::Entry& entry);
+
+		const RgbPalette& rgbPalette() const
+		{
+			return _rgbPalette;
+		}
+
+		void setRgbPalette(const RgbPalette& rgbPalette)
+		{
+			_rgbPalette = rgbPalette;
+			_markStateChanged();
+		}
+
 		bool hasVBlankOccured()
 		{
-			if (_irqNotRead && (unsigned)_ppuControl.generateNmi && (unsigned)_ppuStatus.vblankStarted)
+			if (_hot.irqNotRead && (unsigned)_hot.ppuControl.generateNmi && (unsigned)_hot.ppuStatus.vblankStarted)
 			{
-				_irqNotRead = false;
+				_hot.irqNotRead = false;
 				return true;
 			}
 			else
@@ -77,8 +238,10 @@ namespace sukiNES
 			}
 		}
 
-		friend class PPUDebugInfoDialog;
-		friend class PPUVideoDialog;
+		/**
+		 * @brief Copy the registers, palette and memory shown by the debug views to state
+		 */
+		void captureDebugState(PPUDebugState& state) const;
 
 	private:
 		enum class MemoryAccessAction
@@ -89,11 +252,17 @@ namespace sukiNES
 			HighTileFetch = 0
 		};
 
-		bool _isRenderingEnabled() const;
+		bool _isRenderingEnabled() const
+		{
+			return (unsigned)_hot.ppuMask.showBackground || (unsigned)_hot.ppuMask.showSprites;
+		}
+
 		bool _isOutsideRendering() const;
 
-		void _memoryAccess();
 		void _spriteEvaluation();
+		void _startSpriteEvaluation();
+		void _catchUpSpriteEvaluation();
+		const SpritesInRange& _spritesInRange(uint32 scanline);
 
 		void _nametableFetch();
 		void _attributeFetch();
@@ -104,6 +273,9 @@ namespace sukiNES
 		void _prepareNextTile();
 
 		void _incrementCycleAndScanline();
+		void _advanceDots(uint32 dotCount);
+		uint32 _idleDotCount() const;
+		uint32 _dotsUntil(sint32 scanline, uint32 cycle) const;
 
 		void _incrementPpuAddressHorizontal();
 		void _incrementPpuAddressVertical();
@@ -111,9 +283,87 @@ namespace sukiNES
 		void _resetVerticalPpuAddress();
 		void _incrementPpuAddressOnReadWrite();
 
-		void _renderPixel();
-		void _renderBackground();
-		void _drawPixel(byte paletteValue);
+		void _prepareSpriteLayers();
+		void _prepareSprite0Layer();
+		void _fetchBackgroundPixel();
+		void _compositeUpTo(uint32 endX);
+		void _catchUpComposition();
+		void _finishScanline();
+		void _renderBackground(uint32 endX);
+
+		void _startFrame();
+		void _startVBlank();
+		void _endFrame();
+		void _clearSecondaryOAM();
+		void _startSpriteFetch();
+		void _latchSprite();
+		void _fetchSprite(MemoryAccessAction memoryAccess);
+		void _clearBackgroundQueues();
+
+		// Register state that affects the picture
+		struct PictureRegisters
+		{
+			byte control;
+			byte mask;
+			byte fineXScroll;
+			uint16 temporaryPpuAddress;
+			uint16 currentPpuAddress;
+
+			bool operator==(const PictureRegisters& other) const
+			{
+				return control == other.control
+					&& mask == other.mask
+					&& fineXScroll == other.fineXScroll
+					&& temporaryPpuAddress == other.temporaryPpuAddress
+					&& currentPpuAddress == other.currentPpuAddress;
+			}
+
+			bool operator!=(const PictureRegisters& other) const
+			{
+				return !(*this == other);
+			}
+		};
+
+		void _logEntry(PPUWriteLog::EntryType type, uint32 dot, uint16 address, byte value)
+		{
+			if (_writeLog)
+			{
+				PPUWriteLog::Entry entry = { dot, address, value, type };
+				_writeLog->push(entry);
+			}
+		}
+
+		PictureRegisters _pictureRegisters() const;
+		void _markStateChanged();
+		void _markRegistersChanged(const PictureRegisters& previous);
+		void _resumeComposition();
+
+		bool _isSkippingComposition() const
+		{
+			return _hot.isTimingOnlyFrame || _hot.isUnchangedFrame;
+		}
+
+		byte _emphasis() const
+		{
+			return _hot.ppuMask.raw >> 5;
+		}
+
+		template<typename Pixel>
+		void _convertScanline(const Pixel* colors, Pixel* output) const
+		{
+			for (uint32 x = _cold.outputStartX; x < ScanlineWidth; ++x)
+			{
+				output[x] = colors[RgbPalette::index(_cold.scanlineOutput[x], _cold.scanlineEmphasis[x])];
+			}
+		}
+
+		void _outputColorIndices(uint16* output) const
+		{
+			for (uint32 x = _cold.outputStartX; x < ScanlineWidth; ++x)
+			{
+				output[x] = static_cast<uint16>(RgbPalette::index(_cold.scanlineOutput[x], _cold.scanlineEmphasis[x]));
+			}
+		}
 
 		enum class ReadSource
 		{
@@ -124,78 +374,16 @@ namespace sukiNES
 		byte _internalRead(word ppuAddress, ReadSource readSource = ReadSource::FromPPU);
 		void _internalWrite(word ppuAddress, byte value);
 
-	private:
-		union
-		{
-			byte raw;
-			RegBit<0, 2> baseNametableAddress;
-			RegBit<2> addressIncrement;
-			RegBit<3> spritePatternTable;
-			RegBit<4> backgroundPatternTable;
-			RegBit<5> spriteSize;
-			RegBit<6> ppuMasterSlave;
-			RegBit<7> generateNmi;
-		} _ppuControl;
-
-		union
-		{
-			byte raw;
-			RegBit<0> greyscale;
-			RegBit<1> showBackgroundLeftmost;
-			RegBit<2> showSpritesLeftmost;
-			RegBit<3> showBackground;
-			RegBit<4> showSprites;
-			RegBit<5> intensifyRed;
-			RegBit<6> intensifyGreen;
-			RegBit<7> intensifyBlue;
-		} _ppuMask;
-
-		union
+		byte _readPage(uint32 ppuAddress) const
 		{
-			byte raw;
-			RegBit<0, 5> leastBits;
-			RegBit<5> spriteOverflow;
-			RegBit<6> sprite0Hit;
-			RegBit<7> vblankStarted;
-		} _ppuStatus;
-
-		// Aka Loopy_T
-		union
-		{
-			uint16 raw;
-			RegBit<0, 5, uint16> coarseXScroll;
-			RegBit<5, 5, uint16> coarseYScroll;
-			RegBit<10, 2, uint16> nametableSelect;
-			RegBit<12, 3, uint16> fineYScroll;
-
-			// Special fields used by PPU register PpuAddress
-			RegBit<8, 6, uint16> highByteAddress;
-			RegBit<0, 8, uint16> lowByteAddress;
-			RegBit<14, 1, uint16> clearBit14;
-		} _temporaryPpuAddress;
-
-		// Aka Loopy_V
-		union
-		{
-			uint16 raw;
-			RegBit<0, 5, uint16> coarseXScroll;
-			RegBit<5, 5, uint16> coarseYScroll;
-			RegBit<10, 2, uint16> nametableSelect;
-			RegBit<12, 3, uint16> fineYScroll;
-		} _currentPpuAddress;
-
-		// Aka Loopy_W
-		bool _firstWrite;
-		// Aka Loopy_X
-		byte _fineXScroll;
+			return _pageTable[ppuAddress >> 10][ppuAddress & (PpuPageSize - 1)];
+		}
 
+	private:
+		// The state types below have no constructors so that HotState and ColdState
+		// stay trivially copyable, the PPU constructor value-initializes them
 		struct PPUPattern
 		{
-			PPUPattern()
-			: lowByte(0)
-			, highByte(0)
-			{}
-
 			byte lowByte;
 			byte highByte;
 
@@ -224,27 +412,6 @@ namespace sukiNES
 
 		struct OAMEntry
 		{
-			OAMEntry()
-			: y(0)
-			, tileIndex(0)
-			, x(0)
-			{
-				attributes.raw = 0;
-			}
-
-			OAMEntry &operator=(const OAMEntry& other)
-			{
-				if (this != &other)
-				{
-					y = other.y;
-					tileIndex = other.tileIndex;
-					attributes = other.attributes;
-					x = other.x;
-				}
-
-				return *this;
-			}
-
 			bool isNull() const
 			{
 				return y == 0xFF
@@ -257,15 +424,10 @@ namespace sukiNES
 			byte tileIndex;
 			SpriteAttribute attributes;
 			byte x;
-		} _sprites[64], _secondaryOAM[8];
+		};
 
 		struct SpriteRenderingEntry
 		{
-			SpriteRenderingEntry()
-			{
-				clear();
-			}
-
 			sint32 x;
 			SpriteAttribute attribute;
 			PPUPattern pattern;
@@ -305,40 +467,52 @@ namespace sukiNES
 				auto range = screenX - x;
 				return range >= 0 && range < 8;
 			}
+		};
 
-		} _spritesToRender[8];
-
-		byte* _rawOAM;
-		byte* _rawSecondaryOAM;
-		byte _oamAddress;
-		byte _secondaryOAMIndex;
-
-		uint32 _cycleCountPerScanline;
-		sint32 _currentScanline;
-		bool _isEvenFrame;
-		bool _skipNmi;
-		bool _irqNotRead;
+		// Background tiles fetched ahead of rendering. The pre-render scanline queues
+		// up to 34 tiles before they are cleared at dot 321, past Capacity the oldest is dropped.
+		template<typename T>
+		struct TileQueue
+		{
+			static const uint32 Capacity = 64;
 
-		byte _readBuffer;
+			void clear()
+			{
+				head = 0;
+				count = 0;
+			}
 
-		byte _palette[32];
+			bool empty() const
+			{
+				return count == 0;
+			}
 
-		NameTableMirroring _nametableMirroring;
-		byte _nametable[SUKINES_KB(2)];
+			const T& front() const
+			{
+				return entries[head];
+			}
 
-		GamePak* _gamePak;
-		PPUIO* _io;
+			void push(const T& value)
+			{
+				if (count == Capacity)
+				{
+					pop();
+				}
 
-		byte _lastReadNametableByte;
-		PPUPattern _tempBackgroundPattern;
+				entries[(head + count) & (Capacity - 1)] = value;
+				++count;
+			}
 
-		std::queue<PPUPattern> _backgroundPatternQueue;
-		std::queue<byte> _backgroundAttributeQueue;
-		std::queue<byte> _attributeBitsQueue;
+			void pop()
+			{
+				head = (head + 1) & (Capacity - 1);
+				--count;
+			}
 
-		PPUPattern _currentBackgroundPattern;
-		byte _currentAttribute;
-		byte _currentAttributeBits;
+			T entries[Capacity];
+			uint32 head;
+			uint32 count;
+		};
 
 		struct SpriteEvaluation
 		{
@@ -353,19 +527,206 @@ namespace sukiNES
 			byte spritesFound;
 			byte oamIndex;
 
-			SpriteEvaluation()
-			{
-				clear();
-			}
+			// The scanline was evaluated at once by _findSpritesInRange at startDot
+			bool isCached;
+			uint32 startDot;
+			uint32 overflowDot;
+			// Secondary OAM before the evaluation, to run the state machine over again
+			byte secondaryOAM[32];
 
 			void clear()
 			{
 				currentState = CheckSpriteInRange;
 				spritesFound = 0;
 				oamIndex = 0;
+				isCached = false;
 			}
-		} _spriteEval;
+		};
 
-		byte _currentSpriteFetched;
+		// State used on most dots, kept together from the start of a cache line
+		struct HotState
+		{
+			const uint32* scanlineActions;
+			uint32 cycleCountPerScanline;
+			sint32 currentScanline;
+			uint32 dotCount;
+
+			union
+			{
+				byte raw;
+				RegBit<0, 2> baseNametableAddress;
+				RegBit<2> addressIncrement;
+				RegBit<3> spritePatternTable;
+				RegBit<4> backgroundPatternTable;
+				RegBit<5> spriteSize;
+				RegBit<6> ppuMasterSlave;
+				RegBit<7> generateNmi;
+			} ppuControl;
+
+			union
+			{
+				byte raw;
+				RegBit<0> greyscale;
+				RegBit<1> showBackgroundLeftmost;
+				RegBit<2> showSpritesLeftmost;
+				RegBit<3> showBackground;
+				RegBit<4> showSprites;
+				RegBit<5> intensifyRed;
+				RegBit<6> intensifyGreen;
+				RegBit<7> intensifyBlue;
+			} ppuMask;
+
+			union
+			{
+				byte raw;
+				RegBit<0, 5> leastBits;
+				RegBit<5> spriteOverflow;
+				RegBit<6> sprite0Hit;
+				RegBit<7> vblankStarted;
+			} ppuStatus;
+
+			// Aka Loopy_T
+			union
+			{
+				uint16 raw;
+				RegBit<0, 5, uint16> coarseXScroll;
+				RegBit<5, 5, uint16> coarseYScroll;
+				RegBit<10, 2, uint16> nametableSelect;
+				RegBit<12, 3, uint16> fineYScroll;
+
+				// Special fields used by PPU register PpuAddress
+				RegBit<8, 6, uint16> highByteAddress;
+				RegBit<0, 8, uint16> lowByteAddress;
+				RegBit<14, 1, uint16> clearBit14;
+			} temporaryPpuAddress;
+
+			// Aka Loopy_V
+			union
+			{
+				uint16 raw;
+				RegBit<0, 5, uint16> coarseXScroll;
+				RegBit<5, 5, uint16> coarseYScroll;
+				RegBit<10, 2, uint16> nametableSelect;
+				RegBit<12, 3, uint16> fineYScroll;
+			} currentPpuAddress;
+
+			// Aka Loopy_W
+			bool firstWrite;
+			// Aka Loopy_X
+			byte fineXScroll;
+
+			byte oamAddress;
+			byte secondaryOAMIndex;
+			byte currentSpriteFetched;
+			byte readBuffer;
+			bool isEvenFrame;
+			bool skipNmi;
+			bool irqNotRead;
+
+			bool isTimingOnlyFrame;
+			bool hasSprite0OnScanline;
+			// The frame is the same as the previous one, composition is skipped
+			bool isUnchangedFrame;
+
+			byte lastReadNametableByte;
+			byte currentAttribute;
+			byte currentAttributeBits;
+			PPUPattern tempBackgroundPattern;
+			PPUPattern currentBackgroundPattern;
+			uint32 compositedX;
+
+			SpriteEvaluation spriteEval;
+			OAMEntry secondaryOAM[8];
+			SpriteRenderingEntry spritesToRender[8];
+
+			TileQueue<PPUPattern> backgroundPatternQueue;
+			TileQueue<byte> backgroundAttributeQueue;
+			TileQueue<byte> attributeBitsQueue;
+		};
+
+		// State used once per scanline or frame and on register accesses
+		struct ColdState
+		{
+			OAMEntry sprites[64];
+			// Y of each OAM sprite, kept in sync with OAMDATA writes for the range test
+			SUKINES_ALIGN(32) byte spriteY[OamSpriteCount];
+
+			// Sprites covering each visible scanline, found by _findSpritesInRange on the first
+			// evaluation of the scanline and reused while OAM and the sprite size are unchanged
+			SpritesInRange spriteLines[FrameHeight];
+			// spriteLineGeneration when each entry of spriteLines was found
+			uint32 spriteLineStamps[FrameHeight];
+			// Bumped by OAM and sprite size changes, 0 is never current
+			uint32 spriteLineGeneration;
+
+			Region region;
+			const RegionTiming* timing;
+
+			byte palette[32];
+
+			NameTableMirroring nametableMirroring;
+
+			// 2 KB of CIRAM followed by the extra 2 KB used by four-screen cartridges
+			byte nametable[SUKINES_KB(4)];
+
+			// Scanline layers, composited lazily up to the current dot
+			byte backgroundLayer[ScanlineWidth];
+			byte spriteLayer[ScanlineWidth];
+			byte frontSpriteLayer[ScanlineWidth];
+			byte sprite0Layer[ScanlineWidth];
+			byte scanlineOutput[ScanlineWidth];
+			byte scanlineEmphasis[ScanlineWidth];
+			// First pixel of the scanline written to the frame buffer
+			uint32 outputStartX;
+
+			// Colour subcarrier phase of the first dot of scanline 0, in thirds of a cycle
+			uint32 burstPhase;
+			uint32 frameCount;
+		};
+
+		// OAM and secondary OAM as seen through OAMDATA and by the sprite evaluation
+		byte& _oamByte(uint32 index)
+		{
+			return reinterpret_cast<byte*>(_cold.sprites)[index];
+		}
+
+		byte& _secondaryOAMByte(uint32 index)
+		{
+			return reinterpret_cast<byte*>(_hot.secondaryOAM)[index];
+		}
+
+		// The emulated state. Both blocks are trivially copyable and hold no pointer
+		// into the PPU, a snapshot copies them and remaps the page table.
+		SUKINES_ALIGN(64) HotState _hot;
+		SUKINES_ALIGN(64) ColdState _cold;
+
+		// Host memory for each 1 KB of $0000-$3FFF: CHR, then nametables mirrored twice.
+		// Rebuilt from the mapper and the mirroring, never part of a snapshot.
+		byte* _pageTable[PpuPageCount];
+
+		GamePak* _gamePak;
+		PPUIO* _io;
+		PPUWriteLog* _writeLog;
+		ObservationStack* _observationStack;
+		FrameTripleBuffer* _frameTripleBuffer;
+		FrameBuffer _frameBuffer;
+		// Last frame given to _frameTripleBuffer, the PPU only reads it
+		FrameBuffer _publishedFrame;
+		RgbPalette _rgbPalette;
+
+		FindSpritesInRangeFunction _findSpritesInRange;
+		CompositeScanlineFunction _compositeScanline;
+
+		bool _isTimingOnly;
+		bool _isFrameHashing;
+		uint64 _frameHash;
+
+		// Bumped whenever something that affects the picture changes
+		uint32 _stateGeneration;
+		// _stateGeneration and registers when the last frame started
+		uint32 _frameGeneration;
+		PictureRegisters _frameRegisters;
+		// The frame buffer holds the whole previous frame
+		bool _isFrameComplete;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+// Local includes
+#include "ppu.h"
+#include "rgbpalette.h"
+
+namespace sukiNES
+{
+	/**
+	 * @brief Copy of the PPU state shown by the debug views
+	 *
+	 * Filled by PPU::captureDebugState(), it can be read on another thread
+	 * while the PPU keeps running.
+	 */
+	struct PPUDebugState
+	{
+		union
+		{
+			byte raw;
+			RegBit<0, 2> baseNametableAddress;
+			RegBit<2> addressIncrement;
+			RegBit<3> spritePatternTable;
+			RegBit<4> backgroundPatternTable;
+			RegBit<5> spriteSize;
+			RegBit<6> ppuMasterSlave;
+			RegBit<7> generateNmi;
+		} ppuControl;
+
+		union
+		{
+			byte raw;
+			RegBit<0> greyscale;
+			RegBit<1> showBackgroundLeftmost;
+			RegBit<2> showSpritesLeftmost;
+			RegBit<3> showBackground;
+			RegBit<4> showSprites;
+			RegBit<5> intensifyRed;
+			RegBit<6> intensifyGreen;
+			RegBit<7> intensifyBlue;
+		} ppuMask;
+
+		union
+		{
+			byte raw;
+			RegBit<5> spriteOverflow;
+			RegBit<6> sprite0Hit;
+			RegBit<7> vblankStarted;
+		} ppuStatus;
+
+		// Loopy_T and Loopy_V
+		union PpuAddress
+		{
+			uint16 raw;
+			RegBit<0, 5, uint16> coarseXScroll;
+			RegBit<5, 5, uint16> coarseYScroll;
+			RegBit<10, 2, uint16> nametableSelect;
+			RegBit<12, 3, uint16> fineYScroll;
+		};
+		PpuAddress temporaryPpuAddress;
+		PpuAddress currentPpuAddress;
+
+		bool firstWrite;
+		byte fineXScroll;
+
+		uint32 cycle;
+		sint32 scanline;
+		bool isEvenFrame;
+
+		PPU::NameTableMirroring nametableMirroring;
+
+		byte palette[32];
+		// RGB32 of each palette value, without emphasis
+		uint32 colors[RgbPalette::ColorCount];
+
+		// $0000-$2FFF as the PPU reads it: both pattern tables, then the four nametables after mirroring
+		byte memory[SUKINES_KB(12)];
+	};
+}
\ No newline at end of file
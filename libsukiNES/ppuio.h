@@ -1,13 +1,42 @@
 #pragma once
 
+// Local includes
+#include "framebuffer.h"
+
 namespace sukiNES
 {
+	struct FrameInfo
+	{
+		FrameBuffer frameBuffer;
+
+		/// false when the frame was emulated in timing-only mode, the frame buffer was not touched
+		bool isRendered;
+
+		/// true when the picture is the same as the previous frame, the frame buffer was not touched
+		bool isUnchanged;
+
+		/// Hash of the frame buffer when frame hashing is enabled on the PPU, 0 otherwise
+		uint64 hash;
+
+		/// Colour subcarrier phase of the first scanline, in thirds of a cycle, for NtscFilter
+		uint32 burstPhase;
+	};
+
 	class PPUIO
 	{
 	public:
 		virtual ~PPUIO() {}
 
-		virtual void putPixel(sint32 x, sint32 y, byte paletteIndex) = 0;
-		virtual void onVBlank() = 0;
+		/**
+		 * @brief A visible scanline has been written to the frame buffer
+		 * @param y Scanline number (0-239)
+		 * @param scanline Start of the scanline in the frame buffer
+		 */
+		virtual void onScanline(sint32 /*y*/, const byte* /*scanline*/) {}
+
+		/**
+		 * @brief The frame is complete, called when VBlank starts
+		 */
+		virtual void onFrame(const FrameInfo& frameInfo) = 0;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "ppuwritelog.h"
+
+// STL includes
+#include <thread>
+
+namespace sukiNES
+{
+	PPUWriteLog::PPUWriteLog()
+	: _isWakeRequested(false)
+	{
+		_isConsumerWaiting.store(false);
+		clear();
+	}
+
+	void PPUWriteLog::push(const Entry& entry)
+	{
+		// The render thread is a whole log behind, let it catch up
+		while (!_entries.push(entry))
+		{
+			std::this_thread::yield();
+		}
+
+		if (entry.type == EntryType::Frame)
+		{
+			_frameEndIndex.store(_entries.pushedCount(), std::memory_order_relaxed);
+		}
+
+		// Orders the push before reading the flag, either the consumer sees the entries
+		// before it sleeps or the producer sees it sleeping
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		// Waking the consumer once per frame instead of once per entry
+		if (_isConsumerWaiting.load(std::memory_order_relaxed) && _hasFrameToPop())
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_frameWritten.notify_one();
+		}
+	}
+
+	bool PPUWriteLog::pop(Entry& entry)
+	{
+		return _entries.pop(entry);
+	}
+
+	void PPUWriteLog::waitForFrame()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+
+		_isConsumerWaiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		while (!_isWakeRequested && !_hasFrameToPop())
+		{
+			_frameWritten.wait(lock);
+		}
+		_isConsumerWaiting.store(false, std::memory_order_relaxed);
+
+		_isWakeRequested = false;
+	}
+
+	void PPUWriteLog::wakeConsumer()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_isWakeRequested = true;
+		_frameWritten.notify_one();
+	}
+
+	void PPUWriteLog::clear()
+	{
+		_entries.clear();
+		_frameEndIndex.store(0);
+	}
+
+	bool PPUWriteLog::_hasFrameToPop() const
+	{
+		uint32 readIndex = _entries.poppedCount();
+		uint32 writeIndex = _entries.pushedCount();
+		uint32 frameEndIndex = _frameEndIndex.load(std::memory_order_relaxed);
+
+		// The indices wrap around, the last frame end is at most Capacity entries ahead
+		bool isFrameEndAhead = frameEndIndex != readIndex && frameEndIndex - readIndex <= Capacity;
+		return isFrameEndAhead || writeIndex - readIndex >= Capacity / 2;
+	}
+}
\ No newline at end of file
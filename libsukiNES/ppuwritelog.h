@@ -0,0 +1,96 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+// Local includes
+#include "spscring.h"
+
+namespace sukiNES
+{
+	/**
+	 * @brief Log of the PPU accesses that change the picture
+	 *
+	 * A PPU running timing-only on the emulation thread records every register
+	 * access with its dot count, another PPU replays them on a render thread.
+	 * An SpscRing the producer waits on while it is full, and the consumer
+	 * can sleep on until a frame is logged. Lock-free unless the consumer sleeps.
+	 */
+	class PPUWriteLog
+	{
+	public:
+		static const uint32 Capacity = 65536;
+
+		enum class EntryType : byte
+		{
+			Write,
+			Read,
+			Mirroring,
+			Region,
+			PowerOn,
+			Frame,
+			TimingOnly
+		};
+
+		struct Entry
+		{
+			/// Dots run by the PPU since power on before the access
+			uint32 dot;
+			uint16 address;
+			byte value;
+			EntryType type;
+		};
+
+		PPUWriteLog();
+
+		/**
+		 * @brief Append an entry, waits while the log is full
+		 *
+		 * Wakes the consumer sleeping in waitForFrame() at the end of a frame.
+		 * Producer thread only.
+		 */
+		void push(const Entry& entry);
+
+		/**
+		 * @brief Take the oldest entry
+		 * @return false when the log is empty
+		 *
+		 * Consumer thread only.
+		 */
+		bool pop(Entry& entry);
+
+		/**
+		 * @brief Block until a whole frame or half the log can be popped, or wakeConsumer() is called
+		 *
+		 * Consumer thread only.
+		 */
+		void waitForFrame();
+
+		/**
+		 * @brief Return from the current or the next waitForFrame() call
+		 */
+		void wakeConsumer();
+
+		/**
+		 * @brief Drop every entry, neither thread may use the log meanwhile
+		 */
+		void clear();
+
+	private:
+		bool _hasFrameToPop() const;
+
+	private:
+		SpscRing<Entry, Capacity> _entries;
+
+		// _entries.pushedCount() after the last Frame entry
+		SUKINES_ALIGN(64) std::atomic<uint32> _frameEndIndex;
+
+		// The producer only locks _mutex when the consumer sleeps
+		std::atomic<bool> _isConsumerWaiting;
+		bool _isWakeRequested;
+		std::mutex _mutex;
+		std::condition_variable _frameWritten;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "regiontiming.h"
+
+namespace sukiNES
+{
+	static const RegionTiming RegionTimings[RegionCount] =
+	{
+		{ 260, 241, true, 15, 60.0988139 },  // Ntsc, 3:1
+		{ 310, 241, false, 16, 50.0069789 }, // Pal, 3.2:1
+		{ 310, 291, false, 15, 50.0069789 }  // Dendy, 3:1 with VBlank 51 scanlines after the picture
+	};
+
+	const RegionTiming& regionTiming(Region region)
+	{
+		return RegionTimings[static_cast<uint32>(region)];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+namespace sukiNES
+{
+	enum class Region
+	{
+		Ntsc,
+		Pal,
+		Dendy
+	};
+
+	static const uint32 RegionCount = 3;
+
+	// The CPU:PPU clock ratio is counted in fifths of a PPU dot, PAL runs 16 dots every 5 CPU cycles
+	static const uint32 PpuDotFraction = 5;
+
+	/**
+	 * @brief Frame and clock timing that differs between the NES consoles
+	 */
+	struct RegionTiming
+	{
+		// Scanline before the pre-render scanline, 260 on NTSC, 310 on PAL and Dendy
+		sint32 lastScanline;
+		// Scanline where VBlank starts, at dot 1
+		sint32 vblankScanline;
+		// The pre-render scanline is one dot shorter on odd frames when rendering
+		bool skipsOddFrameDot;
+		// PPU dots per CPU cycle, in PpuDotFraction units
+		uint32 ppuDotFractionsPerCpuCycle;
+		// Frames per second of the real console, from its master clock
+		double frameRate;
+	};
+
+	const RegionTiming& regionTiming(Region region);
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "rgbpalette.h"
+
+// STL includes
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+namespace sukiNES
+{
+	static const byte DefaultPalette[RgbPalette::ColorCount * 3] =
+	{
+		0x52, 0x52, 0x52, 0x01, 0x1A, 0x51, 0x0F, 0x0F, 0x65, 0x23, 0x06, 0x63, 0x36, 0x03, 0x4B, 0x40,
+		0x04, 0x26, 0x3F, 0x09, 0x04, 0x32, 0x13, 0x00, 0x1F, 0x20, 0x00, 0x0B, 0x2A, 0x00, 0x00, 0x2F,
+		0x00, 0x00, 0x2E, 0x0A, 0x00, 0x26, 0x2D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0xA0, 0xA0, 0xA0, 0x1E, 0x4A, 0x9D, 0x38, 0x37, 0xBC, 0x58, 0x28, 0xB8, 0x75, 0x21, 0x94, 0x84,
+		0x23, 0x5C, 0x82, 0x2E, 0x24, 0x6F, 0x3F, 0x00, 0x51, 0x52, 0x00, 0x31, 0x63, 0x00, 0x1A, 0x6B,
+		0x05, 0x0E, 0x69, 0x2E, 0x10, 0x5C, 0x68, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0xFE, 0xFF, 0xFF, 0x69, 0x9E, 0xFC, 0x89, 0x87, 0xFF, 0xAE, 0x76, 0xFF, 0xCE, 0x6D, 0xF1, 0xE0,
+		0x70, 0xB2, 0xDE, 0x7C, 0x70, 0xC8, 0x91, 0x3E, 0xA6, 0xA7, 0x25, 0x81, 0xBA, 0x28, 0x63, 0xC4,
+		0x46, 0x54, 0xC1, 0x7D, 0x56, 0xB3, 0xC0, 0x3C, 0x3C, 0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0xFE, 0xFF, 0xFF, 0xBE, 0xD6, 0xFD, 0xCC, 0xCC, 0xFF, 0xDD, 0xC4, 0xFF, 0xEA, 0xC0, 0xF9, 0xF2,
+		0xC1, 0xDF, 0xF1, 0xC7, 0xC2, 0xE8, 0xD0, 0xAA, 0xD9, 0xDA, 0x9D, 0xC9, 0xE2, 0x9E, 0xBC, 0xE6,
+		0xAE, 0xB4, 0xE5, 0xC7, 0xB5, 0xDF, 0xE4, 0xA9, 0xA9, 0xA9, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+
+	// Emphasized colours dim the two other channels
+	static const float EmphasisAttenuation = 0.746f;
+
+	RgbPalette::RgbPalette()
+	{
+		std::fill(std::begin(_rgb565), std::end(_rgb565), 0);
+		std::fill(std::begin(_grayscale), std::end(_grayscale), 0);
+
+		setDefaultColors();
+	}
+
+	bool RgbPalette::load(const char* filename)
+	{
+		FILE* file = fopen(filename, "rb");
+		if (!file)
+		{
+			return false;
+		}
+
+		std::vector<byte> rgb(EntryCount * 3);
+		size_t readSize = fread(rgb.data(), sizeof(byte), rgb.size(), file);
+		fclose(file);
+
+		if (readSize == EntryCount * 3)
+		{
+			setColors(rgb.data(), EntryCount);
+		}
+		else if (readSize == ColorCount * 3)
+		{
+			setColors(rgb.data(), ColorCount);
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	void RgbPalette::setColors(const byte* rgb, uint32 colorCount)
+	{
+		if (colorCount == EntryCount)
+		{
+			for (uint32 index = 0; index < EntryCount; ++index)
+			{
+				_setColor(index, rgb[index * 3], rgb[index * 3 + 1], rgb[index * 3 + 2]);
+			}
+
+			return;
+		}
+
+		for (uint32 emphasis = 0; emphasis < EmphasisCount; ++emphasis)
+		{
+			float redScale = 1.0f;
+			float greenScale = 1.0f;
+			float blueScale = 1.0f;
+
+			if (emphasis & SUKINES_BIT(0))
+			{
+				greenScale *= EmphasisAttenuation;
+				blueScale *= EmphasisAttenuation;
+			}
+			if (emphasis & SUKINES_BIT(1))
+			{
+				redScale *= EmphasisAttenuation;
+				blueScale *= EmphasisAttenuation;
+			}
+			if (emphasis & SUKINES_BIT(2))
+			{
+				redScale *= EmphasisAttenuation;
+				greenScale *= EmphasisAttenuation;
+			}
+
+			for (uint32 color = 0; color < ColorCount; ++color)
+			{
+				byte red = static_cast<byte>(rgb[color * 3] * redScale);
+				byte green = static_cast<byte>(rgb[color * 3 + 1] * greenScale);
+				byte blue = static_cast<byte>(rgb[color * 3 + 2] * blueScale);
+
+				_setColor(index(static_cast<byte>(color), static_cast<byte>(emphasis)), red, green, blue);
+			}
+		}
+	}
+
+	void RgbPalette::setDefaultColors()
+	{
+		setColors(DefaultPalette, ColorCount);
+	}
+
+	void RgbPalette::_setColor(uint32 index, byte red, byte green, byte blue)
+	{
+		_rgb32[index] = 0xFF000000 | (red << 16) | (green << 8) | blue;
+		_rgb565[index] = static_cast<uint16>(((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3));
+		_grayscale[index] = luma(_rgb32[index]);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+namespace sukiNES
+{
+	/**
+	 * @brief NES colours converted to host pixel formats
+	 *
+	 * Entries are indexed by (emphasis << 6) | colour, where emphasis is
+	 * the PPUMASK bits 5-7 (red, green, blue) and colour the 6-bit palette value.
+	 * Greyscale is already applied on the palette value by the PPU.
+	 */
+	class RgbPalette
+	{
+	public:
+		static const uint32 ColorCount = 64;
+		static const uint32 EmphasisCount = 8;
+		static const uint32 EntryCount = ColorCount * EmphasisCount;
+
+		RgbPalette();
+
+		/**
+		 * @brief Load a .pal file
+		 *
+		 * Accepts 64 RGB triplets (emphasis is then derived from them)
+		 * or 512 RGB triplets with every emphasis combination.
+		 */
+		bool load(const char* filename);
+
+		/**
+		 * @brief Set colours from RGB triplets
+		 * @param rgb colorCount * 3 bytes
+		 * @param colorCount ColorCount or EntryCount
+		 */
+		void setColors(const byte* rgb, uint32 colorCount);
+
+		void setDefaultColors();
+
+		static uint32 index(byte paletteValue, byte emphasis)
+		{
+			return (emphasis << 6) | (paletteValue & (ColorCount - 1));
+		}
+
+		const uint32* rgb32() const
+		{
+			return _rgb32;
+		}
+
+		const uint16* rgb565() const
+		{
+			return _rgb565;
+		}
+
+		const byte* grayscale() const
+		{
+			return _grayscale;
+		}
+
+		/**
+		 * @brief Luma of a 0xFFRRGGBB colour, used for the grayscale entries
+		 */
+		static byte luma(uint32 rgb32)
+		{
+			return static_cast<byte>((((rgb32 >> 16) & 0xFF) * 77 + ((rgb32 >> 8) & 0xFF) * 150 + (rgb32 & 0xFF) * 29 + 128) >> 8);
+		}
+
+	private:
+		void _setColor(uint32 index, byte red, byte green, byte blue);
+
+	private:
+		uint32 _rgb32[EntryCount];
+		// Padded so a 32-bit gather of the last entry stays inside the table
+		uint16 _rgb565[EntryCount + 1];
+		byte _grayscale[EntryCount + 3];
+	};
+}
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "scanlinecompositor.h"
+
+// STL includes
+#include <algorithm>
+
+#ifdef SUKINES_ARCH_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+// Local includes
+#include "cpufeatures.h"
+
+namespace sukiNES
+{
+	enum PpuMaskBits
+	{
+		MaskGreyscale = SUKINES_BIT(0),
+		MaskShowBackgroundLeftmost = SUKINES_BIT(1),
+		MaskShowSpritesLeftmost = SUKINES_BIT(2),
+		MaskShowBackground = SUKINES_BIT(3),
+		MaskShowSprites = SUKINES_BIT(4)
+	};
+
+	static const byte PixelMask = 0x3;
+	static const byte GreyscaleMask = 0x30;
+	static const uint32 LeftmostColumns = 8;
+	static const uint32 LastSprite0HitColumn = 254;
+
+	sint32 compositeScanlineScalar(const ScanlineLayers& layers, const byte* palette, byte ppuMask, uint32 startX, uint32 endX, byte* output)
+	{
+		const bool showBackground = (ppuMask & MaskShowBackground) != 0;
+		const bool showSprites = (ppuMask & MaskShowSprites) != 0;
+		const bool showBackgroundLeftmost = (ppuMask & MaskShowBackgroundLeftmost) != 0;
+		const bool showSpritesLeftmost = (ppuMask & MaskShowSpritesLeftmost) != 0;
+		const byte colorMask = (ppuMask & MaskGreyscale) ? GreyscaleMask : 0xFF;
+
+		sint32 sprite0HitX = -1;
+
+		for (uint32 x = startX; x < endX; ++x)
+		{
+			byte background = showBackground ? layers.background[x] : 0;
+			bool isBackgroundOpaque = (background & PixelMask) != 0;
+
+			// The left column mask only hides the pixel, priority still uses the real background
+			byte paletteIndex = background;
+			if (!showBackgroundLeftmost && x < LeftmostColumns)
+			{
+				paletteIndex = 0;
+			}
+
+			if (showSprites && (showSpritesLeftmost || x >= LeftmostColumns))
+			{
+				if (sprite0HitX < 0 && layers.sprite0[x] && isBackgroundOpaque && x <= LastSprite0HitColumn)
+				{
+					sprite0HitX = x;
+				}
+
+				byte sprite = isBackgroundOpaque ? layers.frontSprite[x] : layers.sprite[x];
+				if (sprite)
+				{
+					paletteIndex = sprite;
+				}
+			}
+
+			if (!(paletteIndex & PixelMask))
+			{
+				paletteIndex = 0;
+			}
+
+			output[x] = palette[paletteIndex] & colorMask;
+		}
+
+		return sprite0HitX;
+	}
+
+	sint32 detectSprite0Hit(const ScanlineLayers& layers, byte ppuMask, uint32 startX, uint32 endX)
+	{
+		if (!(ppuMask & MaskShowBackground) || !(ppuMask & MaskShowSprites))
+		{
+			return -1;
+		}
+
+		if (!(ppuMask & MaskShowSpritesLeftmost))
+		{
+			startX = std::max(startX, LeftmostColumns);
+		}
+
+		endX = std::min(endX, LastSprite0HitColumn + 1);
+
+		for (uint32 x = startX; x < endX; ++x)
+		{
+			if (layers.sprite0[x] && (layers.background[x] & PixelMask))
+			{
+				return x;
+			}
+		}
+
+		return -1;
+	}
+
+#ifdef SUKINES_ARCH_X86
+	// 0xFF for the columns affected by the left column masks
+	SUKINES_ALIGN(32) static const byte LeftmostColumnMask[ScanlineWidth] = {
+		0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+	};
+
+	// 0xFF for the columns where sprite 0 hit can happen
+	struct Sprite0HitColumnTable
+	{
+		SUKINES_ALIGN(32) byte columns[ScanlineWidth];
+
+		Sprite0HitColumnTable()
+		{
+			for (uint32 x = 0; x < ScanlineWidth; ++x)
+			{
+				columns[x] = (x <= LastSprite0HitColumn) ? 0xFF : 0;
+			}
+		}
+	};
+
+	static const Sprite0HitColumnTable Sprite0HitColumns;
+
+	static inline sint32 mergeSprite0Hit(sint32 currentHitX, sint32 newHitX)
+	{
+		return (currentHitX >= 0) ? currentHitX : newHitX;
+	}
+
+	SUKINES_TARGET_SSE2 sint32 compositeScanlineSSE2(const ScanlineLayers& layers, const byte* palette, byte ppuMask, uint32 startX, uint32 endX, byte* output)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i allOnes = _mm_cmpeq_epi8(zero, zero);
+		const __m128i pixelMask = _mm_set1_epi8(PixelMask);
+
+		const __m128i backgroundEnabled = (ppuMask & MaskShowBackground) ? allOnes : zero;
+		const __m128i spritesEnabled = (ppuMask & MaskShowSprites) ? allOnes : zero;
+		const __m128i backgroundLeftmostHidden = (ppuMask & MaskShowBackgroundLeftmost) ? zero : allOnes;
+		const __m128i spritesLeftmostHidden = (ppuMask & MaskShowSpritesLeftmost) ? zero : allOnes;
+		const byte colorMask = (ppuMask & MaskGreyscale) ? GreyscaleMask : 0xFF;
+
+		sint32 sprite0HitX = -1;
+		SUKINES_ALIGN(16) byte paletteIndices[16];
+
+		uint32 x = startX;
+		for (; x + 16 <= endX; x += 16)
+		{
+			__m128i leftmost = _mm_loadu_si128(reinterpret_cast<const __m128i*>(LeftmostColumnMask + x));
+			__m128i background = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(layers.background + x)), backgroundEnabled);
+			__m128i backgroundTransparent = _mm_cmpeq_epi8(_mm_and_si128(background, pixelMask), zero);
+
+			__m128i spriteVisible = _mm_andnot_si128(_mm_and_si128(leftmost, spritesLeftmostHidden), spritesEnabled);
+
+			__m128i sprite0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(layers.sprite0 + x));
+			__m128i hitColumns = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Sprite0HitColumns.columns + x));
+			__m128i sprite0Hit = _mm_andnot_si128(backgroundTransparent, _mm_and_si128(_mm_and_si128(sprite0, hitColumns), spriteVisible));
+			int sprite0HitBits = _mm_movemask_epi8(sprite0Hit);
+			if (sprite0HitBits && sprite0HitX < 0)
+			{
+				sprite0HitX = x + lowestSetBit(sprite0HitBits);
+			}
+
+			__m128i anySprite = _mm_loadu_si128(reinterpret_cast<const __m128i*>(layers.sprite + x));
+			__m128i frontSprite = _mm_loadu_si128(reinterpret_cast<const __m128i*>(layers.frontSprite + x));
+			__m128i sprite = _mm_or_si128(_mm_and_si128(backgroundTransparent, anySprite), _mm_andnot_si128(backgroundTransparent, frontSprite));
+			sprite = _mm_and_si128(sprite, spriteVisible);
+
+			__m128i backgroundIndex = _mm_andnot_si128(_mm_and_si128(leftmost, backgroundLeftmostHidden), background);
+			__m128i spriteTransparent = _mm_cmpeq_epi8(sprite, zero);
+			__m128i paletteIndex = _mm_or_si128(_mm_andnot_si128(spriteTransparent, sprite), _mm_and_si128(spriteTransparent, backgroundIndex));
+			paletteIndex = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(paletteIndex, pixelMask), zero), paletteIndex);
+
+			// SSE2 has no byte shuffle, the 32 entries palette lookup stays scalar
+			_mm_store_si128(reinterpret_cast<__m128i*>(paletteIndices), paletteIndex);
+			for (uint32 i = 0; i < 16; ++i)
+			{
+				output[x + i] = palette[paletteIndices[i]] & colorMask;
+			}
+		}
+
+		if (x < endX)
+		{
+			sprite0HitX = mergeSprite0Hit(sprite0HitX, compositeScanlineScalar(layers, palette, ppuMask, x, endX, output));
+		}
+
+		return sprite0HitX;
+	}
+
+	SUKINES_TARGET_AVX2 sint32 compositeScanlineAVX2(const ScanlineLayers& layers, const byte* palette, byte ppuMask, uint32 startX, uint32 endX, byte* output)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i allOnes = _mm256_cmpeq_epi8(zero, zero);
+		const __m256i pixelMask = _mm256_set1_epi8(PixelMask);
+		const __m256i lowNibbleMask = _mm256_set1_epi8(0xF);
+		const __m256i spritePaletteBit = _mm256_set1_epi8(0x10);
+
+		const __m256i backgroundEnabled = (ppuMask & MaskShowBackground) ? allOnes : zero;
+		const __m256i spritesEnabled = (ppuMask & MaskShowSprites) ? allOnes : zero;
+		const __m256i backgroundLeftmostHidden = (ppuMask & MaskShowBackgroundLeftmost) ? zero : allOnes;
+		const __m256i spritesLeftmostHidden = (ppuMask & MaskShowSpritesLeftmost) ? zero : allOnes;
+		const __m256i colorMask = _mm256_set1_epi8((ppuMask & MaskGreyscale) ? GreyscaleMask : static_cast<char>(0xFF));
+
+		// vpshufb looks up 16 entries per 128 bit lane, split the palette in background and sprite halves
+		__m128i backgroundPalette128 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(palette));
+		__m128i spritePalette128 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(palette + 16));
+		const __m256i backgroundPalette = _mm256_inserti128_si256(_mm256_castsi128_si256(backgroundPalette128), backgroundPalette128, 1);
+		const __m256i spritePalette = _mm256_inserti128_si256(_mm256_castsi128_si256(spritePalette128), spritePalette128, 1);
+
+		sint32 sprite0HitX = -1;
+
+		uint32 x = startX;
+		for (; x + 32 <= endX; x += 32)
+		{
+			__m256i leftmost = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(LeftmostColumnMask + x));
+			__m256i background = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(layers.background + x)), backgroundEnabled);
+			__m256i backgroundTransparent = _mm256_cmpeq_epi8(_mm256_and_si256(background, pixelMask), zero);
+
+			__m256i spriteVisible = _mm256_andnot_si256(_mm256_and_si256(leftmost, spritesLeftmostHidden), spritesEnabled);
+
+			__m256i sprite0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(layers.sprite0 + x));
+			__m256i hitColumns = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Sprite0HitColumns.columns + x));
+			__m256i sprite0Hit = _mm256_andnot_si256(backgroundTransparent, _mm256_and_si256(_mm256_and_si256(sprite0, hitColumns), spriteVisible));
+			uint32 sprite0HitBits = static_cast<uint32>(_mm256_movemask_epi8(sprite0Hit));
+			if (sprite0HitBits && sprite0HitX < 0)
+			{
+				sprite0HitX = x + lowestSetBit(sprite0HitBits);
+			}
+
+			__m256i anySprite = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(layers.sprite + x));
+			__m256i frontSprite = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(layers.frontSprite + x));
+			__m256i sprite = _mm256_blendv_epi8(frontSprite, anySprite, backgroundTransparent);
+			sprite = _mm256_and_si256(sprite, spriteVisible);
+
+			__m256i backgroundIndex = _mm256_andnot_si256(_mm256_and_si256(leftmost, backgroundLeftmostHidden), background);
+			__m256i paletteIndex = _mm256_blendv_epi8(sprite, backgroundIndex, _mm256_cmpeq_epi8(sprite, zero));
+			paletteIndex = _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_and_si256(paletteIndex, pixelMask), zero), paletteIndex);
+
+			__m256i lookupIndex = _mm256_and_si256(paletteIndex, lowNibbleMask);
+			__m256i isSpritePalette = _mm256_cmpeq_epi8(_mm256_and_si256(paletteIndex, spritePaletteBit), spritePaletteBit);
+			__m256i color = _mm256_blendv_epi8(_mm256_shuffle_epi8(backgroundPalette, lookupIndex), _mm256_shuffle_epi8(spritePalette, lookupIndex), isSpritePalette);
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(output + x), _mm256_and_si256(color, colorMask));
+		}
+
+		if (x < endX)
+		{
+			sprite0HitX = mergeSprite0Hit(sprite0HitX, compositeScanlineSSE2(layers, palette, ppuMask, x, endX, output));
+		}
+
+		return sprite0HitX;
+	}
+#endif
+
+	CompositeScanlineFunction selectCompositeScanline()
+	{
+#ifdef SUKINES_ARCH_X86
+		const CpuFeatures& features = hostCpuFeatures();
+		if (features.avx2)
+		{
+			return &compositeScanlineAVX2;
+		}
+		else if (features.sse2)
+		{
+			return &compositeScanlineSSE2;
+		}
+#endif
+		return &compositeScanlineScalar;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+namespace sukiNES
+{
+	static const uint32 ScanlineWidth = 256;
+
+	/**
+	 * @brief Background and sprite pixels of one scanline, ready to be composited
+	 *
+	 * Each layer is a byte array indexed by screen X.
+	 * - background: pattern pixel in bits 0-1, attribute in bits 2-3
+	 * - sprite: first opaque sprite pixel covering X (pixel | palette << 2 | 0x10), 0 when none
+	 * - frontSprite: same as sprite but only considering sprites in front of the background
+	 * - sprite0: 0xFF where sprite 0 is opaque and not hidden by an earlier front sprite
+	 */
+	struct ScanlineLayers
+	{
+		const byte* background;
+		const byte* sprite;
+		const byte* frontSprite;
+		const byte* sprite0;
+	};
+
+	/**
+	 * @brief Resolve priority, left column masks, palette lookup and greyscale for pixels [startX, endX)
+	 * @param layers Scanline layers to composite
+	 * @param palette PPU palette RAM (32 entries)
+	 * @param ppuMask Raw value of PPUMASK ($2001)
+	 * @param startX First pixel to composite
+	 * @param endX One past the last pixel to composite
+	 * @param output Palette values, indexed by screen X
+	 * @return X of the first sprite 0 hit in the range, -1 if none
+	 */
+	typedef sint32 (*CompositeScanlineFunction)(const ScanlineLayers& layers, const byte* palette, byte ppuMask, uint32 startX, uint32 endX, byte* output);
+
+	sint32 compositeScanlineScalar(const ScanlineLayers& layers, const byte* palette, byte ppuMask, uint32 startX, uint32 endX, byte* output);
+#ifdef SUKINES_ARCH_X86
+	sint32 compositeScanlineSSE2(const ScanlineLayers& layers, const byte* palette, byte ppuMask, uint32 startX, uint32 endX, byte* output);
+	sint32 compositeScanlineAVX2(const ScanlineLayers& layers, const byte* palette, byte ppuMask, uint32 startX, uint32 endX, byte* output);
+#endif
+
+	/**
+	 * @brief Only test sprite 0 hit for pixels [startX, endX), the sprite and frontSprite layers are not used
+	 * @return X of the first sprite 0 hit in the range, -1 if none
+	 */
+	sint32 detectSprite0Hit(const ScanlineLayers& layers, byte ppuMask, uint32 startX, uint32 endX);
+
+	/**
+	 * @brief Fastest compositing kernel supported by the host CPU
+	 */
+	CompositeScanlineFunction selectCompositeScanline();
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "spriterange.h"
+
+#ifdef SUKINES_ARCH_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+// Local includes
+#include "cpufeatures.h"
+
+namespace sukiNES
+{
+	static void clearSpritesInRange(SpritesInRange& result)
+	{
+		result.count = 0;
+		result.overflowIndex = OamSpriteCount;
+	}
+
+	static void addSpriteInRange(SpritesInRange& result, byte oamIndex)
+	{
+		if (result.count < 8)
+		{
+			result.oamIndices[result.count] = oamIndex;
+		}
+		else
+		{
+			result.overflowIndex = oamIndex;
+		}
+
+		++result.count;
+	}
+
+	// Append the sprites of a range mask, bit N being OAM sprite firstIndex + N
+	// @return true once the 9th sprite was found
+	static bool addSpritesInRange(SpritesInRange& result, uint32 mask, byte firstIndex)
+	{
+		while (mask != 0)
+		{
+			addSpriteInRange(result, static_cast<byte>(firstIndex + lowestSetBit(mask)));
+			if (result.count > 8)
+			{
+				return true;
+			}
+
+			mask &= mask - 1;
+		}
+
+		return false;
+	}
+
+	void findSpritesInRangeScalar(const byte* spriteY, uint32 scanline, uint32 spriteSize, SpritesInRange& result)
+	{
+		clearSpritesInRange(result);
+
+		for (byte oamIndex = 0; oamIndex < OamSpriteCount && result.count <= 8; ++oamIndex)
+		{
+			if (scanline - spriteY[oamIndex] < spriteSize)
+			{
+				addSpriteInRange(result, oamIndex);
+			}
+		}
+	}
+
+#ifdef SUKINES_ARCH_X86
+	// In range when y <= scanline, without wrapping, and scanline - y < spriteSize.
+	// SSE2 only has signed byte compares, so both tests go through unsigned min/max.
+	SUKINES_TARGET_SSE2 static inline uint32 rangeMaskSSE2(const byte* spriteY, __m128i scanline, __m128i lastRow)
+	{
+		__m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(spriteY));
+		__m128i isAbove = _mm_cmpeq_epi8(_mm_max_epu8(y, scanline), scanline);
+		__m128i row = _mm_sub_epi8(scanline, y);
+		__m128i isWithin = _mm_cmpeq_epi8(_mm_min_epu8(row, lastRow), row);
+
+		return static_cast<uint32>(_mm_movemask_epi8(_mm_and_si128(isAbove, isWithin)));
+	}
+
+	SUKINES_TARGET_SSE2 void findSpritesInRangeSSE2(const byte* spriteY, uint32 scanline, uint32 spriteSize, SpritesInRange& result)
+	{
+		clearSpritesInRange(result);
+
+		__m128i scanlines = _mm_set1_epi8(static_cast<char>(scanline));
+		__m128i lastRow = _mm_set1_epi8(static_cast<char>(spriteSize - 1));
+
+		for (uint32 oamIndex = 0; oamIndex < OamSpriteCount; oamIndex += 16)
+		{
+			if (addSpritesInRange(result, rangeMaskSSE2(spriteY + oamIndex, scanlines, lastRow), static_cast<byte>(oamIndex)))
+			{
+				break;
+			}
+		}
+	}
+
+	SUKINES_TARGET_AVX2 void findSpritesInRangeAVX2(const byte* spriteY, uint32 scanline, uint32 spriteSize, SpritesInRange& result)
+	{
+		clearSpritesInRange(result);
+
+		__m256i scanlines = _mm256_set1_epi8(static_cast<char>(scanline));
+		__m256i lastRow = _mm256_set1_epi8(static_cast<char>(spriteSize - 1));
+
+		for (uint32 oamIndex = 0; oamIndex < OamSpriteCount; oamIndex += 32)
+		{
+			__m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(spriteY + oamIndex));
+			__m256i isAbove = _mm256_cmpeq_epi8(_mm256_max_epu8(y, scanlines), scanlines);
+			__m256i row = _mm256_sub_epi8(scanlines, y);
+			__m256i isWithin = _mm256_cmpeq_epi8(_mm256_min_epu8(row, lastRow), row);
+			uint32 mask = static_cast<uint32>(_mm256_movemask_epi8(_mm256_and_si256(isAbove, isWithin)));
+
+			if (addSpritesInRange(result, mask, static_cast<byte>(oamIndex)))
+			{
+				break;
+			}
+		}
+	}
+#endif
+
+	FindSpritesInRangeFunction selectFindSpritesInRange()
+	{
+#ifdef SUKINES_ARCH_X86
+		const CpuFeatures& features = hostCpuFeatures();
+		if (features.avx2)
+		{
+			return &findSpritesInRangeAVX2;
+		}
+		else if (features.sse2)
+		{
+			return &findSpritesInRangeSSE2;
+		}
+#endif
+		return &findSpritesInRangeScalar;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+namespace sukiNES
+{
+	static const uint32 OamSpriteCount = 64;
+
+	/**
+	 * @brief Sprites covering a scanline, in OAM order
+	 */
+	struct SpritesInRange
+	{
+		// Up to 9, past 8 only matters for the overflow flag
+		byte count;
+		byte oamIndices[8];
+		// OAM index of the 9th sprite found, 64 if none
+		byte overflowIndex;
+	};
+
+	/**
+	 * @brief Run the sprite range test of all OAM sprites against a scanline
+	 * @param spriteY Y coordinate of the 64 OAM sprites
+	 * @param scanline Visible scanline to test, 0 to 239
+	 * @param spriteSize Sprite height, 8 or 16
+	 * @param result First 8 sprites in range and the 9th one
+	 */
+	typedef void (*FindSpritesInRangeFunction)(const byte* spriteY, uint32 scanline, uint32 spriteSize, SpritesInRange& result);
+
+	void findSpritesInRangeScalar(const byte* spriteY, uint32 scanline, uint32 spriteSize, SpritesInRange& result);
+#ifdef SUKINES_ARCH_X86
+	void findSpritesInRangeSSE2(const byte* spriteY, uint32 scanline, uint32 spriteSize, SpritesInRange& result);
+	void findSpritesInRangeAVX2(const byte* spriteY, uint32 scanline, uint32 spriteSize, SpritesInRange& result);
+#endif
+
+	/**
+	 * @brief Fastest range test kernel supported by the host CPU
+	 */
+	FindSpritesInRangeFunction selectFindSpritesInRange();
+}
\ No newline at end of file
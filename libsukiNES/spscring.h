@@ -0,0 +1,97 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+
+namespace sukiNES
+{
+	/**
+	 * @brief Wait-free ring of values passed from one thread to another
+	 *
+	 * Single producer, single consumer. Neither side ever blocks: push() fails
+	 * when the ring is full and pop() when it is empty.
+	 */
+	template<typename T, uint32 Capacity>
+	class SpscRing
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of 2");
+
+	public:
+		SpscRing()
+		{
+			clear();
+		}
+
+		/**
+		 * @brief Append a value
+		 * @return false when the ring is full, the value is not added
+		 *
+		 * Producer thread only.
+		 */
+		bool push(const T& value)
+		{
+			uint32 writeIndex = _writeIndex.load(std::memory_order_relaxed);
+			if (writeIndex - _readIndex.load(std::memory_order_acquire) == Capacity)
+			{
+				return false;
+			}
+
+			_values[writeIndex & (Capacity - 1)] = value;
+			_writeIndex.store(writeIndex + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		/**
+		 * @brief Take the oldest value
+		 * @return false when the ring is empty
+		 *
+		 * Consumer thread only.
+		 */
+		bool pop(T& value)
+		{
+			uint32 readIndex = _readIndex.load(std::memory_order_relaxed);
+			if (readIndex == _writeIndex.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+
+			value = _values[readIndex & (Capacity - 1)];
+			_readIndex.store(readIndex + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		/**
+		 * @brief Values pushed since the ring was created or cleared, wraps around
+		 */
+		uint32 pushedCount() const
+		{
+			return _writeIndex.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief Values popped since the ring was created or cleared, wraps around
+		 */
+		uint32 poppedCount() const
+		{
+			return _readIndex.load(std::memory_order_acquire);
+		}
+
+		/**
+		 * @brief Drop every value, neither thread may use the ring meanwhile
+		 */
+		void clear()
+		{
+			_writeIndex.store(0);
+			_readIndex.store(0);
+		}
+
+	private:
+		T _values[Capacity];
+
+		// On their own cache lines, each thread writes only one of them
+		SUKINES_ALIGN(64) std::atomic<uint32> _writeIndex;
+		SUKINES_ALIGN(64) std::atomic<uint32> _readIndex;
+	};
+}
\ No newline at end of file
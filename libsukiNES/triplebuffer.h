@@ -0,0 +1,106 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+
+namespace sukiNES
+{
+	/**
+	 * @brief Latest value passed from one thread to another
+	 *
+	 * Three values rotate between the producer, which writes the back value,
+	 * the consumer, which reads the front value, and the latest published value
+	 * in between. publish() and acquire() each swap one value with the one in
+	 * between in a single atomic exchange: neither side ever waits or sees a
+	 * value being written. Values published faster than they are acquired
+	 * replace each other.
+	 */
+	template<typename T>
+	class TripleBuffer
+	{
+	public:
+		explicit TripleBuffer(const T& initialValue = T())
+		: _backIndex(0)
+		, _frontIndex(2)
+		{
+			for (uint32 index = 0; index < 3; ++index)
+			{
+				_values[index] = initialValue;
+			}
+
+			_latest.store(1);
+		}
+
+		/**
+		 * @brief Value to write, holds an older value after publish()
+		 *
+		 * Producer thread only.
+		 */
+		T& back()
+		{
+			return _values[_backIndex];
+		}
+
+		/**
+		 * @brief Make the back value the latest one
+		 * @return false when the previous one was never acquired, it is replaced
+		 *
+		 * Producer thread only.
+		 */
+		bool publish()
+		{
+			// Release: the consumer taking this value sees all of it
+			uint32 previous = _latest.exchange(_backIndex | NewValueBit, std::memory_order_acq_rel);
+			_backIndex = previous & IndexMask;
+
+			return !(previous & NewValueBit);
+		}
+
+		/**
+		 * @brief Make the latest published value the front value
+		 * @return false when nothing was published since the previous call, the front value stays
+		 *
+		 * Consumer thread only.
+		 */
+		bool acquire()
+		{
+			if (!(_latest.load(std::memory_order_relaxed) & NewValueBit))
+			{
+				return false;
+			}
+
+			// Only the producer sets NewValueBit, it is still set for the exchange
+			uint32 latest = _latest.exchange(_frontIndex, std::memory_order_acq_rel);
+			_frontIndex = latest & IndexMask;
+
+			return true;
+		}
+
+		/**
+		 * @brief Value to read, the initial value until the first acquire()
+		 *
+		 * Consumer thread only.
+		 */
+		T& front()
+		{
+			return _values[_frontIndex];
+		}
+
+		const T& front() const
+		{
+			return _values[_frontIndex];
+		}
+
+	private:
+		// Index of the value in between, with NewValueBit set until it is acquired
+		static const uint32 NewValueBit = 4;
+		static const uint32 IndexMask = 3;
+
+		T _values[3];
+
+		uint32 _backIndex;
+		uint32 _frontIndex;
+
+		SUKINES_ALIGN(64) std::atomic<uint32> _latest;
+	};
+}
\ No newline at end of file
@@ -22,10 +22,8 @@ void CpuRegisterDockWidget::closeEvent(QCloseEvent* event)
 	QDockWidget::closeEvent(event);
 }
 
-void CpuRegisterDockWidget::cpuUpdated(sukiNES::Cpu* cpu)
+void CpuRegisterDockWidget::cpuUpdated(const sukiNES::CpuRegisters& cpuRegisters)
 {
-	auto cpuRegisters = cpu->getRegisters();
-
 	_ui.lineA->setText( QString::number(cpuRegisters.A, 16).toUpper() );
 	_ui.lineX->setText( QString::number(cpuRegisters.X, 16).toUpper() );
 	_ui.lineY->setText( QString::number(cpuRegisters.Y, 16).toUpper() );
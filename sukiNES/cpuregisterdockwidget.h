@@ -6,7 +6,7 @@
 
 namespace sukiNES
 {
-	class Cpu;
+	struct CpuRegisters;
 }
 
 class QCloseEvent;
@@ -22,7 +22,7 @@ signals:
 	void onClosed();
 
 public slots:
-	void cpuUpdated(sukiNES::Cpu* cpu);
+	void cpuUpdated(const sukiNES::CpuRegisters& cpuRegisters);
 
 protected:
 	virtual void closeEvent(QCloseEvent* event) override;
@@ -1,18 +1,44 @@
 #include "emulatorrunner.h"
 
 // Qt includes
-#include <QtCore/QTimer>
+#include <QtCore/QDebug>
 
 // sukiNES includes
 #include <ppuio.h>
 #include <inputio.h>
 #include <inesreader.h>
 
+// Local includes
+#include "renderrunner.h"
+
+static const qint64 NanosecondsPerSecond = 1000000000;
+// Sleeps can overshoot by a scheduler tick, the end of the wait yields instead
+static const qint64 SpinNanoseconds = 2000000;
+// Further behind than this, the deadlines start over from now instead of catching up
+static const uint32 MaxLateFrames = 3;
+// At normal speed, a frame is shown at least after this many skipped frames
+static const uint32 MaxSkippedFrames = 4;
+
 EmulatorRunner::EmulatorRunner(QObject* parent)
 : QThread(parent)
-, _isThreadRunning(true)
-, _isEmulationRunning(false)
+, _ppuIO(nullptr)
+, _frameTripleBuffer(nullptr)
+, _renderRunner(nullptr)
+, _nextFrameDeadline(0)
+, _nextShownFrameTime(0)
+, _skippedFrameCount(0)
+, _frameRateStart(0)
+, _frameRateCount(0)
 {
+	_isThreadRunning.store(true);
+	_isEmulationRunning.store(false);
+	_isDeferredRendering.store(false);
+	_isDebugSnapshotEnabled.store(false);
+	_speed.store(1);
+	_requestedFrameTripleBuffer.store(nullptr);
+
+	_renderRunner = new RenderRunner(&_writeLog, this);
+
 	_mainMemory.setGamepakMemory(&_gamePak);
 	_mainMemory.setPpuMemory(&_ppu);
 
@@ -21,9 +47,8 @@ EmulatorRunner::EmulatorRunner(QObject* parent)
 	_cpu.setPPU(&_ppu);
 	_cpu.setMainMemory(&_mainMemory);
 
-	_tempTimer = new QTimer(this);
-	QObject::connect(_tempTimer, &QTimer::timeout, this, &EmulatorRunner::sendCpuUpdated);
-	QObject::connect(_tempTimer, &QTimer::timeout, this, &EmulatorRunner::sendPpuUpdated);
+	// Emitted on the emulation thread, the snapshot is taken on the GUI thread
+	QObject::connect(this, &EmulatorRunner::debugSnapshotPublished, this, &EmulatorRunner::sendDebugSnapshot, Qt::QueuedConnection);
 }
 
 void EmulatorRunner::setInputIO(sukiNES::InputIO* io)
@@ -33,83 +58,417 @@ void EmulatorRunner::setInputIO(sukiNES::InputIO* io)
 
 void EmulatorRunner::setPPUIO(sukiNES::PPUIO* io)
 {
+	_ppuIO = io;
 	_ppu.setIO(io);
 }
 
-bool EmulatorRunner::loadRom(const QString& romFilename)
+void EmulatorRunner::setFrameTripleBuffer(sukiNES::FrameTripleBuffer* buffer)
 {
-	sukiNES::iNESReader nesReader;
-	nesReader.setGamePak(&_gamePak);
-	nesReader.setPpu(&_ppu);
+	// The PPUs write to the back frame of the current buffer, only the emulation thread may change it
+	_requestedFrameTripleBuffer.store(buffer);
+	doCommand(Command::ApplyFrameTripleBuffer);
+}
+
+void EmulatorRunner::loadRom(const QString& romFilename)
+{
+	// The CPU and the PPU read the game pak on every opcode, only the emulation thread may replace it
+	_romFilenames.back() = romFilename;
+	_romFilenames.publish();
+	doCommand(Command::LoadRom);
+
+	if (!isRunning())
+	{
+		start();
+	}
+}
+
+bool EmulatorRunner::loadPalette(const QString& paletteFilename)
+{
+	sukiNES::RgbPalette palette;
+	if (!palette.load(paletteFilename.toLocal8Bit().constData()))
+	{
+		return false;
+	}
+
+	// The PPUs read the palette on every scanline, only the emulation thread may change it
+	_palettes.back() = palette;
+	_palettes.publish();
+	doCommand(Command::ApplyPalette);
+
+	return true;
+}
 
-	return nesReader.read(romFilename.toLocal8Bit().constData());
+void EmulatorRunner::setDeferredRendering(bool value)
+{
+	_isDeferredRendering.store(value);
 }
 
 void EmulatorRunner::quitThread()
 {
-	_isThreadRunning = false;
+	_isThreadRunning.store(false);
+	_wakeUp.release();
+	_renderRunner->quitThread();
 }
 
 void EmulatorRunner::doCommand(EmulatorRunner::Command command)
 {
-	QMutexLocker locker(&_emulationMutex);
-	_commands.enqueue(command);
+	if (!_commands.push(command))
+	{
+		qWarning() << "Emulation command dropped, the emulation thread is not taking commands";
+		return;
+	}
+
+	_wakeUp.release();
+}
+
+void EmulatorRunner::setSpeed(uint32 speed)
+{
+	_speed.store(speed);
 }
 
-void EmulatorRunner::sendCpuUpdated()
+void EmulatorRunner::setDebugSnapshotEnabled(bool value)
 {
-	emit cpuUpdated(&_cpu);
+	_isDebugSnapshotEnabled.store(value);
+
+	// A paused emulation thread publishes one when it goes back to waiting
+	_wakeUp.release();
 }
 
-void EmulatorRunner::sendPpuUpdated()
+void EmulatorRunner::sendDebugSnapshot()
 {
-	emit ppuUpdated(&_ppu);
+	// Snapshots published meanwhile replaced each other, the newest is sent once
+	if (!_debugSnapshots.acquire())
+	{
+		return;
+	}
+
+	const DebugSnapshot& snapshot = _debugSnapshots.front();
+	emit cpuUpdated(snapshot.cpu);
+	emit ppuUpdated(snapshot.ppu);
 }
 
 void EmulatorRunner::run()
 {
-	while(_isThreadRunning)
+	_clock.start();
+	_nextFrameDeadline = _clock.nsecsElapsed();
+	_frameRateStart = _nextFrameDeadline;
+	_frameRateCount = 0;
+
+	while(_isThreadRunning.load(std::memory_order_relaxed))
 	{
-		_emulationMutex.lock();
+		// Commands only apply between frames
+		_runCommands();
+
+		if (!isEmulationRunning())
+		{
+			_waitForCommand();
+			continue;
+		}
+
+		_runFrame();
+		++_frameRateCount;
+		_publishDebugSnapshot();
+
+		uint32 speed = _speed.load(std::memory_order_relaxed);
+		qint64 consolePeriod = static_cast<qint64>(NanosecondsPerSecond / sukiNES::regionTiming(_ppu.region()).frameRate);
+		qint64 framePeriod = speed > 0 ? consolePeriod / speed : 0;
 
-		while(!_commands.isEmpty())
+		// Absolute deadlines keep the rounding of each sleep from adding up
+		_nextFrameDeadline += framePeriod;
+
+		qint64 now = _clock.nsecsElapsed();
+		if (now - _nextFrameDeadline > framePeriod * MaxLateFrames)
 		{
-			auto commandToDo = _commands.dequeue();
-
-			if (!_gamePak.hasGamePak())
-			{
-				continue;
-			}
-
-			switch(commandToDo)
-			{
-				case Command::PowerOn:
-					_cpu.powerOn();
-					_isEmulationRunning = true;
-					break;
-				case Command::Reset:
-					_cpu.reset();
-					break;
-				case Command::ResumeEmulation:
-					_isEmulationRunning = true;
-					break;
-				case Command::StopEmulation:
-					_isEmulationRunning = false;
-					break;
-				case Command::Step:
-					_isEmulationRunning = false;
-					_cpu.executeOpcode();
-					sendCpuUpdated();
-					sendPpuUpdated();
-					break;
-			}
+			_nextFrameDeadline = now;
 		}
 
-		_emulationMutex.unlock();
+		_skipFrames(now, consolePeriod, speed);
+		_waitUntil(_nextFrameDeadline);
+
+		_updateFrameRate();
+	}
+}
+
+void EmulatorRunner::_waitForCommand()
+{
+	emit frameRateUpdated(0.0);
+	_publishDebugSnapshot();
+
+	// Paused or without a ROM, sleep until doCommand() or quitThread()
+	_wakeUp.acquire();
+
+	// Every command queued meanwhile released it too, they are all taken next
+	_wakeUp.tryAcquire(_wakeUp.available());
+
+	_restartFramePacing();
+}
+
+void EmulatorRunner::_restartFramePacing()
+{
+	_nextFrameDeadline = _clock.nsecsElapsed();
+	_frameRateStart = _nextFrameDeadline;
+	_frameRateCount = 0;
+
+	_skippedFrameCount = 0;
+	_setNextFrameRendered(true);
+}
+
+void EmulatorRunner::_skipFrames(qint64 now, qint64 consolePeriod, uint32 speed)
+{
+	bool isRendered = true;
+
+	if (speed == 1)
+	{
+		// Behind schedule, frames go unrendered to catch up instead of slowing the game down
+		isRendered = now - _nextFrameDeadline <= consolePeriod / 2 || _skippedFrameCount >= MaxSkippedFrames;
+	}
+	else if (now < _nextShownFrameTime)
+	{
+		// Faster than the console, the display still only shows frames at the console frame rate
+		isRendered = false;
+	}
+
+	if (isRendered)
+	{
+		_skippedFrameCount = 0;
 
-		if (isEmulationRunning())
+		_nextShownFrameTime += consolePeriod;
+		if (_nextShownFrameTime <= now)
 		{
-			_cpu.executeOpcode();
+			_nextShownFrameTime = now + consolePeriod;
 		}
 	}
+	else
+	{
+		++_skippedFrameCount;
+	}
+
+	_setNextFrameRendered(isRendered);
+}
+
+void EmulatorRunner::_setNextFrameRendered(bool value)
+{
+	// _runFrame() returns once the PPU started the following frame, this applies to the one after
+	if (_renderRunner->isRunning())
+	{
+		// The emulated PPU is timing-only already, the render thread skips the frame instead
+		_ppu.logTimingOnly(!value);
+	}
+	else
+	{
+		_ppu.setTimingOnly(!value);
+	}
+}
+
+void EmulatorRunner::_publishDebugSnapshot()
+{
+	if (!_isDebugSnapshotEnabled.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+
+	DebugSnapshot& snapshot = _debugSnapshots.back();
+	snapshot.cpu = _cpu.getRegisters();
+	_ppu.captureDebugState(snapshot.ppu);
+
+	// When the previous snapshot is not taken yet, the GUI thread already has a call queued that takes this one
+	if (_debugSnapshots.publish())
+	{
+		emit debugSnapshotPublished();
+	}
 }
+
+void EmulatorRunner::_runCommands()
+{
+	Command commandToDo;
+	while(_commands.pop(commandToDo))
+	{
+		// Loading a game, the palette and the frame buffer do not need one, the other commands do
+		if (!_gamePak.hasGamePak() && commandToDo != Command::LoadRom && commandToDo != Command::ApplyPalette && commandToDo != Command::ApplyFrameTripleBuffer)
+		{
+			continue;
+		}
+
+		switch(commandToDo)
+		{
+			case Command::PowerOn:
+				_powerOn();
+				break;
+			case Command::Reset:
+				_cpu.reset();
+				break;
+			case Command::ResumeEmulation:
+				_isEmulationRunning.store(true, std::memory_order_release);
+				break;
+			case Command::StopEmulation:
+				_isEmulationRunning.store(false, std::memory_order_release);
+				break;
+			case Command::Step:
+				_isEmulationRunning.store(false, std::memory_order_release);
+				// Published once the thread waits for the next command
+				_cpu.executeOpcode();
+				break;
+			case Command::LoadRom:
+				_loadRom();
+				break;
+			case Command::ApplyPalette:
+				_applyPalette();
+				break;
+			case Command::ApplyFrameTripleBuffer:
+				_applyFrameTripleBuffer();
+				break;
+		}
+	}
+}
+
+void EmulatorRunner::_powerOn()
+{
+	_applyRenderingMode();
+	_cpu.powerOn();
+	_isEmulationRunning.store(true, std::memory_order_release);
+}
+
+void EmulatorRunner::_loadRom()
+{
+	// ROMs opened meanwhile replaced each other, the newest was loaded by the first command
+	if (!_romFilenames.acquire())
+	{
+		return;
+	}
+
+	const QString& romFilename = _romFilenames.front();
+
+	sukiNES::iNESReader nesReader;
+	nesReader.setGamePak(&_gamePak);
+	nesReader.setPpu(&_ppu);
+
+	// The reader fails before touching the game pak, the current game is kept as it was
+	if (!nesReader.read(romFilename.toLocal8Bit().constData()))
+	{
+		qWarning() << "Could not load ROM" << romFilename;
+		return;
+	}
+
+	// The render thread starts over from the power on, the CHR data and mirroring it had belong to the previous game
+	_powerOn();
+
+	// Reading the file took frame time, the new game does not catch up on it
+	_restartFramePacing();
+
+	emit romLoaded(romFilename);
+}
+
+void EmulatorRunner::_applyPalette()
+{
+	// Palettes loaded meanwhile replaced each other, the newest was applied by the first command
+	if (!_palettes.acquire())
+	{
+		return;
+	}
+
+	const sukiNES::RgbPalette& palette = _palettes.front();
+	_ppu.setRgbPalette(palette);
+
+	if (_renderRunner->isRunning())
+	{
+		// The log keeps filling up meanwhile, rendering resumes where it stopped
+		_renderRunner->quitThread();
+		_renderRunner->ppu().setRgbPalette(palette);
+		_renderRunner->startThread();
+	}
+}
+
+void EmulatorRunner::_applyFrameTripleBuffer()
+{
+	_frameTripleBuffer = _requestedFrameTripleBuffer.load();
+
+	if (_renderRunner->isRunning())
+	{
+		_renderRunner->quitThread();
+		_renderRunner->ppu().setFrameTripleBuffer(_frameTripleBuffer);
+		_renderRunner->startThread();
+	}
+	else
+	{
+		_ppu.setFrameTripleBuffer(_frameTripleBuffer);
+	}
+}
+
+void EmulatorRunner::_runFrame()
+{
+	uint32 frameCount = _ppu.frameCount();
+	while(_ppu.frameCount() == frameCount)
+	{
+		_cpu.executeOpcode();
+	}
+}
+
+void EmulatorRunner::_waitUntil(qint64 deadline)
+{
+	for(;;)
+	{
+		qint64 remaining = deadline - _clock.nsecsElapsed();
+		if (remaining <= 0)
+		{
+			break;
+		}
+
+		if (remaining > SpinNanoseconds)
+		{
+			QThread::usleep(static_cast<unsigned long>((remaining - SpinNanoseconds) / 1000));
+		}
+		else
+		{
+			QThread::yieldCurrentThread();
+		}
+	}
+}
+
+void EmulatorRunner::_updateFrameRate()
+{
+	qint64 elapsed = _clock.nsecsElapsed() - _frameRateStart;
+	if (elapsed >= NanosecondsPerSecond)
+	{
+		emit frameRateUpdated(_frameRateCount * static_cast<double>(NanosecondsPerSecond) / elapsed);
+
+		_frameRateStart += elapsed;
+		_frameRateCount = 0;
+	}
+}
+
+void EmulatorRunner::_applyRenderingMode()
+{
+	// Both PPUs start over from the power on logged next
+	_renderRunner->quitThread();
+	_writeLog.clear();
+
+	if (_isDeferredRendering.load())
+	{
+		sukiNES::PPU& renderPpu = _renderRunner->ppu();
+		renderPpu.setNametableMirroring(_ppu.nametableMirroring());
+		renderPpu.setRegion(_ppu.region());
+		renderPpu.setRgbPalette(_ppu.rgbPalette());
+		renderPpu.setTimingOnly(false);
+		renderPpu.setFrameTripleBuffer(_frameTripleBuffer);
+		renderPpu.setIO(_ppuIO);
+		_renderRunner->setChrBank(_gamePak.chrBank());
+
+		// Only one PPU at a time publishes frames
+		_ppu.setFrameTripleBuffer(nullptr);
+		_ppu.setFrameBuffer(sukiNES::FrameBuffer());
+		_ppu.setIO(nullptr);
+		_ppu.setTimingOnly(true);
+		_ppu.setWriteLog(&_writeLog);
+
+		_renderRunner->startThread();
+	}
+	else
+	{
+		_renderRunner->ppu().setFrameTripleBuffer(nullptr);
+
+		_ppu.setFrameTripleBuffer(_frameTripleBuffer);
+		_ppu.setIO(_ppuIO);
+		_ppu.setTimingOnly(false);
+		_ppu.setWriteLog(nullptr);
+	}
+}
\ No newline at end of file
@@ -1,24 +1,31 @@
 #pragma once
 
+// STL includes
+#include <atomic>
+
 // Qt includes
 #include <QtCore/QThread>
-#include <QtCore/QMutex>
-#include <QtCore/QMutexLocker>
-#include <QtCore/QQueue>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QSemaphore>
 
 // sukiNES includes
 #include <cpu.h>
 #include <gamepak.h>
 #include <mainmemory.h>
 #include <ppu.h>
+#include <ppudebugstate.h>
+#include <ppuwritelog.h>
+#include <spscring.h>
+#include <triplebuffer.h>
 
 namespace sukiNES
 {
+	class FrameTripleBuffer;
 	class PPUIO;
 	class InputIO;
 }
 
-class QTimer;
+class RenderRunner;
 
 class EmulatorRunner : public QThread
 {
@@ -30,49 +37,160 @@ public:
 		Reset,
 		StopEmulation,
 		ResumeEmulation,
-		Step
+		Step,
+		// Sent by loadRom()
+		LoadRom,
+		// Sent by loadPalette()
+		ApplyPalette,
+		// Sent by setFrameTripleBuffer()
+		ApplyFrameTripleBuffer
+	};
+
+	/**
+	 * @brief CPU and PPU state for the debug views, copied on the emulation thread
+	 */
+	struct DebugSnapshot
+	{
+		sukiNES::CpuRegisters cpu;
+		sukiNES::PPUDebugState ppu;
 	};
 
 	EmulatorRunner(QObject* parent = nullptr);
 
 	void setPPUIO(sukiNES::PPUIO* io);
+	/**
+	 * @brief Publish the rendered frames to buffer, from whichever thread renders them
+	 *
+	 * The emulation thread switches to buffer at the next frame boundary, it may still
+	 * publish to the previous buffer meanwhile. Its pixel format is the one rendered.
+	 */
+	void setFrameTripleBuffer(sukiNES::FrameTripleBuffer* buffer);
 	void setInputIO(sukiNES::InputIO* io);
 
-	bool loadRom(const QString& romFilename);
+	/**
+	 * @brief Load and power on a ROM file on the emulation thread, starting it if needed
+	 *
+	 * The game pak and the PPU belong to the emulation thread, it loads the ROM
+	 * between two frames and sends romLoaded() once it runs.
+	 */
+	void loadRom(const QString& romFilename);
+	/**
+	 * @brief Load a palette file, the emulation thread applies it at the next frame boundary
+	 */
+	bool loadPalette(const QString& paletteFilename);
+
+	/**
+	 * @brief Render the frames on a second thread, one frame behind the emulation
+	 *
+	 * Takes effect at the next power on.
+	 */
+	void setDeferredRendering(bool value);
+
+	/**
+	 * @brief Publish a DebugSnapshot at each frame boundary and when paused, while a debug view is open
+	 */
+	void setDebugSnapshotEnabled(bool value);
+
+	/**
+	 * @brief Run speed times faster than the console, 0 for as fast as the host can
+	 *
+	 * Above normal speed, only the frames shown at the console frame rate are
+	 * rendered. At normal speed, frames go unrendered when the host falls behind.
+	 */
+	void setSpeed(uint32 speed);
 
 	void quitThread();
 
 	bool isEmulationRunning() const
 	{
-		QMutexLocker autoLock(&_emulationMutex);
-		return _isEmulationRunning;
+		return _isEmulationRunning.load(std::memory_order_acquire);
 	}
 
+	/**
+	 * @brief Queue a command, run at the next frame boundary
+	 *
+	 * Only call from the GUI thread, the command ring has a single producer.
+	 */
 	void doCommand(Command value);
 
 signals:
-	void cpuUpdated(sukiNES::Cpu* cpu);
-	void ppuUpdated(sukiNES::PPU* ppu);
+	/**
+	 * @brief The newest snapshot, sent on the GUI thread, valid until the slot returns
+	 */
+	void cpuUpdated(const sukiNES::CpuRegisters& registers);
+	void ppuUpdated(const sukiNES::PPUDebugState& state);
+
+	/**
+	 * @brief Sent on the emulation thread when a snapshot is published
+	 */
+	void debugSnapshotPublished();
+
+	/**
+	 * @brief Frames emulated during the last second, sent once per second
+	 */
+	void frameRateUpdated(double framesPerSecond);
+
+	/**
+	 * @brief Sent on the emulation thread once the ROM loaded by loadRom() is powered on
+	 */
+	void romLoaded(const QString& romFilename);
 
 protected:
 	virtual void run() override;
 
 private slots:
-	void sendCpuUpdated();
-	void sendPpuUpdated();
+	void sendDebugSnapshot();
+
+private:
+	void _powerOn();
+	void _loadRom();
+	void _applyRenderingMode();
+	void _applyPalette();
+	void _applyFrameTripleBuffer();
+	void _runCommands();
+	void _runFrame();
+	void _waitForCommand();
+	void _restartFramePacing();
+	void _skipFrames(qint64 now, qint64 consolePeriod, uint32 speed);
+	void _setNextFrameRendered(bool value);
+	void _publishDebugSnapshot();
+	void _waitUntil(qint64 deadline);
+	void _updateFrameRate();
 
 private:
 	sukiNES::Cpu _cpu;
 	sukiNES::GamePak _gamePak;
 	sukiNES::MainMemory _mainMemory;
 	sukiNES::PPU _ppu;
-
-	mutable QMutex _emulationMutex;
-
-	QQueue<Command> _commands;
-
-	bool _isThreadRunning;
-	bool _isEmulationRunning;
-
-	QTimer* _tempTimer;
+	sukiNES::PPUWriteLog _writeLog;
+	sukiNES::PPUIO* _ppuIO;
+	sukiNES::FrameTripleBuffer* _frameTripleBuffer;
+
+	RenderRunner* _renderRunner;
+
+	// GUI thread to emulation thread
+	sukiNES::SpscRing<Command, 64> _commands;
+	sukiNES::TripleBuffer<QString> _romFilenames;
+	sukiNES::TripleBuffer<sukiNES::RgbPalette> _palettes;
+	std::atomic<sukiNES::FrameTripleBuffer*> _requestedFrameTripleBuffer;
+	// Released by each command, the idle emulation thread blocks on it
+	QSemaphore _wakeUp;
+
+	// Emulation thread to GUI thread
+	sukiNES::TripleBuffer<DebugSnapshot> _debugSnapshots;
+
+	std::atomic<bool> _isThreadRunning;
+	std::atomic<bool> _isEmulationRunning;
+	std::atomic<bool> _isDeferredRendering;
+	std::atomic<bool> _isDebugSnapshotEnabled;
+	std::atomic<uint32> _speed;
+
+	// Frame pacing, in nanoseconds of _clock
+	QElapsedTimer _clock;
+	qint64 _nextFrameDeadline;
+	// Above normal speed, frames finished before this time are not shown
+	qint64 _nextShownFrameTime;
+	uint32 _skippedFrameCount;
+	qint64 _frameRateStart;
+	uint32 _frameRateCount;
 };
\ No newline at end of file
@@ -1,36 +1,40 @@
 #include "emulatorwidget.h"
 
 // Qt includes
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QTimer>
 #include <QtGui/QKeyEvent>
 #include <QtGui/QPaintEvent>
 #include <QtGui/QPainter>
 
-#include "nespalette.h"
-
 #ifdef SUKINES_DEBUG
 static const uint32 ScalingFactor = 1;
 #else
 static const uint32 ScalingFactor = 3;
 #endif
 
-static const uint32 ScreenWidth = 256*ScalingFactor;
-static const uint32 ScreenHeight = 240*ScalingFactor;
+static const uint32 ScreenWidth = sukiNES::FrameWidth*ScalingFactor;
+static const uint32 ScreenHeight = sukiNES::FrameHeight*ScalingFactor;
 
 EmulatorWidget::EmulatorWidget(QWidget* parent)
 : QWidget(parent)
-, _screenBuffer(ScreenWidth, ScreenHeight, QImage::Format_RGB32)
+, _frames(sukiNES::PixelFormat::RGB32)
+, _colorIndexFrames(sukiNES::PixelFormat::ColorIndex)
+, _isPresentationStale(true)
+, _isScreenCleared(false)
+, _isFramePending(false)
+, _isNtscFilter(false)
+, _isNtscShown(false)
+, _presentationNanoseconds(0)
 {
 	setFocusPolicy(Qt::StrongFocus);
 
-	getNESPalette(_palette, sizeof(_palette) / sizeof(QRgb));
-
 	for(uint32 whichController=0; whichController<2; ++whichController)
 	{
 		_buttonStatus[whichController].raw = 0;
 	}
 
-	QTimer::singleShot(0, this, SLOT(callRepaint()));
+	_resizePresentationBuffer();
 }
 
 EmulatorWidget::~EmulatorWidget()
@@ -44,9 +48,88 @@ QSize EmulatorWidget::minimumSizeHint() const
 
 void EmulatorWidget::paintEvent(QPaintEvent* event)
 {
+	QElapsedTimer presentationTimer;
+	presentationTimer.start();
+
+	// The emulation switches buffers at a frame boundary, until its first frame
+	// in the new buffer the previous one keeps getting frames and is shown
+	if (_isNtscShown != _isNtscFilter && frameTripleBuffer()->acquire(false))
+	{
+		_scalerPool.wait();
+		_ntscPool.wait();
+		_isNtscShown = _isNtscFilter;
+		_resizePresentationBuffer();
+		_isPresentationStale = true;
+		_isScreenCleared = false;
+	}
+	// Coalesced update() calls show the newest frame once. Expose and resize
+	// paints also take a new frame, but finding none is no duplicated frame.
+	else if (_shownFrameTripleBuffer()->acquire(_isFramePending))
+	{
+		_isPresentationStale = true;
+		_isScreenCleared = false;
+	}
+	_isFramePending = false;
+
 	QPainter painter(this);
-	
-	painter.drawPixmap(0,0, _screenPixmap);
+	if (_isScreenCleared)
+	{
+		painter.fillRect(0, 0, ScreenWidth, ScreenHeight, Qt::black);
+	}
+	else if (_isNtscShown)
+	{
+		_drawNtscFrame(painter);
+	}
+	else
+	{
+		_drawFrame(painter);
+	}
+
+	_presentationNanoseconds = presentationTimer.nsecsElapsed();
+}
+
+void EmulatorWidget::_drawFrame(QPainter& painter)
+{
+	sukiNES::FrameBuffer frontBuffer = _frames.frontBuffer();
+	sukiNES::ScaleFilter filter = _scalerPool.filter();
+
+	// Nearest neighbour is the painter scaling the front frame itself, wrapped without a copy
+	if (ScalingFactor == 1 || filter == sukiNES::ScaleFilter::Nearest2x || filter == sukiNES::ScaleFilter::Nearest3x)
+	{
+		QImage frontImage(frontBuffer.pixels, sukiNES::FrameWidth, sukiNES::FrameHeight, frontBuffer.pitch, QImage::Format_RGB32);
+		painter.scale(ScalingFactor, ScalingFactor);
+		painter.drawImage(0, 0, frontImage);
+		return;
+	}
+
+	// The scaler threads write straight into the presentation buffer
+	if (_isPresentationStale && _scalerPool.submit(frontBuffer))
+	{
+		_scalerPool.wait();
+		_isPresentationStale = false;
+	}
+
+	uint32 factor = _scalerPool.scaleFactor();
+	qreal scale = static_cast<qreal>(ScalingFactor) / factor;
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, ScalingFactor % factor != 0);
+	painter.scale(scale, scale);
+	painter.drawImage(0, 0, _presentationBuffer);
+}
+
+void EmulatorWidget::_drawNtscFrame(QPainter& painter)
+{
+	// The filter threads write straight into the presentation buffer
+	if (_isPresentationStale && _ntscPool.submit(_colorIndexFrames.frontBuffer(), _colorIndexFrames.frontBurstPhase()))
+	{
+		_ntscPool.wait();
+		_isPresentationStale = false;
+	}
+
+	// The filter outputs 3 pixels per pixel, the scanlines only need to be repeated
+	qreal scaleX = static_cast<qreal>(ScalingFactor * sukiNES::FrameWidth) / sukiNES::NtscOutputWidth;
+	painter.setRenderHint(QPainter::SmoothPixmapTransform, ScalingFactor * sukiNES::FrameWidth != sukiNES::NtscOutputWidth);
+	painter.scale(scaleX, ScalingFactor);
+	painter.drawImage(0, 0, _presentationBuffer);
 }
 
 void EmulatorWidget::keyPressEvent(QKeyEvent* event)
@@ -117,37 +200,58 @@ void EmulatorWidget::keyReleaseEvent(QKeyEvent* event)
 
 void EmulatorWidget::clearScreen()
 {
-	_screenBuffer.fill(Qt::black);
-	callRepaint();
+	// Black until the next frame, the frames themselves belong to the emulation thread
+	_isScreenCleared = true;
+	update();
+}
+
+void EmulatorWidget::setScaleFilter(sukiNES::ScaleFilter filter)
+{
+	_scalerPool.wait();
+	_scalerPool.setFilter(filter);
+	_resizePresentationBuffer();
+	_isPresentationStale = true;
+
+	update();
 }
 
-void EmulatorWidget::putPixel(sint32 x, sint32 y, byte paletteIndex)
+void EmulatorWidget::setNtscFilter(bool value)
 {
-	if (ScalingFactor == 1)
+	_isNtscFilter = value;
+
+	// A frame left in the new buffer since it was last shown is from before the switch
+	if (_isNtscFilter != _isNtscShown)
 	{
-		_screenBuffer.setPixel(x, y, _palette[paletteIndex]);
+		frameTripleBuffer()->acquire(false);
 	}
-	else
+}
+
+void EmulatorWidget::_resizePresentationBuffer()
+{
+	if (_isNtscShown)
 	{
-		for(uint32 scaleY=0; scaleY<ScalingFactor; ++scaleY)
-		{
-			for (uint32 scaleX=0; scaleX<ScalingFactor; ++scaleX)
-			{
-				_screenBuffer.setPixel(x*ScalingFactor+scaleX, y*ScalingFactor+scaleY, _palette[paletteIndex]);
-			}
-		}
+		_presentationBuffer = QImage(sukiNES::NtscOutputWidth, sukiNES::FrameHeight, QImage::Format_RGB32);
+		_ntscPool.setDestination(sukiNES::FrameBuffer(_presentationBuffer.bits(), _presentationBuffer.bytesPerLine(), sukiNES::PixelFormat::RGB32));
+		return;
 	}
+
+	uint32 factor = _scalerPool.scaleFactor();
+	_presentationBuffer = QImage(sukiNES::FrameWidth*factor, sukiNES::FrameHeight*factor, QImage::Format_RGB32);
+	_scalerPool.setDestination(sukiNES::FrameBuffer(_presentationBuffer.bits(), _presentationBuffer.bytesPerLine(), sukiNES::PixelFormat::RGB32));
 }
 
-void EmulatorWidget::onVBlank()
+void EmulatorWidget::onFrame(const sukiNES::FrameInfo& frameInfo)
 {
-	QTimer::singleShot(0, this, SLOT(callRepaint()));
+	if (frameInfo.isRendered && !frameInfo.isUnchanged)
+	{
+		QTimer::singleShot(0, this, SLOT(callRepaint()));
+	}
 }
 
 void EmulatorWidget::callRepaint()
 {
-	_screenPixmap = QPixmap::fromImage(_screenBuffer);
-	repaint();
+	_isFramePending = true;
+	update();
 }
 
 byte EmulatorWidget::inputStatus(byte controller) const
@@ -3,15 +3,18 @@
 // Qt includes
 #include <QtGui/QColor>
 #include <QtGui/QImage>
-#include <QtGui/QPixmap>
 #include <QtWidgets/QWidget>
 
 // sukiNES includes
+#include <frametriplebuffer.h>
 #include <ppuio.h>
 #include <inputio.h>
+#include <ntscfilterpool.h>
+#include <pixelscalerpool.h>
 #include <platform_support.h>
 
 class QKeyEvent;
+class QPainter;
 class QPaintEvent;
 
 class EmulatorWidget : public QWidget, public sukiNES::PPUIO, public sukiNES::InputIO
@@ -25,10 +28,37 @@ public:
 
 	void clearScreen();
 
+	/**
+	 * @brief Frames rendered on the emulation thread, the newest one is shown
+	 *
+	 * ColorIndex frames while the NTSC filter is on, RGB32 frames otherwise.
+	 */
+	sukiNES::FrameTripleBuffer* frameTripleBuffer()
+	{
+		return _isNtscFilter ? &_colorIndexFrames : &_frames;
+	}
+
+	void setScaleFilter(sukiNES::ScaleFilter filter);
+
+	/**
+	 * @brief Show the frames through the NTSC composite filter instead of the scale filter
+	 *
+	 * Changes frameTripleBuffer(), the emulation must be given the new one. The
+	 * previous filter is shown until the first frame rendered for the new one.
+	 */
+	void setNtscFilter(bool value);
+
+	/**
+	 * @brief GUI thread time spent showing the last frame, scaling and painting
+	 */
+	qint64 presentationNanoseconds() const
+	{
+		return _presentationNanoseconds;
+	}
+
 public:
 	// PPUIO
-	virtual void putPixel(sint32 x, sint32 y, byte paletteIndex) override;
-	virtual void onVBlank() override;
+	virtual void onFrame(const sukiNES::FrameInfo& frameInfo) override;
 
 	// InputIO
 	virtual byte inputStatus(byte controller) const override;
@@ -42,10 +72,31 @@ protected:
 	virtual void keyReleaseEvent(QKeyEvent* event) override;
 
 private:
-	QImage _screenBuffer;
-	QPixmap _screenPixmap;
+	sukiNES::FrameTripleBuffer* _shownFrameTripleBuffer()
+	{
+		return _isNtscShown ? &_colorIndexFrames : &_frames;
+	}
+
+	void _resizePresentationBuffer();
+	void _drawFrame(QPainter& painter);
+	void _drawNtscFrame(QPainter& painter);
+
+private:
+	sukiNES::FrameTripleBuffer _frames;
+	sukiNES::FrameTripleBuffer _colorIndexFrames;
+	QImage _presentationBuffer;
+	// The presentation buffer does not hold the front frame scaled yet
+	bool _isPresentationStale;
+	bool _isScreenCleared;
+	// callRepaint() was called for a new frame since the last paint
+	bool _isFramePending;
+	// Frames are rendered for _isNtscFilter, the presentation buffer is set up for _isNtscShown
+	bool _isNtscFilter;
+	bool _isNtscShown;
+	qint64 _presentationNanoseconds;
 
-	QRgb _palette[64];
+	sukiNES::PixelScalerPool _scalerPool;
+	sukiNES::NtscFilterPool _ntscPool;
 
 	union
 	{
@@ -1,5 +0,0 @@
-#pragma once
-
-#include <QtGui/QColor>
-
-void getNESPalette(QRgb* palette, size_t paletteSize);
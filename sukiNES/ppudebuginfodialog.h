@@ -7,7 +7,7 @@
 
 namespace sukiNES
 {
-	class PPU;
+	struct PPUDebugState;
 }
 
 class QCloseEvent;
@@ -19,7 +19,7 @@ public:
 	~PPUDebugInfoDialog();
 
 public slots:
-	void updatePPUInfo(sukiNES::PPU* ppu);
+	void updatePPUInfo(const sukiNES::PPUDebugState& ppu);
 
 private:
 	Ui::PPUDebugInfoDialog _ui;
@@ -6,17 +6,12 @@
 #include <QtGui/QPixmap>
 
 // sukiNES includes
-#include <ppu.h>
-
-// Local includes
-#include "nespalette.h"
+#include <ppudebugstate.h>
 
 PPUVideoDialog::PPUVideoDialog(QWidget* parent)
 : QDialog(parent)
 {
 	_ui.setupUi(this);
-
-	getNESPalette(_palette, sizeof(_palette) / sizeof(QRgb));
 }
 
 PPUVideoDialog::~PPUVideoDialog()
@@ -24,18 +19,18 @@ PPUVideoDialog::~PPUVideoDialog()
 
 }
 
-void PPUVideoDialog::updatePPUInfo(sukiNES::PPU* ppu)
+void PPUVideoDialog::updatePPUInfo(const sukiNES::PPUDebugState& ppu)
 {
 	_updateMirroringType(ppu);
 	_updatePalette(ppu);
 	_updateNametable(ppu);
 }
 
-void PPUVideoDialog::_updateMirroringType(sukiNES::PPU* ppu)
+void PPUVideoDialog::_updateMirroringType(const sukiNES::PPUDebugState& ppu)
 {
 	const char* ppuMirroringName = nullptr;
 
-	switch(ppu->_nametableMirroring)
+	switch(ppu.nametableMirroring)
 	{
 	case sukiNES::PPU::NameTableMirroring::Horizontal:
 		ppuMirroringName = "Horizontal";
@@ -57,20 +52,22 @@ void PPUVideoDialog::_updateMirroringType(sukiNES::PPU* ppu)
 	_ui.labelMirroringType->setText(ppuMirroringName);
 }
 
-void PPUVideoDialog::_updatePalette(sukiNES::PPU* ppu)
+void PPUVideoDialog::_updatePalette(const sukiNES::PPUDebugState& ppu)
 {
 	QImage paletteViewBuffer(256, 32, QImage::Format_RGB32);
 
 	QPainter painter(&paletteViewBuffer);
 
+	const uint32* colors = ppu.colors;
+
 	int x = 0;
 	int y = 0;
 
 	for (uint32 paletteIndex = 0; paletteIndex < 32; ++paletteIndex)
 	{
-		byte paletteValue = ppu->_palette[paletteIndex];
+		byte paletteValue = ppu.palette[paletteIndex];
 
-		painter.fillRect(x, y, 16, 16, QColor(_palette[paletteValue]));
+		painter.fillRect(x, y, 16, 16, QColor(colors[sukiNES::RgbPalette::index(paletteValue, 0)]));
 		x += 16;
 		if (x >= 256)
 		{
@@ -82,7 +79,7 @@ void PPUVideoDialog::_updatePalette(sukiNES::PPU* ppu)
 	_ui.labelPaletteView->setPixmap(QPixmap::fromImage(paletteViewBuffer));
 }
 
-void PPUVideoDialog::_updateNametable(sukiNES::PPU* ppu)
+void PPUVideoDialog::_updateNametable(const sukiNES::PPUDebugState& ppu)
 {
 	static const uint32 AttributeSize = 64;
 	static const uint32 NametableWidthInTile = 32;
@@ -93,10 +90,7 @@ void PPUVideoDialog::_updateNametable(sukiNES::PPU* ppu)
 
 	QImage nametableBuffer(NametableWidth*2, NametableHeight*2, QImage::Format_RGB32);
 
-	// We are using _internalRead to fetch PPU data and it affects the
-	// read buffer. To make this function non-destruction of the PPU state,
-	// I create a copy of the current read buffer that I will restore after rendering the nametable
-	byte ppuReadBufferCopy = ppu->_readBuffer;
+	const uint32* colors = ppu.colors;
 
 	word nametableAddress = 0x2000;
 	word attributeAddress = 0x23C0;
@@ -118,7 +112,7 @@ void PPUVideoDialog::_updateNametable(sukiNES::PPU* ppu)
 		byte attributeTable[AttributeSize];
 		for (uint32 i = 0; i<sizeof(attributeTable)/sizeof(byte); ++i)
 		{
-			attributeTable[i] = ppu->_internalRead(attributeAddress);
+			attributeTable[i] = ppu.memory[attributeAddress];
 			attributeAddress++;
 		}
 
@@ -128,20 +122,20 @@ void PPUVideoDialog::_updateNametable(sukiNES::PPU* ppu)
 
 		for(uint32 nametableIndex = 0; nametableIndex<NametableSize; ++nametableIndex)
 		{
-			byte nametableEntry = ppu->_internalRead(nametableAddress);
+			byte nametableEntry = ppu.memory[nametableAddress];
 			byte attribute = attributeTable[(currentLineInTile/4)*8+(currentColumnInTile/4)];
 
 			for (sint32 y = 0; y < 8; ++y)
 			{
 				uint16 chrAddress = 0;
-				chrAddress = ((unsigned)ppu->_ppuControl.backgroundPatternTable) * 0x1000;
+				chrAddress = ((unsigned)ppu.ppuControl.backgroundPatternTable) * 0x1000;
 				chrAddress |= (nametableEntry * 16) + y;
 
-				byte lowPatternTable = ppu->_internalRead(chrAddress);
+				byte lowPatternTable = ppu.memory[chrAddress];
 
-				chrAddress = ((unsigned)ppu->_ppuControl.backgroundPatternTable) * 0x1000;
+				chrAddress = ((unsigned)ppu.ppuControl.backgroundPatternTable) * 0x1000;
 				chrAddress |= (nametableEntry * 16) + 8 + y;
-				byte highPatternTable = ppu->_internalRead(chrAddress);
+				byte highPatternTable = ppu.memory[chrAddress];
 
 				for (sint32 x = 0; x < 8; ++x)
 				{
@@ -160,7 +154,7 @@ void PPUVideoDialog::_updateNametable(sukiNES::PPU* ppu)
 						paletteIndex.raw = 0;
 					}
 
-					nametableBuffer.setPixel(((whichNametable%2)*NametableWidth)+realX, ((whichNametable/2)*NametableHeight)+realY, _palette[ppu->_palette[paletteIndex.raw]]);
+					nametableBuffer.setPixel(((whichNametable%2)*NametableWidth)+realX, ((whichNametable/2)*NametableHeight)+realY, colors[sukiNES::RgbPalette::index(ppu.palette[paletteIndex.raw], 0)]);
 				}
 			}
 
@@ -178,7 +172,5 @@ void PPUVideoDialog::_updateNametable(sukiNES::PPU* ppu)
 		attributeAddress += NametableSize;
 	}
 
-	ppu->_readBuffer = ppuReadBufferCopy;
-
 	_ui.labelNametableView->setPixmap(QPixmap::fromImage(nametableBuffer));
 }
@@ -6,7 +6,7 @@
 
 namespace sukiNES
 {
-	class PPU;
+	struct PPUDebugState;
 }
 
 class PPUVideoDialog : public QDialog
@@ -17,15 +17,13 @@ public:
 	~PPUVideoDialog();
 
 public slots:
-	void updatePPUInfo(sukiNES::PPU* ppu);
+	void updatePPUInfo(const sukiNES::PPUDebugState& ppu);
 
 private:
-	void _updateMirroringType(sukiNES::PPU* ppu);
-	void _updatePalette(sukiNES::PPU* ppu);
-	void _updateNametable(sukiNES::PPU* ppu);
+	void _updateMirroringType(const sukiNES::PPUDebugState& ppu);
+	void _updatePalette(const sukiNES::PPUDebugState& ppu);
+	void _updateNametable(const sukiNES::PPUDebugState& ppu);
 
 private:
 	Ui::PPUVideoDialog _ui;
-
-	QRgb _palette[64];
 };
\ No newline at end of file
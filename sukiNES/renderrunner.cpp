@@ -0,0 +1,48 @@
+#include "renderrunner.h"
+
+// STL includes
+#include <cstring>
+
+RenderRunner::RenderRunner(sukiNES::PPUWriteLog* writeLog, QObject* parent)
+: QThread(parent)
+, _writeLog(writeLog)
+{
+	_isThreadRunning.store(false);
+}
+
+void RenderRunner::setChrBank(const byte* chrBank)
+{
+	memcpy(_chrBank, chrBank, sizeof(_chrBank));
+	_ppu.mapChrBank(_chrBank);
+}
+
+void RenderRunner::startThread()
+{
+	_isThreadRunning.store(true);
+	start();
+}
+
+void RenderRunner::quitThread()
+{
+	_isThreadRunning.store(false);
+	_writeLog->wakeConsumer();
+	wait();
+}
+
+void RenderRunner::run()
+{
+	sukiNES::PPUWriteLog::Entry entry;
+
+	while(_isThreadRunning.load(std::memory_order_relaxed))
+	{
+		if (_writeLog->pop(entry))
+		{
+			_ppu.replay(entry);
+		}
+		else
+		{
+			// Caught up with the emulation thread, sleep until it logs a frame or quitThread()
+			_writeLog->waitForFrame();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+
+// Qt includes
+#include <QtCore/QThread>
+
+// sukiNES includes
+#include <ppu.h>
+#include <ppuwritelog.h>
+
+/**
+ * @brief Renders the frames of a timing-only PPU by replaying its write log
+ *
+ * Configure ppu() only while the thread is not running.
+ */
+class RenderRunner : public QThread
+{
+public:
+	RenderRunner(sukiNES::PPUWriteLog* writeLog, QObject* parent = nullptr);
+
+	sukiNES::PPU& ppu()
+	{
+		return _ppu;
+	}
+
+	/**
+	 * @brief Render from a copy of chrBank, the emulated PPU keeps writing to its own
+	 */
+	void setChrBank(const byte* chrBank);
+
+	void startThread();
+	void quitThread();
+
+protected:
+	virtual void run() override;
+
+private:
+	sukiNES::PPU _ppu;
+	sukiNES::PPUWriteLog* _writeLog;
+
+	byte _chrBank[SUKINES_KB(8)];
+
+	std::atomic<bool> _isThreadRunning;
+};
\ No newline at end of file
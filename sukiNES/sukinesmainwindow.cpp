@@ -2,11 +2,14 @@
 
 // Qt includes
 #include <QtWidgets/QAction>
+#include <QtWidgets/QActionGroup>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QFileDialog>
+#include <QtWidgets/QLabel>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QMessageBox>
+#include <QtWidgets/QStatusBar>
 
 // Local includes
 #include "cpuregisterdockwidget.h"
@@ -25,6 +28,7 @@ sukiNESMainWindow::sukiNESMainWindow(QWidget *parent)
 , _actionCpuRegister(nullptr)
 , _actionPPUDebugInfo(nullptr)
 , _actionPPUVideo(nullptr)
+, _frameRateLabel(nullptr)
 {
 	_emulatorRunner = new EmulatorRunner(this);
 
@@ -42,6 +46,8 @@ void sukiNESMainWindow::_init()
 	_initMenu();
 
 	_initCentralWidget();
+
+	_initStatusBar();
 }
 
 void sukiNESMainWindow::_initMenu()
@@ -53,6 +59,10 @@ void sukiNESMainWindow::_initMenu()
 	QObject::connect(fileLoadAction, &QAction::triggered, this, &sukiNESMainWindow::openROM);
 	fileMenu->addAction(fileLoadAction);
 
+	QAction *paletteLoadAction = new QAction(tr("Load Palette..."), this);
+	QObject::connect(paletteLoadAction, &QAction::triggered, this, &sukiNESMainWindow::openPalette);
+	fileMenu->addAction(paletteLoadAction);
+
 	fileMenu->addSeparator();
 
 	QAction *quitAction = new QAction(tr("Quit"), this);
@@ -94,13 +104,97 @@ void sukiNESMainWindow::_initMenu()
 	});
 	emulationMenu->addAction(resumeAction);
 
+	emulationMenu->addSeparator();
+
+	QMenu* speedMenu = emulationMenu->addMenu(tr("Speed"));
+	QActionGroup* speedGroup = new QActionGroup(this);
+
+	struct SpeedEntry
+	{
+		const char* name;
+		uint32 speed;
+	};
+
+	const SpeedEntry speeds[] =
+	{
+		{ QT_TR_NOOP("Normal"), 1 },
+		{ QT_TR_NOOP("2x"), 2 },
+		{ QT_TR_NOOP("4x"), 4 },
+		{ QT_TR_NOOP("8x"), 8 },
+		{ QT_TR_NOOP("Unlimited"), 0 }
+	};
+
+	for (const SpeedEntry& entry : speeds)
+	{
+		QAction* speedAction = new QAction(tr(entry.name), speedGroup);
+		speedAction->setCheckable(true);
+		speedAction->setChecked(entry.speed == 1);
+
+		uint32 speed = entry.speed;
+		QObject::connect(speedAction, &QAction::triggered, [this, speed] () {
+			_emulatorRunner->setSpeed(speed);
+		});
+		speedMenu->addAction(speedAction);
+	}
+
+	QAction* deferredRenderingAction = new QAction(tr("Render on a separate thread"), this);
+	deferredRenderingAction->setCheckable(true);
+	deferredRenderingAction->setStatusTip(tr("Takes effect at the next power on"));
+	QObject::connect(deferredRenderingAction, &QAction::toggled, [this] (bool isChecked) {
+		_emulatorRunner->setDeferredRendering(isChecked);
+	});
+	emulationMenu->addAction(deferredRenderingAction);
+
+	QMenu* videoMenu = menuBar()->addMenu(tr("Video"));
+	QActionGroup* scaleFilterGroup = new QActionGroup(this);
+
+	struct ScaleFilterEntry
+	{
+		const char* name;
+		sukiNES::ScaleFilter filter;
+	};
+
+	const ScaleFilterEntry scaleFilters[] =
+	{
+		{ QT_TR_NOOP("Nearest neighbour"), sukiNES::ScaleFilter::Nearest3x },
+		{ QT_TR_NOOP("Scale2x"), sukiNES::ScaleFilter::Scale2x },
+		{ QT_TR_NOOP("Scale3x"), sukiNES::ScaleFilter::Scale3x },
+		{ QT_TR_NOOP("xBR"), sukiNES::ScaleFilter::Xbr2x }
+	};
+
+	for (const ScaleFilterEntry& entry : scaleFilters)
+	{
+		QAction* scaleFilterAction = new QAction(tr(entry.name), scaleFilterGroup);
+		scaleFilterAction->setCheckable(true);
+		scaleFilterAction->setChecked(entry.filter == sukiNES::ScaleFilter::Nearest3x);
+
+		sukiNES::ScaleFilter filter = entry.filter;
+		QObject::connect(scaleFilterAction, &QAction::triggered, [this, filter] () {
+			_emulatorWidget->setScaleFilter(filter);
+		});
+		videoMenu->addAction(scaleFilterAction);
+	}
+
+	videoMenu->addSeparator();
+
+	QAction* ntscFilterAction = new QAction(tr("NTSC filter"), this);
+	ntscFilterAction->setCheckable(true);
+	ntscFilterAction->setStatusTip(tr("Composite video colours and artifacts, replaces the scale filter"));
+	QObject::connect(ntscFilterAction, &QAction::toggled, [this, scaleFilterGroup] (bool isChecked) {
+		scaleFilterGroup->setEnabled(!isChecked);
+		_emulatorWidget->setNtscFilter(isChecked);
+		_emulatorRunner->setFrameTripleBuffer(_emulatorWidget->frameTripleBuffer());
+	});
+	videoMenu->addAction(ntscFilterAction);
+
 	QMenu* debugMenu = menuBar()->addMenu(tr("Debug"));
 
 	QAction* debugStepAction = new QAction(tr("Step"), this);
 	debugStepAction->setShortcut(Qt::Key_F10);
 	QObject::connect(debugStepAction, &QAction::triggered, [this] () {
 		_emulatorRunner->doCommand(EmulatorRunner::Command::Step);
-		_emulatorWidget->callRepaint();
+		// A step rarely completes a frame, a repaint finding none is no duplicated frame
+		_emulatorWidget->update();
 	});
 	debugMenu->addAction(debugStepAction);
 
@@ -133,11 +227,22 @@ void sukiNESMainWindow::_initCentralWidget()
 	_emulatorWidget = new EmulatorWidget(this);
 
 	_emulatorRunner->setPPUIO(_emulatorWidget);
+	_emulatorRunner->setFrameTripleBuffer(_emulatorWidget->frameTripleBuffer());
 	_emulatorRunner->setInputIO(_emulatorWidget);
 
+	QObject::connect(_emulatorRunner, &EmulatorRunner::romLoaded, this, &sukiNESMainWindow::romLoaded);
+
 	setCentralWidget(_emulatorWidget);
 }
 
+void sukiNESMainWindow::_initStatusBar()
+{
+	_frameRateLabel = new QLabel(this);
+	statusBar()->addPermanentWidget(_frameRateLabel);
+
+	QObject::connect(_emulatorRunner, &EmulatorRunner::frameRateUpdated, this, &sukiNESMainWindow::updateFrameRate);
+}
+
 void sukiNESMainWindow::closeEvent(QCloseEvent* event)
 {
 	if (_emulatorRunner->isRunning())
@@ -158,34 +263,31 @@ void sukiNESMainWindow::openROM()
 	QString romFilename = QFileDialog::getOpenFileName(this, tr("Open NES ROM"), QString(), tr("NES file (*.nes)"));
 	if(!romFilename.isEmpty())
 	{
-		if (_emulatorRunner->loadRom(romFilename))
-		{
-			_emulatorWidget->clearScreen();
-
-			QFileInfo fileInfo(romFilename);
-
-			setWindowTitle(tr("sukiNES - %1").arg(fileInfo.fileName()));
-
-			_emulatorRunner->doCommand(EmulatorRunner::Command::PowerOn);
-			if (!_emulatorRunner->isRunning())
-			{
-				_emulatorRunner->start();
-			}
-		}
-		else
-		{
-			if (wasEmulationRunning)
-			{
-				_emulatorRunner->doCommand(EmulatorRunner::Command::ResumeEmulation);
-			}
-		}
+		_emulatorRunner->loadRom(romFilename);
 	}
-	else
+
+	// Queued after the load, the loaded game is already running and a failed load goes back to the previous one
+	if (wasEmulationRunning)
+	{
+		_emulatorRunner->doCommand(EmulatorRunner::Command::ResumeEmulation);
+	}
+}
+
+void sukiNESMainWindow::romLoaded(const QString& romFilename)
+{
+	_emulatorWidget->clearScreen();
+
+	QFileInfo fileInfo(romFilename);
+
+	setWindowTitle(tr("sukiNES - %1").arg(fileInfo.fileName()));
+}
+
+void sukiNESMainWindow::openPalette()
+{
+	QString paletteFilename = QFileDialog::getOpenFileName(this, tr("Load NES palette"), QString(), tr("Palette file (*.pal)"));
+	if (!paletteFilename.isEmpty() && !_emulatorRunner->loadPalette(paletteFilename))
 	{
-		if (wasEmulationRunning)
-		{
-			_emulatorRunner->doCommand(EmulatorRunner::Command::ResumeEmulation);
-		}
+		QMessageBox::warning(this, tr("sukiNES"), tr("Could not load palette %1").arg(paletteFilename));
 	}
 }
 
@@ -194,6 +296,22 @@ void sukiNESMainWindow::about()
 	QMessageBox::about(this, tr("sukiNES"), tr("sukiNES 0.1\nBy Michael Larouche <michael.larouche@gmail.com>\n\nhttps://github.com/mlarouche/sukiNES"));
 }
 
+void sukiNESMainWindow::updateFrameRate(double framesPerSecond)
+{
+	const sukiNES::FrameTripleBuffer* frames = _emulatorWidget->frameTripleBuffer();
+	_frameRateLabel->setText(tr("%1 fps, %2 dropped, %3 repeated, %4 ms to present")
+		.arg(framesPerSecond, 0, 'f', 1)
+		.arg(frames->droppedFrameCount())
+		.arg(frames->duplicatedFrameCount())
+		.arg(_emulatorWidget->presentationNanoseconds() / 1000000.0, 0, 'f', 2));
+}
+
+void sukiNESMainWindow::_updateDebugSnapshots()
+{
+	// The emulation thread only copies its state while a debug view shows it
+	_emulatorRunner->setDebugSnapshotEnabled(_cpuRegisterDockWidget || _ppuDebugInfoDialog || _ppuVideoDialog);
+}
+
 void sukiNESMainWindow::toggleCpuRegisterDockWidget(bool isChecked)
 {
 	if (!_cpuRegisterDockWidget)
@@ -204,7 +322,9 @@ void sukiNESMainWindow::toggleCpuRegisterDockWidget(bool isChecked)
 			_actionCpuRegister->setChecked(false);
 			_cpuRegisterDockWidget->deleteLater();
 			_cpuRegisterDockWidget = nullptr;
+			_updateDebugSnapshots();
 		} );
+		_updateDebugSnapshots();
 	}
 
 	if (isChecked)
@@ -228,7 +348,9 @@ void sukiNESMainWindow::togglePPUDebugInfoDialog(bool isChecked)
 			_actionPPUDebugInfo->setChecked(false);
 			_ppuDebugInfoDialog->deleteLater();
 			_ppuDebugInfoDialog = nullptr;
+			_updateDebugSnapshots();
 		} );
+		_updateDebugSnapshots();
 	}
 
 	if (isChecked)
@@ -252,7 +374,9 @@ void sukiNESMainWindow::togglePPUVideoDialog(bool isChecked)
 			_actionPPUVideo->setChecked(false);
 			_ppuVideoDialog->deleteLater();
 			_ppuVideoDialog = nullptr;
+			_updateDebugSnapshots();
 		} );
+		_updateDebugSnapshots();
 	}
 
 	if (isChecked)
@@ -10,6 +10,7 @@ class PPUVideoDialog;
 
 class QAction;
 class QCloseEvent;
+class QLabel;
 
 class sukiNESMainWindow : public QMainWindow
 {
@@ -23,15 +24,20 @@ protected:
 
 private slots:
 	void openROM();
+	void romLoaded(const QString& romFilename);
+	void openPalette();
 	void about();
 	void toggleCpuRegisterDockWidget(bool isChecked);
 	void togglePPUDebugInfoDialog(bool isChecked);
 	void togglePPUVideoDialog(bool isChecked);
+	void updateFrameRate(double framesPerSecond);
 
 private:
 	void _init();
 	void _initMenu();
 	void _initCentralWidget();
+	void _initStatusBar();
+	void _updateDebugSnapshots();
 
 private:
 	CpuRegisterDockWidget* _cpuRegisterDockWidget;
@@ -43,5 +49,7 @@ private:
 	QAction* _actionCpuRegister;
 	QAction* _actionPPUDebugInfo;
 	QAction* _actionPPUVideo;
+
+	QLabel* _frameRateLabel;
 };
 
@@ -0,0 +1,29 @@
+#include "benchmark.h"
+
+// STL includes
+#include <cstdio>
+
+// Local includes
+#include "benchmarkrunner.h"
+
+namespace Benchmark
+{
+	BenchmarkRegister::BenchmarkRegister(BenchmarkRegister::BenchmarkCreatorFunctionPointer benchmarkCreatorFunction)
+	{
+		BenchmarkRunner::self().registerBenchmark(benchmarkCreatorFunction);
+	}
+
+	Benchmark::Benchmark()
+	: _benchmarkName(nullptr)
+	{
+	}
+
+	Benchmark::~Benchmark()
+	{
+	}
+
+	void Benchmark::_report(const char* label, double value, const char* unit)
+	{
+		fprintf(stdout, "%s/%s: %.2f %s\n", _benchmarkName, label, value, unit);
+	}
+}
\ No newline at end of file
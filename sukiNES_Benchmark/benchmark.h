@@ -0,0 +1,68 @@
+#pragma once
+
+// STL includes
+#include <chrono>
+#include <functional>
+
+#define BENCHMARK_REGISTER(Class, BenchmarkName) \
+	extern "C" Benchmark::Benchmark* __create_Benchmark_##Class##__() \
+	{ \
+		auto *benchmark = new Class; \
+		benchmark->setBenchmarkName(#BenchmarkName); \
+		return benchmark; \
+	} \
+	Benchmark::BenchmarkRegister __register_Benchmark_##Class(__create_Benchmark_##Class##__); \
+
+namespace Benchmark
+{
+	class Stopwatch
+	{
+	public:
+		Stopwatch()
+		: _start(std::chrono::high_resolution_clock::now())
+		{
+		}
+
+		double elapsedNanoseconds() const
+		{
+			auto elapsed = std::chrono::high_resolution_clock::now() - _start;
+			return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+		}
+
+	private:
+		std::chrono::high_resolution_clock::time_point _start;
+	};
+
+	class Benchmark
+	{
+	public:
+		Benchmark();
+		virtual ~Benchmark();
+
+		virtual void run() = 0;
+
+		const char* benchmarkName() const
+		{
+			return _benchmarkName;
+		}
+
+		void setBenchmarkName(const char* benchmarkName)
+		{
+			_benchmarkName = benchmarkName;
+		}
+
+	protected:
+		void _report(const char* label, double value, const char* unit);
+
+	private:
+		const char* _benchmarkName;
+	};
+
+	class BenchmarkRegister
+	{
+	public:
+		typedef std::function<Benchmark*(void)> BenchmarkCreatorFunctionPointer;
+
+		BenchmarkRegister(BenchmarkCreatorFunctionPointer benchmarkCreatorFunction);
+	};
+}
\ No newline at end of file
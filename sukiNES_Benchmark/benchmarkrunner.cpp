@@ -0,0 +1,59 @@
+#include "benchmarkrunner.h"
+
+// STL includes
+#include <cstdio>
+#include <cstring>
+
+// Local includes
+#include "benchmark.h"
+
+namespace Benchmark
+{
+	static BenchmarkRunner* _instance = nullptr;
+
+	BenchmarkRunner::BenchmarkRunner()
+	{
+	}
+
+	BenchmarkRunner& BenchmarkRunner::self()
+	{
+		if (!_instance)
+		{
+			_instance = new BenchmarkRunner;
+		}
+
+		return *_instance;
+	}
+
+	void BenchmarkRunner::registerBenchmark(BenchmarkRunner::BenchmarkCreatorFunctionPointer benchmarkCreatorFunction)
+	{
+		_benchmarks.push_back(benchmarkCreatorFunction);
+	}
+
+	int BenchmarkRunner::run(int argc, char** argv)
+	{
+		return BenchmarkRunner::self()._internalRun(argc, argv);
+	}
+
+	int BenchmarkRunner::_internalRun(int argc, char** argv)
+	{
+		for(auto& benchmarkCreatorFunction : _benchmarks)
+		{
+			auto benchmark = benchmarkCreatorFunction();
+			if (benchmark)
+			{
+				if (argc > 1 && strcmp(argv[1], benchmark->benchmarkName()) != 0)
+				{
+					delete benchmark;
+					continue;
+				}
+
+				benchmark->run();
+
+				delete benchmark;
+			}
+		}
+
+		return 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+// STL includes
+#include <functional>
+#include <vector>
+
+namespace Benchmark
+{
+	class Benchmark;
+
+	class BenchmarkRunner
+	{
+	public:
+		typedef std::function<Benchmark*(void)> BenchmarkCreatorFunctionPointer;
+
+		static BenchmarkRunner& self();
+
+		void registerBenchmark(BenchmarkCreatorFunctionPointer benchmarkCreator);
+
+		static int run(int argc, char** argv);
+
+	private:
+		BenchmarkRunner();
+		BenchmarkRunner(const BenchmarkRunner& copy);
+		BenchmarkRunner& operator=(const BenchmarkRunner& other);
+
+		int _internalRun(int argc, char** argv);
+
+	private:
+		std::vector<BenchmarkCreatorFunctionPointer> _benchmarks;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+// STL includes
+#include <cstdio>
+#include <cstdlib>
+
+// sukiNES includes
+#include <colorconversion.h>
+#include <cpufeatures.h>
+#include <rgbpalette.h>
+
+// Local includes
+#include "benchmark.h"
+
+using namespace sukiNES;
+
+static const uint32 Iterations = 2000;
+static const uint32 FramePixelCount = FrameWidth * FrameHeight;
+
+class ColorConversionBenchmark : public Benchmark::Benchmark
+{
+public:
+	ColorConversionBenchmark()
+	: Benchmark::Benchmark()
+	{
+		srand(0);
+
+		for (uint32 pixel = 0; pixel < FramePixelCount; ++pixel)
+		{
+			_indices[pixel] = static_cast<uint16>(rand() & (RgbPalette::EntryCount - 1));
+		}
+	}
+
+	virtual void run()
+	{
+		_measureFormats("scalar", convertColorIndicesScalar);
+
+#ifdef SUKINES_ARCH_X86
+		if (hostCpuFeatures().avx2)
+		{
+			_measureFormats("avx2", convertColorIndicesAVX2);
+		}
+#endif
+	}
+
+private:
+	void _measureFormats(const char* kernel, ConvertColorIndicesFunction convertColorIndices)
+	{
+		char label[64];
+
+		sprintf(label, "%s rgb32", kernel);
+		_measure(label, convertColorIndices, PixelFormat::RGB32);
+
+		sprintf(label, "%s rgb565", kernel);
+		_measure(label, convertColorIndices, PixelFormat::RGB565);
+
+		sprintf(label, "%s grayscale", kernel);
+		_measure(label, convertColorIndices, PixelFormat::Grayscale);
+	}
+
+	void _measure(const char* label, ConvertColorIndicesFunction convertColorIndices, PixelFormat format)
+	{
+		uint32 checksum = 0;
+
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 iteration = 0; iteration < Iterations; ++iteration)
+		{
+			convertColorIndices(_indices, FramePixelCount, _palette, format, _output);
+			checksum += _output[iteration % sizeof(_output)];
+		}
+
+		double nanoseconds = stopwatch.elapsedNanoseconds();
+
+		// Keep the results alive so the calls are not optimized away
+		if (checksum == 1)
+		{
+			fprintf(stdout, "\n");
+		}
+
+		_report(label, nanoseconds / Iterations / 1000.0, "us/frame");
+	}
+
+private:
+	RgbPalette _palette;
+	uint16 _indices[FramePixelCount];
+	byte _output[FramePixelCount * sizeof(uint32)];
+};
+
+BENCHMARK_REGISTER(ColorConversionBenchmark, color_conversion);
\ No newline at end of file
@@ -0,0 +1,108 @@
+// STL includes
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// sukiNES includes
+#include <spscring.h>
+
+// Local includes
+#include "benchmark.h"
+
+using namespace sukiNES;
+
+static const uint32 PollCount = 20000000;
+static const uint32 CommandCount = 2000000;
+
+// What the emulation thread checks between instructions, nearly always empty
+class CommandChannelBenchmark : public Benchmark::Benchmark
+{
+public:
+	CommandChannelBenchmark()
+	: Benchmark::Benchmark()
+	{
+	}
+
+	virtual void run()
+	{
+		_measureLockedPoll();
+		_measureRingPoll();
+		_measureRingTransfer();
+	}
+
+private:
+	// Same work as a QMutex around a QQueue, without pulling Qt in
+	void _measureLockedPoll()
+	{
+		std::mutex mutex;
+		std::deque<uint32> commands;
+
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 poll = 0; poll < PollCount; ++poll)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			while (!commands.empty())
+			{
+				commands.pop_front();
+			}
+		}
+
+		double nanoseconds = stopwatch.elapsedNanoseconds();
+		_report("mutex and queue, empty poll", nanoseconds / PollCount, "ns/poll");
+	}
+
+	void _measureRingPoll()
+	{
+		SpscRing<uint32, 64> commands;
+		uint32 command = 0;
+
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 poll = 0; poll < PollCount; ++poll)
+		{
+			while (commands.pop(command))
+			{
+			}
+		}
+
+		double nanoseconds = stopwatch.elapsedNanoseconds();
+		_report("spsc ring, empty poll", nanoseconds / PollCount, "ns/poll");
+	}
+
+	// Producer and consumer on two threads
+	void _measureRingTransfer()
+	{
+		SpscRing<uint32, 64> commands;
+
+		::Benchmark::Stopwatch stopwatch;
+		std::thread producer([&commands] () {
+			for (uint32 command = 0; command < CommandCount; ++command)
+			{
+				while (!commands.push(command))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+
+		uint32 received = 0;
+		uint32 command = 0;
+		while (received < CommandCount)
+		{
+			if (commands.pop(command))
+			{
+				++received;
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+		producer.join();
+
+		double nanoseconds = stopwatch.elapsedNanoseconds();
+		_report("spsc ring, transfer between threads", nanoseconds / CommandCount, "ns/command");
+		_report("spsc ring, transfer between threads, total", nanoseconds / 1e6, "ms");
+	}
+};
+
+BENCHMARK_REGISTER(CommandChannelBenchmark, command_channel);
\ No newline at end of file
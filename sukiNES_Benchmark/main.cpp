@@ -0,0 +1,18 @@
+// Local includes
+#include "benchmarkrunner.h"
+
+#ifdef SUKINES_PLATFORM_WINDOWS
+void showpause()
+{
+	system("pause");
+}
+#endif
+
+int main(int argc, char** argv)
+{
+#ifdef SUKINES_PLATFORM_WINDOWS
+	atexit(showpause);
+#endif
+
+	return Benchmark::BenchmarkRunner::run(argc, argv);
+}
\ No newline at end of file
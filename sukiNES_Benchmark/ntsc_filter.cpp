@@ -0,0 +1,104 @@
+// STL includes
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// sukiNES includes
+#include <cpufeatures.h>
+#include <ntscfilter.h>
+#include <ntscfilterpool.h>
+
+// Local includes
+#include "benchmark.h"
+
+using namespace sukiNES;
+
+static const uint32 Frames = 300;
+
+class NtscFilterBenchmark : public Benchmark::Benchmark
+{
+public:
+	NtscFilterBenchmark()
+	: Benchmark::Benchmark()
+	, _output(NtscOutputWidth * FrameHeight)
+	{
+		srand(0);
+
+		// Runs of a few colours, like a game picture
+		for (uint32 y = 0; y < FrameHeight; ++y)
+		{
+			for (uint32 x = 0; x < FrameWidth; ++x)
+			{
+				_frame[y][x] = (x % 8 == 0 || rand() % 4 == 0) ? static_cast<uint16>(rand() & 0x3F) : _frame[y][x > 0 ? x - 1 : 0];
+			}
+		}
+	}
+
+	virtual void run()
+	{
+		_measure("scalar", filterNtscScanlineScalar);
+
+#ifdef SUKINES_ARCH_X86
+		const CpuFeatures& features = hostCpuFeatures();
+
+		if (features.sse2)
+		{
+			_measure("sse2", filterNtscScanlineSSE2);
+		}
+
+		if (features.avx2)
+		{
+			_measure("avx2", filterNtscScanlineAVX2);
+		}
+#endif
+
+		_measurePool();
+	}
+
+private:
+	void _measure(const char* label, FilterNtscScanlineFunction filterScanline)
+	{
+		const NtscKernel* pixelKernels[FrameWidth + NtscKernelRadius * 2];
+
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 frame = 0; frame < Frames; ++frame)
+		{
+			for (uint32 y = 0; y < FrameHeight; ++y)
+			{
+				_filter.scanlineKernels(_frame[y], (frame + y) % NtscPhaseCount, pixelKernels);
+				filterScanline(pixelKernels, &_output[y * NtscOutputWidth]);
+			}
+		}
+
+		double seconds = stopwatch.elapsedNanoseconds() / 1e9;
+		_report(label, Frames / seconds, "fps");
+	}
+
+	void _measurePool()
+	{
+		NtscFilterPool pool;
+		pool.setDestination(FrameBuffer(reinterpret_cast<byte*>(_output.data()), NtscOutputWidth * sizeof(uint32), PixelFormat::RGB32));
+
+		FrameBuffer source(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint16), PixelFormat::ColorIndex);
+
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 frame = 0; frame < Frames; ++frame)
+		{
+			pool.submit(source, frame % NtscPhaseCount);
+			pool.wait();
+		}
+
+		double seconds = stopwatch.elapsedNanoseconds() / 1e9;
+
+		char label[64];
+		sprintf(label, "pool, %u threads", pool.threadCount());
+		_report(label, Frames / seconds, "fps");
+	}
+
+private:
+	NtscFilter _filter;
+	uint16 _frame[FrameHeight][FrameWidth];
+	std::vector<uint32> _output;
+};
+
+BENCHMARK_REGISTER(NtscFilterBenchmark, ntsc_filter);
\ No newline at end of file
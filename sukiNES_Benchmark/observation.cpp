@@ -0,0 +1,70 @@
+// STL includes
+#include <cstdlib>
+
+// sukiNES includes
+#include <observation.h>
+#include <rgbpalette.h>
+
+// Local includes
+#include "benchmark.h"
+
+using namespace sukiNES;
+
+static const uint32 Iterations = 2000;
+static const uint32 StackSize = 4;
+
+class ObservationBenchmark : public Benchmark::Benchmark
+{
+public:
+	ObservationBenchmark()
+	: Benchmark::Benchmark()
+	{
+		srand(0);
+
+		for (uint32 y = 0; y < FrameHeight; ++y)
+		{
+			for (uint32 x = 0; x < FrameWidth; ++x)
+			{
+				_frame[y][x] = static_cast<uint16>(rand() & (RgbPalette::EntryCount - 1));
+			}
+		}
+	}
+
+	virtual void run()
+	{
+		ObservationSettings settings;
+		settings.stackSize = StackSize;
+		_measure("area average 84x84", settings);
+
+		settings.filter = DownsampleFilter::Nearest;
+		_measure("nearest 84x84", settings);
+
+		settings.format = PixelFormat::PaletteIndex;
+		_measure("nearest palette index 84x84", settings);
+	}
+
+private:
+	void _measure(const char* label, const ObservationSettings& settings)
+	{
+		FrameBuffer frame(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint16), PixelFormat::ColorIndex);
+		ObservationStack stack;
+		stack.setup(settings, _output);
+
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 iteration = 0; iteration < Iterations; ++iteration)
+		{
+			stack.addFrame(frame, _palette);
+		}
+
+		double nanoseconds = stopwatch.elapsedNanoseconds();
+
+		_report(label, nanoseconds / Iterations / 1000.0, "us/frame");
+	}
+
+private:
+	RgbPalette _palette;
+	uint16 _frame[FrameHeight][FrameWidth];
+	byte _output[FrameWidth * FrameHeight * StackSize];
+};
+
+BENCHMARK_REGISTER(ObservationBenchmark, observation);
\ No newline at end of file
@@ -0,0 +1,122 @@
+// STL includes
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// sukiNES includes
+#include <pixelscaler.h>
+#include <pixelscalerpool.h>
+
+// Local includes
+#include "benchmark.h"
+
+using namespace sukiNES;
+
+static const uint32 Frames = 300;
+static const uint32 FilterCount = 5;
+
+static const ScaleFilter Filters[FilterCount] =
+{
+	ScaleFilter::Nearest2x,
+	ScaleFilter::Nearest3x,
+	ScaleFilter::Scale2x,
+	ScaleFilter::Scale3x,
+	ScaleFilter::Xbr2x
+};
+
+static const char* const FilterNames[FilterCount] =
+{
+	"nearest 2x",
+	"nearest 3x",
+	"scale2x",
+	"scale3x",
+	"xbr 2x"
+};
+
+class PixelScalerBenchmark : public Benchmark::Benchmark
+{
+public:
+	PixelScalerBenchmark()
+	: Benchmark::Benchmark()
+	, _output(FrameWidth * FrameHeight * 9)
+	{
+		srand(0);
+
+		// Runs of a few colours, like a game picture
+		for (uint32 y = 0; y < FrameHeight; ++y)
+		{
+			for (uint32 x = 0; x < FrameWidth; ++x)
+			{
+				bool isNewRun = x % 8 == 0 || rand() % 4 == 0;
+				_frame[y][x] = isNewRun ? 0xFF000000 | (rand() % 4) * 0x405060 : _frame[y][x > 0 ? x - 1 : 0];
+			}
+		}
+	}
+
+	virtual void run()
+	{
+		for (uint32 whichFilter = 0; whichFilter < FilterCount; ++whichFilter)
+		{
+			_measure(whichFilter, false);
+			_measure(whichFilter, true);
+			_measurePool(whichFilter);
+		}
+	}
+
+private:
+	FrameBuffer _source()
+	{
+		return FrameBuffer(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint32), PixelFormat::RGB32);
+	}
+
+	FrameBuffer _destination(ScaleFilter filter)
+	{
+		return FrameBuffer(reinterpret_cast<byte*>(_output.data()), FrameWidth * PixelScaler::scaleFactor(filter) * sizeof(uint32), PixelFormat::RGB32);
+	}
+
+	void _measure(uint32 whichFilter, bool allowSimd)
+	{
+		PixelScaler scaler;
+		scaler.setFilter(Filters[whichFilter], allowSimd);
+		FrameBuffer destination = _destination(Filters[whichFilter]);
+
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 frame = 0; frame < Frames; ++frame)
+		{
+			scaler.prepare(_source());
+			scaler.scale(destination);
+		}
+
+		double seconds = stopwatch.elapsedNanoseconds() / 1e9;
+
+		char label[64];
+		sprintf(label, "%s, %s", FilterNames[whichFilter], allowSimd ? "simd" : "scalar");
+		_report(label, Frames / seconds, "fps");
+	}
+
+	void _measurePool(uint32 whichFilter)
+	{
+		PixelScalerPool pool;
+		pool.setFilter(Filters[whichFilter]);
+		pool.setDestination(_destination(Filters[whichFilter]));
+
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 frame = 0; frame < Frames; ++frame)
+		{
+			pool.submit(_source());
+			pool.wait();
+		}
+
+		double seconds = stopwatch.elapsedNanoseconds() / 1e9;
+
+		char label[64];
+		sprintf(label, "%s, pool, %u threads", FilterNames[whichFilter], pool.threadCount());
+		_report(label, Frames / seconds, "fps");
+	}
+
+private:
+	uint32 _frame[FrameHeight][FrameWidth];
+	std::vector<uint32> _output;
+};
+
+BENCHMARK_REGISTER(PixelScalerBenchmark, pixel_scaler);
\ No newline at end of file
@@ -0,0 +1,52 @@
+// sukiNES includes
+#include <ppu.h>
+
+// Local includes
+#include "benchmark.h"
+
+using namespace sukiNES;
+
+static const uint32 Frames = 200;
+
+// 262 scanlines of 341 dots, rendering is disabled so no dot is skipped
+static const uint32 DotsPerFrame = 262 * 341;
+
+class PpuIdleFrameBenchmark : public Benchmark::Benchmark
+{
+public:
+	PpuIdleFrameBenchmark()
+	: Benchmark::Benchmark()
+	{
+	}
+
+	virtual void run()
+	{
+		// PPUMASK is 0 at power on: the PPU only draws the backdrop colour
+		_ppu.powerOn();
+		{
+			::Benchmark::Stopwatch stopwatch;
+			for (uint32 dot = 0; dot < Frames * DotsPerFrame; ++dot)
+			{
+				_ppu.tick();
+			}
+
+			_report("tick", stopwatch.elapsedNanoseconds() / Frames, "ns/frame");
+		}
+
+		_ppu.powerOn();
+		{
+			::Benchmark::Stopwatch stopwatch;
+			for (uint32 frame = 0; frame < Frames; ++frame)
+			{
+				_ppu.run(DotsPerFrame);
+			}
+
+			_report("run", stopwatch.elapsedNanoseconds() / Frames, "ns/frame");
+		}
+	}
+
+private:
+	PPU _ppu;
+};
+
+BENCHMARK_REGISTER(PpuIdleFrameBenchmark, ppu_idle_frame);
\ No newline at end of file
@@ -0,0 +1,73 @@
+// STL includes
+#include <cstdlib>
+
+// sukiNES includes
+#include <ppu.h>
+
+// Local includes
+#include "benchmark.h"
+
+using namespace sukiNES;
+
+static const uint32 Frames = 60;
+static const uint32 DotsPerFrame = 262 * 341;
+
+class PpuRenderingFrameBenchmark : public Benchmark::Benchmark
+{
+public:
+	PpuRenderingFrameBenchmark()
+	: Benchmark::Benchmark()
+	{
+		srand(0);
+
+		for (uint32 index = 0; index < sizeof(_chr); ++index)
+		{
+			_chr[index] = static_cast<byte>(rand());
+		}
+
+		_ppu.mapChrBank(_chr);
+		_ppu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint32), PixelFormat::RGB32));
+
+		// Random nametables and sprites, background and sprites shown
+		_ppu.write(0x2006, 0x20);
+		_ppu.write(0x2006, 0x00);
+		for (uint32 index = 0; index < 0x800; ++index)
+		{
+			_ppu.write(0x2007, static_cast<byte>(rand()));
+		}
+
+		for (uint32 index = 0; index < 256; ++index)
+		{
+			_ppu.write(0x2004, static_cast<byte>(rand()));
+		}
+
+		_ppu.write(0x2001, 0x1E);
+	}
+
+	virtual void run()
+	{
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 frame = 0; frame < Frames; ++frame)
+		{
+			// Keep every frame different so none is reused
+			_ppu.write(0x2005, static_cast<byte>(frame));
+			_ppu.write(0x2005, 0);
+
+			for (uint32 dot = 0; dot < DotsPerFrame; ++dot)
+			{
+				_ppu.tick();
+			}
+		}
+
+		double seconds = stopwatch.elapsedNanoseconds() / 1e9;
+
+		_report("tick", Frames * DotsPerFrame / seconds / 1e6, "Mdots/s");
+	}
+
+private:
+	byte _chr[SUKINES_KB(8)];
+	PPU _ppu;
+	uint32 _frame[FrameHeight][FrameWidth];
+};
+
+BENCHMARK_REGISTER(PpuRenderingFrameBenchmark, ppu_rendering_frame);
\ No newline at end of file
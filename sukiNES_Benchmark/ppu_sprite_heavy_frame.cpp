@@ -0,0 +1,84 @@
+// STL includes
+#include <cstdlib>
+
+// sukiNES includes
+#include <ppu.h>
+
+// Local includes
+#include "benchmark.h"
+
+using namespace sukiNES;
+
+static const uint32 Frames = 60;
+static const uint32 DotsPerFrame = 262 * 341;
+static const uint32 SpritesPerBand = 9;
+static const uint32 BandHeight = 32;
+
+class PpuSpriteHeavyFrameBenchmark : public Benchmark::Benchmark
+{
+public:
+	PpuSpriteHeavyFrameBenchmark()
+	: Benchmark::Benchmark()
+	{
+		srand(0);
+
+		for (uint32 index = 0; index < sizeof(_chr); ++index)
+		{
+			_chr[index] = static_cast<byte>(rand());
+		}
+
+		for (uint32 index = 0; index < sizeof(_oam); ++index)
+		{
+			_oam[index] = static_cast<byte>(rand());
+		}
+
+		_ppu.mapChrBank(_chr);
+		_ppu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint32), PixelFormat::RGB32));
+
+		_ppu.write(0x2006, 0x20);
+		_ppu.write(0x2006, 0x00);
+		for (uint32 index = 0; index < 0x800; ++index)
+		{
+			_ppu.write(0x2007, static_cast<byte>(rand()));
+		}
+
+		// 8x16 sprites, background and sprites shown
+		_ppu.write(0x2000, 0x20);
+		_ppu.write(0x2001, 0x1E);
+	}
+
+	virtual void run()
+	{
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 frame = 0; frame < Frames; ++frame)
+		{
+			// Bands of 9 sprites, so that 8 are drawn and the overflow flag is set,
+			// moving every frame like a game doing OAM DMA in vblank
+			_ppu.write(0x2003, 0);
+			for (uint32 sprite = 0; sprite < 64; ++sprite)
+			{
+				_ppu.write(0x2004, static_cast<byte>((sprite / SpritesPerBand) * BandHeight + frame % 16));
+				_ppu.write(0x2004, _oam[sprite * 4 + 1]);
+				_ppu.write(0x2004, _oam[sprite * 4 + 2]);
+				_ppu.write(0x2004, static_cast<byte>(_oam[sprite * 4 + 3] + frame));
+			}
+
+			for (uint32 dot = 0; dot < DotsPerFrame; ++dot)
+			{
+				_ppu.tick();
+			}
+		}
+
+		double seconds = stopwatch.elapsedNanoseconds() / 1e9;
+
+		_report("tick", Frames * DotsPerFrame / seconds / 1e6, "Mdots/s");
+	}
+
+private:
+	byte _chr[SUKINES_KB(8)];
+	byte _oam[256];
+	PPU _ppu;
+	uint32 _frame[FrameHeight][FrameWidth];
+};
+
+BENCHMARK_REGISTER(PpuSpriteHeavyFrameBenchmark, ppu_sprite_heavy_frame);
\ No newline at end of file
@@ -0,0 +1,93 @@
+// STL includes
+#include <cstdio>
+#include <cstdlib>
+
+// sukiNES includes
+#include <cpufeatures.h>
+#include <scanlinecompositor.h>
+
+// Local includes
+#include "benchmark.h"
+
+using namespace sukiNES;
+
+static const uint32 Iterations = 200000;
+
+// Show background and sprites, including the leftmost 8 pixels
+static const byte RenderingPpuMask = 0x1E;
+
+class ScanlineCompositorBenchmark : public Benchmark::Benchmark
+{
+public:
+	ScanlineCompositorBenchmark()
+	: Benchmark::Benchmark()
+	{
+		srand(0);
+
+		for (uint32 index = 0; index < 32; ++index)
+		{
+			_palette[index] = static_cast<byte>(rand() & 0x3F);
+		}
+
+		for (uint32 x = 0; x < ScanlineWidth; ++x)
+		{
+			_background[x] = static_cast<byte>(rand() & 0xF);
+			_sprite[x] = (x >= 64 && x < 128) ? static_cast<byte>(0x10 | (rand() & 0xF)) : 0;
+			_frontSprite[x] = (x >= 64 && x < 96) ? _sprite[x] : 0;
+			_sprite0[x] = 0;
+		}
+	}
+
+	virtual void run()
+	{
+		_measure("scalar", compositeScanlineScalar);
+
+#ifdef SUKINES_ARCH_X86
+		const CpuFeatures& features = hostCpuFeatures();
+
+		if (features.sse2)
+		{
+			_measure("sse2", compositeScanlineSSE2);
+		}
+
+		if (features.avx2)
+		{
+			_measure("avx2", compositeScanlineAVX2);
+		}
+#endif
+	}
+
+private:
+	void _measure(const char* label, CompositeScanlineFunction compositeScanline)
+	{
+		ScanlineLayers layers = { _background, _sprite, _frontSprite, _sprite0 };
+		sint32 sprite0Hits = 0;
+
+		::Benchmark::Stopwatch stopwatch;
+		for (uint32 iteration = 0; iteration < Iterations; ++iteration)
+		{
+			sprite0Hits += compositeScanline(layers, _palette, RenderingPpuMask, 0, ScanlineWidth, _output);
+			_background[iteration & 0xFF] ^= 1;
+		}
+
+		double nanoseconds = stopwatch.elapsedNanoseconds();
+
+		// Keep the results alive so the calls are not optimized away
+		if (sprite0Hits == 1 && _output[0] == 0xFF)
+		{
+			fprintf(stdout, "\n");
+		}
+
+		_report(label, nanoseconds / Iterations, "ns/scanline");
+	}
+
+private:
+	byte _palette[32];
+	byte _background[ScanlineWidth];
+	byte _sprite[ScanlineWidth];
+	byte _frontSprite[ScanlineWidth];
+	byte _sprite0[ScanlineWidth];
+	byte _output[ScanlineWidth];
+};
+
+BENCHMARK_REGISTER(ScanlineCompositorBenchmark, scanline_compositor);
\ No newline at end of file
@@ -0,0 +1,206 @@
+// STL includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// sukiNES includes
+#include <framebuffer.h>
+#include <frametriplebuffer.h>
+#include <ppu.h>
+#include <ppuio.h>
+#include <rgbpalette.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0x3B0FF;
+static const uint32 FrameCount = 60;
+static const uint32 ThreadedFrameCount = 2000;
+
+class FrameTripleBufferTest : public PpuSceneTestBase, public PPUIO
+{
+public:
+	FrameTripleBufferTest()
+	: PpuSceneTestBase()
+	, _frameCount(0)
+	{
+	}
+
+	virtual bool run()
+	{
+		srand(RandomSeed);
+
+		return _testSingleThread() && _testThreads() && _testPpu();
+	}
+
+	virtual void onFrame(const FrameInfo& frameInfo)
+	{
+		++_frameCount;
+		countFrame(frameInfo);
+		_frameInfo = frameInfo;
+	}
+
+private:
+	static void _fill(const FrameBuffer& frame, uint32 value)
+	{
+		uint32* pixels = reinterpret_cast<uint32*>(frame.pixels);
+		std::fill(pixels, pixels + FrameWidth * FrameHeight, value);
+	}
+
+	// Every pixel of frame is value
+	static bool _isFilled(const FrameBuffer& frame, uint32 value)
+	{
+		const uint32* pixels = reinterpret_cast<const uint32*>(frame.pixels);
+		return std::count(pixels, pixels + FrameWidth * FrameHeight, value) == FrameWidth * FrameHeight;
+	}
+
+	bool _testSingleThread()
+	{
+		FrameTripleBuffer frames;
+
+		assertIsEqual(_isFilled(frames.frontBuffer(), 0xFF000000), true, "New front frame not black");
+
+		FrameTripleBuffer colorIndexFrames(PixelFormat::ColorIndex);
+		const uint16* colorIndices = reinterpret_cast<const uint16*>(colorIndexFrames.frontBuffer().pixels);
+		uint32 blackCount = static_cast<uint32>(std::count(colorIndices, colorIndices + FrameWidth * FrameHeight, RgbPalette::index(0x0F, 0)));
+		assertIsEqual(blackCount, FrameWidth * FrameHeight, "New ColorIndex front frame not black");
+		assertIsEqual(frames.acquire(), false, "Frame acquired before one was published");
+		assertIsEqual(frames.duplicatedFrameCount(), 1u, "Acquire without a new frame not counted");
+		assertIsEqual(frames.acquire(false), false, "Frame acquired before one was published");
+		assertIsEqual(frames.duplicatedFrameCount(), 1u, "Acquire not expecting a frame counted");
+
+		_fill(frames.backBuffer(), 1);
+		_fill(frames.publish(2), 2);
+		assertIsEqual(frames.acquire(), true, "Published frame not acquired");
+		assertIsEqual(_isFilled(frames.frontBuffer(), 1), true, "Front frame not the published one");
+		assertIsEqual(frames.frontBurstPhase(), 2u, "Burst phase not the published one");
+
+		// The second frame replaces the third before it is acquired
+		frames.publish();
+		_fill(frames.backBuffer(), 3);
+		frames.publish();
+		assertIsEqual(frames.droppedFrameCount(), 1u, "Replaced frame not counted as dropped");
+		assertIsEqual(frames.acquire(), true, "Latest frame not acquired");
+		assertIsEqual(_isFilled(frames.frontBuffer(), 3), true, "Front frame not the latest one");
+		assertIsEqual(frames.acquire(), false, "Same frame acquired twice");
+
+		assertIsEqual(frames.publishedFrameCount(), 3u, "Published frames not counted");
+		assertIsEqual(frames.duplicatedFrameCount(), 2u, "Acquire without a new frame not counted");
+
+		return true;
+	}
+
+	// The consumer only ever sees whole frames, in the order published
+	bool _testThreads()
+	{
+		FrameTripleBuffer frames;
+
+		std::thread producer([&frames] () {
+			FrameBuffer backBuffer = frames.backBuffer();
+			for (uint32 frame = 1; frame <= ThreadedFrameCount; ++frame)
+			{
+				_fill(backBuffer, frame);
+				backBuffer = frames.publish();
+			}
+		});
+
+		uint32 lastFrame = 0;
+		uint32 acquiredCount = 0;
+		uint32 tornCount = 0;
+		uint32 outOfOrderCount = 0;
+		while (lastFrame < ThreadedFrameCount)
+		{
+			if (!frames.acquire())
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			++acquiredCount;
+
+			FrameBuffer frontBuffer = frames.frontBuffer();
+			uint32 frame = *reinterpret_cast<const uint32*>(frontBuffer.pixels);
+			if (!_isFilled(frontBuffer, frame))
+			{
+				++tornCount;
+			}
+			if (frame <= lastFrame)
+			{
+				++outOfOrderCount;
+			}
+			lastFrame = frame;
+		}
+		producer.join();
+
+		assertIsEqual(tornCount, 0u, "Acquired frame partially written");
+		assertIsEqual(outOfOrderCount, 0u, "Frames acquired out of order");
+		assertIsEqual(frames.publishedFrameCount(), ThreadedFrameCount, "Published frames not counted");
+		assertIsEqual(acquiredCount + frames.droppedFrameCount(), ThreadedFrameCount, "Frames neither acquired nor dropped");
+
+		return true;
+	}
+
+	// Rendering through the triple buffer gives the same frames, unchanged frames included
+	bool _testPpu()
+	{
+		randomizeChr();
+
+		memset(_expected, 0, sizeof(_expected));
+		addScenePpu(&_expectedPpu);
+		_expectedPpu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_expected), FrameWidth * sizeof(uint32), PixelFormat::RGB32));
+
+		addScenePpu(&_actualPpu);
+		_actualPpu.setFrameTripleBuffer(&_frames);
+		_actualPpu.setIO(this);
+
+		writeRandomScene();
+
+		// Most frames are left untouched, the others get one write at a random dot
+		uint32 dotsUntilWrite = nextWriteDelay();
+		while (_frameCount < FrameCount)
+		{
+			if (dotsUntilWrite-- == 0)
+			{
+				write(0x2001, (rand() & 1) ? 0x1E : 0x3E);
+				dotsUntilWrite = nextWriteDelay();
+			}
+
+			uint32 frameCount = _frameCount;
+
+			_expectedPpu.tick();
+			_actualPpu.tick();
+
+			if (_frameCount != frameCount)
+			{
+				_frames.acquire();
+				FrameBuffer frontBuffer = _frames.frontBuffer();
+
+				assertIsEqual((_frameInfo.frameBuffer.pixels == frontBuffer.pixels), true, "Frame info not giving the published frame");
+				if (!_frameInfo.isUnchanged)
+				{
+					assertIsEqual(_frames.frontBurstPhase(), _frameInfo.burstPhase, "Burst phase not published with the frame");
+				}
+				assertIsEqual(memcmp(frontBuffer.pixels, _expected, sizeof(_expected)), 0, "Frame not equal");
+
+				_expectedPpu.setFrameBuffer(_expectedPpu.frameBuffer());
+			}
+		}
+
+		assertIsEqual(hasReusedFrame(), true, "No frame was reused");
+		assertIsEqual(_frames.publishedFrameCount(), FrameCount - _unchangedFrameCount, "Unchanged frames published");
+
+		return true;
+	}
+
+private:
+	PPU _expectedPpu;
+	PPU _actualPpu;
+	FrameTripleBuffer _frames;
+	FrameInfo _frameInfo;
+	uint32 _expected[FrameHeight][FrameWidth];
+	uint32 _frameCount;
+};
+
+STRESSTEST_REGISTER_TEST(FrameTripleBufferTest, frame_triple_buffer);
\ No newline at end of file
@@ -0,0 +1,163 @@
+// STL includes
+#include <cstdlib>
+#include <cstring>
+
+// sukiNES includes
+#include <colorconversion.h>
+#include <cpufeatures.h>
+#include <framebuffer.h>
+#include <ppu.h>
+#include <rgbpalette.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0xC010;
+static const uint32 FrameCount = 8;
+// Every palette entry at an even pixel, plus a tail that is not a multiple of the SIMD width
+static const uint32 KernelPixelCount = RgbPalette::EntryCount * 2 + 13;
+static const uint32 PpuCount = 4;
+
+class Ppu_ColorConversionTest : public PpuSceneTestBase
+{
+public:
+	Ppu_ColorConversionTest()
+	: PpuSceneTestBase()
+	{
+		_ppus[0] = &_indexPpu;
+		_ppus[1] = &_rgb32Ppu;
+		_ppus[2] = &_rgb565Ppu;
+		_ppus[3] = &_grayscalePpu;
+	}
+
+	virtual bool run()
+	{
+		srand(RandomSeed);
+
+		if (!_testKernels())
+		{
+			return false;
+		}
+
+		randomizeChr();
+
+		memset(_indexFrame, 0, sizeof(_indexFrame));
+		memset(_rgb32Frame, 0, sizeof(_rgb32Frame));
+		memset(_rgb565Frame, 0, sizeof(_rgb565Frame));
+		memset(_grayscaleFrame, 0, sizeof(_grayscaleFrame));
+
+		_indexPpu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_indexFrame), FrameWidth * sizeof(uint16), PixelFormat::ColorIndex));
+		_rgb32Ppu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_rgb32Frame), FrameWidth * sizeof(uint32), PixelFormat::RGB32));
+		_rgb565Ppu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_rgb565Frame), FrameWidth * sizeof(uint16), PixelFormat::RGB565));
+		_grayscalePpu.setFrameBuffer(FrameBuffer(&_grayscaleFrame[0][0], FrameWidth, PixelFormat::Grayscale));
+
+		for (uint32 whichPpu = 0; whichPpu < PpuCount; ++whichPpu)
+		{
+			addScenePpu(_ppus[whichPpu]);
+		}
+
+		writeRandomScene();
+
+		for (uint32 frame = 0; frame < FrameCount; ++frame)
+		{
+			for (uint32 dot = 0; dot < DotsPerFrame; ++dot)
+			{
+				// Change the emphasis and greyscale bits in the middle of scanlines
+				if (_indexPpu.cyclesCountPerScanline() == 100 && rand() % 16 == 0)
+				{
+					write(0x2001, static_cast<byte>(0x1E | (rand() & 0xE1)));
+				}
+
+				for (uint32 whichPpu = 0; whichPpu < PpuCount; ++whichPpu)
+				{
+					_ppus[whichPpu]->tick();
+				}
+			}
+
+			_convertFrame(PixelFormat::RGB32);
+			assertIsEqual(memcmp(_converted, _rgb32Frame, sizeof(_rgb32Frame)), 0, "Converted RGB32 frame not equal to the PPU RGB32 frame");
+
+			_convertFrame(PixelFormat::RGB565);
+			assertIsEqual(memcmp(_converted, _rgb565Frame, sizeof(_rgb565Frame)), 0, "Converted RGB565 frame not equal to the PPU RGB565 frame");
+
+			_convertFrame(PixelFormat::Grayscale);
+			assertIsEqual(memcmp(_converted, _grayscaleFrame, sizeof(_grayscaleFrame)), 0, "Converted grayscale frame not equal to the PPU grayscale frame");
+		}
+
+		return true;
+	}
+
+private:
+	void _convertFrame(PixelFormat format)
+	{
+		memset(_converted, 0xCD, sizeof(_converted));
+		convertFrame(_indexPpu.frameBuffer(), _palette, FrameBuffer(_converted, FrameWidth * FrameBuffer::bytesPerPixel(format), format));
+	}
+
+	bool _testKernels()
+	{
+		for (uint32 pixel = 0; pixel < KernelPixelCount; ++pixel)
+		{
+			_indices[pixel] = static_cast<uint16>(rand() & (RgbPalette::EntryCount - 1));
+		}
+
+		// Every colour and emphasis combination at least once
+		for (uint32 index = 0; index < RgbPalette::EntryCount; ++index)
+		{
+			_indices[index * 2] = static_cast<uint16>(index);
+		}
+
+		if (!_testKernel(convertColorIndicesScalar))
+		{
+			return false;
+		}
+
+#ifdef SUKINES_ARCH_X86
+		if (hostCpuFeatures().avx2 && !_testKernel(convertColorIndicesAVX2))
+		{
+			return false;
+		}
+#endif
+
+		return true;
+	}
+
+	bool _testKernel(ConvertColorIndicesFunction convertColorIndices)
+	{
+		static uint32 rgb32[KernelPixelCount];
+		static uint16 rgb565[KernelPixelCount];
+		static byte grayscale[KernelPixelCount];
+
+		convertColorIndices(_indices, KernelPixelCount, _palette, PixelFormat::RGB32, reinterpret_cast<byte*>(rgb32));
+		convertColorIndices(_indices, KernelPixelCount, _palette, PixelFormat::RGB565, reinterpret_cast<byte*>(rgb565));
+		convertColorIndices(_indices, KernelPixelCount, _palette, PixelFormat::Grayscale, grayscale);
+
+		for (uint32 pixel = 0; pixel < KernelPixelCount; ++pixel)
+		{
+			uint16 index = _indices[pixel];
+			assertIsEqual(rgb32[pixel], _palette.rgb32()[index], "RGB32 colour not equal to the palette");
+			assertIsEqual(rgb565[pixel], _palette.rgb565()[index], "RGB565 colour not equal to the palette");
+			assertIsEqual(grayscale[pixel], _palette.grayscale()[index], "Grayscale colour not equal to the palette");
+		}
+
+		return true;
+	}
+
+private:
+	RgbPalette _palette;
+	PPU _indexPpu;
+	PPU _rgb32Ppu;
+	PPU _rgb565Ppu;
+	PPU _grayscalePpu;
+	PPU* _ppus[PpuCount];
+	uint16 _indices[KernelPixelCount];
+	uint16 _indexFrame[FrameHeight][FrameWidth];
+	uint32 _rgb32Frame[FrameHeight][FrameWidth];
+	uint16 _rgb565Frame[FrameHeight][FrameWidth];
+	byte _grayscaleFrame[FrameHeight][FrameWidth];
+	byte _converted[FrameHeight * FrameWidth * sizeof(uint32)];
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_ColorConversionTest, ppu_color_conversion);
\ No newline at end of file
@@ -0,0 +1,82 @@
+// STL includes
+#include <cstdlib>
+#include <cstring>
+
+// sukiNES includes
+#include <ppu.h>
+#include <ppudebugstate.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0xDEB6;
+static const uint32 DotCount = 100 * 341 + 17;
+static const byte ScrollX = 0x7D;
+
+class Ppu_DebugStateTest : public PpuSceneTestBase
+{
+public:
+	Ppu_DebugStateTest()
+	: PpuSceneTestBase()
+	{
+	}
+
+	virtual bool run()
+	{
+		srand(RandomSeed);
+
+		randomizeChr();
+
+		addScenePpu(&_ppu);
+		_ppu.setNametableMirroring(PPU::NameTableMirroring::Vertical);
+
+		writeRandomScene(_written);
+
+		_ppu.write(0x2000, 0x9A);
+		_ppu.write(0x2005, ScrollX);
+
+		for (uint32 dot = 0; dot < DotCount; ++dot)
+		{
+			_ppu.tick();
+		}
+
+		_ppu.captureDebugState(_state);
+
+		assertIsEqual(_state.ppuControl.raw, 0x9A, "PPUCTRL not equal");
+		assertIsEqual(_state.ppuMask.raw, 0x1E, "PPUMASK not equal");
+		assertIsEqual(_state.firstWrite, false, "Write toggle not equal");
+		assertIsEqual(_state.fineXScroll, static_cast<byte>(ScrollX & 0x7), "Fine X scroll not equal");
+		assertIsEqual(static_cast<uint32>(_state.temporaryPpuAddress.coarseXScroll), static_cast<uint32>(ScrollX >> 3), "Coarse X scroll not equal");
+		assertIsEqual(_state.cycle, _ppu.cyclesCountPerScanline(), "Cycle not equal");
+		assertIsEqual(_state.scanline, _ppu.currentScanline(), "Scanline not equal");
+		assertIsEqual(static_cast<uint32>(_state.nametableMirroring), static_cast<uint32>(PPU::NameTableMirroring::Vertical), "Mirroring not equal");
+		assertIsEqual(memcmp(_state.memory, _chr, sizeof(_chr)), 0, "Pattern tables not equal");
+		assertIsEqual(memcmp(_state.colors, _ppu.rgbPalette().rgb32(), sizeof(_state.colors)), 0, "Colours not equal");
+
+		// Vertical mirroring: $2800 and $2C00 were written last
+		for (uint32 address = 0x2000; address < 0x3000; ++address)
+		{
+			assertIsEqual(_state.memory[address], _written[0x800 + (address & 0x7FF)], "Nametable byte not equal");
+		}
+
+		// Entries not shared between the background and sprite palettes
+		for (uint32 index = 0; index < sizeof(_state.palette); ++index)
+		{
+			if (index & 0x3)
+			{
+				assertIsEqual(_state.palette[index], _written[0x1000 + index], "Palette entry not equal");
+			}
+		}
+
+		return true;
+	}
+
+private:
+	byte _written[SceneMemorySize];
+	PPU _ppu;
+	PPUDebugState _state;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_DebugStateTest, ppu_debug_state);
\ No newline at end of file
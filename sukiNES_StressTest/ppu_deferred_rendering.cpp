@@ -0,0 +1,210 @@
+// STL includes
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// sukiNES includes
+#include <framebuffer.h>
+#include <ppu.h>
+#include <ppuio.h>
+#include <ppuwritelog.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0xDEFE4;
+static const uint32 FrameCount = 30;
+static const uint32 FrameSize = FrameWidth * FrameHeight;
+
+class Ppu_DeferredRenderingTest : public PpuSceneTestBase
+{
+public:
+	Ppu_DeferredRenderingTest()
+	: PpuSceneTestBase()
+	, _expectedFrames(FrameCount * FrameSize)
+	, _isExpectedRendered(FrameCount)
+	, _expectedIO(this)
+	, _renderIO(this)
+	, _renderedFrameCount(0)
+	, _mismatchedFrameCount(0)
+	, _skippedFrameCount(0)
+	{
+	}
+
+	virtual bool run()
+	{
+		srand(RandomSeed);
+		randomizeChr();
+		memcpy(_renderChr, _chr, sizeof(_chr));
+
+		// Reference PPU renders as usual, the other one only keeps the timing and logs for the render thread
+		addScenePpu(&_expectedPpu);
+		_expectedPpu.setFrameBuffer(FrameBuffer(_expected, FrameWidth, PixelFormat::PaletteIndex));
+		_expectedPpu.setIO(&_expectedIO);
+
+		addScenePpu(&_timingPpu);
+		_timingPpu.setTimingOnly(true);
+		_timingPpu.setWriteLog(&_log);
+		_timingPpu.powerOn();
+
+		_renderPpu.mapChrBank(_renderChr);
+		_renderPpu.setFrameBuffer(FrameBuffer(_rendered, FrameWidth, PixelFormat::PaletteIndex));
+		_renderPpu.setIO(&_renderIO);
+
+		std::thread renderThread(&Ppu_DeferredRenderingTest::_renderFrames, this);
+
+		writeRandomScene();
+
+		uint32 lastFrameCount = _expectedPpu.frameCount();
+		while (_expectedIO.frameCount < FrameCount)
+		{
+			if (rand() % 2000 == 0)
+			{
+				_randomAccess();
+			}
+
+			// Frames are skipped the way the emulation thread skips them, through the log
+			if (_expectedPpu.frameCount() != lastFrameCount)
+			{
+				lastFrameCount = _expectedPpu.frameCount();
+
+				bool isSkipped = rand() % 3 == 0;
+				_expectedPpu.setTimingOnly(isSkipped);
+				_timingPpu.logTimingOnly(isSkipped);
+			}
+
+			_expectedPpu.tick();
+			_timingPpu.tick();
+		}
+
+		renderThread.join();
+
+		assertIsEqual(_renderedFrameCount, FrameCount, "Not every frame was rendered");
+		assertIsEqual(_mismatchedFrameCount, 0u, "Rendered frame not equal");
+		assertIsEqual(static_cast<bool>(_skippedFrameCount), true, "No frame was skipped");
+
+		return true;
+	}
+
+private:
+	class FrameIO : public PPUIO
+	{
+	public:
+		FrameIO(Ppu_DeferredRenderingTest* test)
+		: test(test)
+		, frameCount(0)
+		{
+		}
+
+		virtual void onFrame(const FrameInfo& frameInfo)
+		{
+			test->_onFrame(*this, frameInfo.isRendered);
+			++frameCount;
+		}
+
+		Ppu_DeferredRenderingTest* test;
+		uint32 frameCount;
+	};
+
+	void _onFrame(const FrameIO& io, bool isRendered)
+	{
+		byte* expectedFrame = &_expectedFrames[io.frameCount * FrameSize];
+
+		if (&io == &_expectedIO)
+		{
+			memcpy(expectedFrame, _expected, FrameSize);
+			_isExpectedRendered[io.frameCount] = isRendered;
+		}
+		else
+		{
+			// A skipped frame leaves the frame buffer as it was, only the flags must match
+			if (isRendered != static_cast<bool>(_isExpectedRendered[io.frameCount])
+				|| (isRendered && memcmp(expectedFrame, _rendered, FrameSize) != 0))
+			{
+				++_mismatchedFrameCount;
+			}
+			if (!isRendered)
+			{
+				++_skippedFrameCount;
+			}
+			++_renderedFrameCount;
+		}
+	}
+
+	void _renderFrames()
+	{
+		PPUWriteLog::Entry entry;
+		while (_renderIO.frameCount < FrameCount)
+		{
+			if (_log.pop(entry))
+			{
+				_renderPpu.replay(entry);
+			}
+			else
+			{
+				_log.waitForFrame();
+			}
+		}
+	}
+
+	void _randomAccess()
+	{
+		switch(rand() % 6)
+		{
+			case 0:
+				write(0x2006, 0x3F);
+				write(0x2006, static_cast<byte>(rand() & 0x1F));
+				write(0x2007, static_cast<byte>(rand()));
+				break;
+			case 1:
+				write(0x2006, static_cast<byte>(0x20 + (rand() & 0x3)));
+				write(0x2006, static_cast<byte>(rand()));
+				write(0x2007, static_cast<byte>(rand()));
+				_read(0x2007);
+				break;
+			case 2:
+				write(0x2003, static_cast<byte>(rand()));
+				write(0x2004, static_cast<byte>(rand()));
+				break;
+			case 3:
+				write(0x2000, static_cast<byte>(rand() & 0x38));
+				break;
+			case 4:
+				// Rendering is sometimes disabled for a while, which also changes the odd frame skip
+				write(0x2001, (rand() % 4) ? 0x1E : 0x00);
+				break;
+			default:
+				_read(0x2002);
+				write(0x2005, static_cast<byte>(rand()));
+				write(0x2005, static_cast<byte>(rand()));
+				break;
+		}
+	}
+
+	void _read(word address)
+	{
+		_expectedPpu.read(address);
+		_timingPpu.read(address);
+	}
+
+private:
+	byte _renderChr[SUKINES_KB(8)];
+	PPU _expectedPpu;
+	PPU _timingPpu;
+	PPU _renderPpu;
+	PPUWriteLog _log;
+	byte _expected[FrameSize];
+	byte _rendered[FrameSize];
+	std::vector<byte> _expectedFrames;
+	std::vector<byte> _isExpectedRendered;
+	FrameIO _expectedIO;
+	FrameIO _renderIO;
+	uint32 _renderedFrameCount;
+	uint32 _mismatchedFrameCount;
+	uint32 _skippedFrameCount;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_DeferredRenderingTest, ppu_deferred_rendering);
\ No newline at end of file
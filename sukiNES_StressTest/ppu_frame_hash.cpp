@@ -0,0 +1,115 @@
+// STL includes
+#include <cstdlib>
+#include <cstring>
+
+// sukiNES includes
+#include <framebuffer.h>
+#include <framehash.h>
+#include <ppu.h>
+#include <ppuio.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0x4A54;
+static const uint32 FrameCount = 60;
+static const uint32 PaddedPitch = FrameWidth + 64;
+
+class Ppu_FrameHashTest : public PpuSceneTestBase, public PPUIO
+{
+public:
+	Ppu_FrameHashTest()
+	: PpuSceneTestBase()
+	, _frameCount(0)
+	, _lastHash(0)
+	, _callbackHash(0)
+	{
+	}
+
+	virtual bool run()
+	{
+		// XXH64 reference values. 64-bit hashes are asserted on the comparison, the failure message prints 32 bits
+		assertIsEqual((hash64(reinterpret_cast<const byte*>(""), 0, 0) == 0xEF46DB3751D8E999ULL), true, "Empty hash not equal");
+		assertIsEqual((hash64(reinterpret_cast<const byte*>("abc"), 3, 0) == 0x44BC2CF5AD770999ULL), true, "abc hash not equal");
+
+		// 39 bytes: one 32-byte stripe through the 4 lanes, then the 4 and 1 byte tails
+		const char* const longInput = "Nobody inspects the spammish repetition";
+		assertIsEqual((hash64(reinterpret_cast<const byte*>(longInput), 39, 0) == 0xFBCEA83C8A378BF1ULL), true, "Long input hash not equal");
+		assertIsEqual((hash64(reinterpret_cast<const byte*>(longInput), 39, 20141025) == 0xCE06936136852706ULL), true, "Seeded long input hash not equal");
+
+		srand(RandomSeed);
+		randomizeChr();
+
+		memset(_frame, 0, sizeof(_frame));
+		memset(_paddedFrame, 0, sizeof(_paddedFrame));
+
+		addScenePpu(&_ppu);
+		_ppu.setFrameBuffer(FrameBuffer(&_frame[0][0], FrameWidth, PixelFormat::PaletteIndex));
+		_ppu.setFrameHashing(true);
+		_ppu.setIO(this);
+
+		// Same picture with padding between the scanlines
+		addScenePpu(&_paddedPpu);
+		_paddedPpu.setFrameBuffer(FrameBuffer(&_paddedFrame[0][0], PaddedPitch, PixelFormat::PaletteIndex));
+		_paddedPpu.setFrameHashing(true);
+
+		writeRandomScene();
+
+		uint32 dotsUntilWrite = nextWriteDelay();
+		while (_frameCount < FrameCount)
+		{
+			if (dotsUntilWrite-- == 0)
+			{
+				write(0x2005, static_cast<byte>(rand()));
+				write(0x2005, static_cast<byte>(rand()));
+				dotsUntilWrite = nextWriteDelay();
+			}
+
+			uint32 frameCount = _frameCount;
+
+			_ppu.tick();
+			_paddedPpu.tick();
+
+			if (_frameCount != frameCount)
+			{
+				assertIsEqual((_ppu.frameHash() == hashFrame(_ppu.frameBuffer())), true, "Frame hash not equal to the frame buffer hash");
+				assertIsEqual((_callbackHash == _ppu.frameHash()), true, "Frame callback hash not equal");
+				assertIsEqual((_paddedPpu.frameHash() == _ppu.frameHash()), true, "Frame hash depends on the pitch");
+			}
+		}
+
+		assertIsEqual(hasReusedFrame(), true, "No frame was reused");
+
+		return true;
+	}
+
+	virtual void onFrame(const FrameInfo& frameInfo)
+	{
+		++_frameCount;
+		_callbackHash = frameInfo.hash;
+
+		countFrame(frameInfo);
+		if (frameInfo.isUnchanged)
+		{
+			if (frameInfo.hash != _lastHash)
+			{
+				_callbackHash = 0;
+			}
+		}
+
+		_lastHash = frameInfo.hash;
+	}
+
+private:
+	PPU _ppu;
+	PPU _paddedPpu;
+	byte _frame[FrameHeight][FrameWidth];
+	byte _paddedFrame[FrameHeight][PaddedPitch];
+	uint32 _frameCount;
+	uint64 _lastHash;
+	uint64 _callbackHash;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_FrameHashTest, ppu_frame_hash);
\ No newline at end of file
@@ -0,0 +1,115 @@
+// STL includes
+#include <cstdlib>
+#include <cstring>
+
+// sukiNES includes
+#include <framebuffer.h>
+#include <ppu.h>
+#include <ppuio.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0xF4A3E;
+static const uint32 FrameCount = 60;
+
+class Ppu_FrameMemoizationTest : public PpuSceneTestBase, public PPUIO
+{
+public:
+	Ppu_FrameMemoizationTest()
+	: PpuSceneTestBase()
+	, _frameCount(0)
+	{
+	}
+
+	virtual bool run()
+	{
+		srand(RandomSeed);
+		randomizeChr();
+
+		_setupPpu(_expectedPpu, _expected);
+		_setupPpu(_actualPpu, _actual);
+		_actualPpu.setIO(this);
+
+		writeRandomScene();
+
+		// Most frames are left untouched, the others get one write at a random dot
+		uint32 dotsUntilWrite = nextWriteDelay();
+		while (_frameCount < FrameCount)
+		{
+			if (dotsUntilWrite-- == 0)
+			{
+				_randomWrite();
+				dotsUntilWrite = nextWriteDelay();
+			}
+
+			uint32 frameCount = _frameCount;
+
+			_expectedPpu.tick();
+			_actualPpu.tick();
+
+			if (_frameCount != frameCount)
+			{
+				assertIsEqual(memcmp(_actual, _expected, sizeof(_expected)), 0, "Frame not equal");
+
+				// The reference PPU never reuses its previous frame
+				_expectedPpu.setFrameBuffer(_expectedPpu.frameBuffer());
+			}
+		}
+
+		assertIsEqual(hasReusedFrame(), true, "No frame was reused");
+
+		return true;
+	}
+
+	virtual void onFrame(const FrameInfo& frameInfo)
+	{
+		++_frameCount;
+		countFrame(frameInfo);
+	}
+
+private:
+	void _setupPpu(PPU& ppu, uint32 (&frame)[FrameHeight][FrameWidth])
+	{
+		memset(frame, 0, sizeof(frame));
+
+		addScenePpu(&ppu);
+		ppu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(frame), FrameWidth * sizeof(uint32), PixelFormat::RGB32));
+	}
+
+	void _randomWrite()
+	{
+		switch(rand() % 4)
+		{
+			case 0:
+				write(0x2006, 0x3F);
+				write(0x2006, static_cast<byte>(rand() & 0x1F));
+				write(0x2007, static_cast<byte>(rand()));
+				break;
+			case 1:
+				write(0x2006, static_cast<byte>(0x20 + (rand() & 0x3)));
+				write(0x2006, static_cast<byte>(rand()));
+				write(0x2007, static_cast<byte>(rand()));
+				break;
+			case 2:
+				write(0x2003, static_cast<byte>(rand()));
+				write(0x2004, static_cast<byte>(rand()));
+				break;
+			default:
+				write(0x2005, static_cast<byte>(rand()));
+				write(0x2005, static_cast<byte>(rand()));
+				break;
+		}
+	}
+
+private:
+	PPU _expectedPpu;
+	PPU _actualPpu;
+	uint32 _expected[FrameHeight][FrameWidth];
+	uint32 _actual[FrameHeight][FrameWidth];
+	uint32 _frameCount;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_FrameMemoizationTest, ppu_frame_memoization);
\ No newline at end of file
@@ -0,0 +1,207 @@
+// STL includes
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// sukiNES includes
+#include <cpufeatures.h>
+#include <framebuffer.h>
+#include <ntscfilter.h>
+#include <ntscfilterpool.h>
+#include <ppu.h>
+#include <ppuio.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0x4715C;
+static const uint32 FrameCount = 6;
+static const uint32 PoolThreadCount = 3;
+static const uint32 OutputSize = NtscOutputWidth * FrameHeight;
+static const uint32 OpaqueWhite = 0xFFFFFFFF;
+static const uint32 OpaqueBlack = 0xFF000000;
+
+class Ppu_NtscFilterTest : public PpuSceneTestBase, public PPUIO
+{
+public:
+	Ppu_NtscFilterTest()
+	: PpuSceneTestBase()
+	, _expected(OutputSize)
+	, _pooled(OutputSize)
+	, _pool(PoolThreadCount)
+	, _frameCount(0)
+	, _lastBurstPhase(0)
+	, _isPhaseAlternating(true)
+	, _mismatchedFrameCount(0)
+	{
+	}
+
+	virtual bool run()
+	{
+		srand(RandomSeed);
+
+		if (!_testKernels() || !_testFlatFields() || !_testDroppedFrame())
+		{
+			return false;
+		}
+
+		randomizeChr();
+
+		memset(_frame, 0, sizeof(_frame));
+
+		addScenePpu(&_ppu);
+		_ppu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint16), PixelFormat::ColorIndex));
+		_ppu.setIO(this);
+
+		writeRandomScene();
+
+		for (uint32 dot = 0; dot < FrameCount * DotsPerFrame; ++dot)
+		{
+			_ppu.tick();
+		}
+
+		assertIsEqual(_frameCount, FrameCount, "Frame count not equal");
+		assertIsEqual(_isPhaseAlternating, true, "Burst phase does not alternate between two phases with the odd frame skip");
+		assertIsEqual(_mismatchedFrameCount, 0u, "Frame filtered by the pool not equal to the frame filtered on one thread");
+
+		return true;
+	}
+
+	virtual void onFrame(const FrameInfo& frameInfo)
+	{
+		// Rendering stays on, so every other frame is one dot shorter
+		uint32 expectedPhase = (_lastBurstPhase + (_frameCount % 2 == 0 ? 1 : 2)) % NtscPhaseCount;
+		if (_frameCount > 0 && frameInfo.burstPhase != expectedPhase)
+		{
+			_isPhaseAlternating = false;
+		}
+		_lastBurstPhase = frameInfo.burstPhase;
+		++_frameCount;
+
+		_filter.filter(frameInfo.frameBuffer, frameInfo.burstPhase, _outputBuffer(_expected));
+
+		_pool.setDestination(_outputBuffer(_pooled));
+		_pool.submit(frameInfo.frameBuffer, frameInfo.burstPhase);
+		_pool.wait();
+
+		if (_pooled != _expected)
+		{
+			++_mismatchedFrameCount;
+		}
+	}
+
+private:
+	static FrameBuffer _outputBuffer(std::vector<uint32>& output)
+	{
+		return FrameBuffer(reinterpret_cast<byte*>(output.data()), NtscOutputWidth * sizeof(uint32), PixelFormat::RGB32);
+	}
+
+	bool _testKernels()
+	{
+		uint16 indices[FrameWidth];
+		for (uint32 x = 0; x < FrameWidth; ++x)
+		{
+			indices[x] = static_cast<uint16>(rand() & 0x1FF);
+		}
+
+		for (uint32 phase = 0; phase < NtscPhaseCount; ++phase)
+		{
+			const NtscKernel* pixelKernels[FrameWidth + NtscKernelRadius * 2];
+			_filter.scanlineKernels(indices, phase, pixelKernels);
+
+			uint32 expected[NtscOutputWidth];
+			filterNtscScanlineScalar(pixelKernels, expected);
+
+#ifdef SUKINES_ARCH_X86
+			const CpuFeatures& features = hostCpuFeatures();
+			uint32 actual[NtscOutputWidth];
+
+			if (features.sse2)
+			{
+				filterNtscScanlineSSE2(pixelKernels, actual);
+				assertIsEqual(memcmp(actual, expected, sizeof(actual)), 0, "SSE2 scanline not equal to the scalar scanline");
+			}
+
+			if (features.avx2)
+			{
+				filterNtscScanlineAVX2(pixelKernels, actual);
+				assertIsEqual(memcmp(actual, expected, sizeof(actual)), 0, "AVX2 scanline not equal to the scalar scanline");
+			}
+#endif
+		}
+
+		return true;
+	}
+
+	bool _testFlatFields()
+	{
+		// Away from the black borders, a flat white or black field has no artifacts
+		const uint32 margin = 3 * NtscKernelRadius * 3;
+
+		for (uint32 y = 0; y < FrameHeight; ++y)
+		{
+			for (uint32 x = 0; x < FrameWidth; ++x)
+			{
+				_frame[y][x] = (y < FrameHeight / 2) ? 0x30 : 0x0F;
+			}
+		}
+
+		for (uint32 phase = 0; phase < NtscPhaseCount; ++phase)
+		{
+			_filter.filter(FrameBuffer(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint16), PixelFormat::ColorIndex), phase, _outputBuffer(_expected));
+
+			for (uint32 y = 0; y < FrameHeight; ++y)
+			{
+				uint32 expectedPixel = (y < FrameHeight / 2) ? OpaqueWhite : OpaqueBlack;
+				for (uint32 x = margin; x < NtscOutputWidth - margin; ++x)
+				{
+					assertIsEqual(_expected[y * NtscOutputWidth + x], expectedPixel, "Flat field pixel not equal");
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool _testDroppedFrame()
+	{
+		FrameBuffer source(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint16), PixelFormat::ColorIndex);
+		std::atomic<bool> isReleased(false);
+
+		_pool.setDestination(_outputBuffer(_pooled));
+		_pool.setFrameFilteredCallback([&isReleased] () {
+			while (!isReleased)
+			{
+				std::this_thread::yield();
+			}
+		});
+
+		assertIsEqual(_pool.submit(source, 0), true, "Frame not accepted by an idle pool");
+		assertIsEqual(_pool.submit(source, 0), false, "Frame accepted while the previous one is filtered");
+
+		isReleased = true;
+		_pool.wait();
+		_pool.setFrameFilteredCallback(std::function<void()>());
+
+		assertIsEqual(_pool.isBusy(), false, "Pool still busy after wait");
+
+		return true;
+	}
+
+private:
+	uint16 _frame[FrameHeight][FrameWidth];
+	std::vector<uint32> _expected;
+	std::vector<uint32> _pooled;
+	NtscFilter _filter;
+	NtscFilterPool _pool;
+	PPU _ppu;
+	uint32 _frameCount;
+	uint32 _lastBurstPhase;
+	bool _isPhaseAlternating;
+	uint32 _mismatchedFrameCount;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_NtscFilterTest, ppu_ntsc_filter);
\ No newline at end of file
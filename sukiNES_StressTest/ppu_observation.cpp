@@ -0,0 +1,172 @@
+// STL includes
+#include <cstdlib>
+#include <cstring>
+
+// sukiNES includes
+#include <framebuffer.h>
+#include <observation.h>
+#include <ppu.h>
+#include <ppuio.h>
+#include <rgbpalette.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0x0B5E;
+static const uint32 FrameCount = 12;
+static const uint32 StackSize = 4;
+static const uint32 ObservationSize = 84;
+static const uint32 NearestWidth = 64;
+static const uint32 NearestHeight = 60;
+
+class Ppu_ObservationTest : public PpuSceneTestBase, public PPUIO
+{
+public:
+	Ppu_ObservationTest()
+	: PpuSceneTestBase()
+	, _frameCount(0)
+	, _isObservationEqual(true)
+	{
+	}
+
+	virtual bool run()
+	{
+		srand(RandomSeed);
+
+		randomizeChr();
+
+		memset(_frame, 0, sizeof(_frame));
+		memset(_expectedArea, 0, sizeof(_expectedArea));
+
+		// Area averaged grayscale without the overscan, added by the PPU
+		ObservationSettings areaSettings;
+		areaSettings.cropY = 8;
+		areaSettings.cropHeight = FrameHeight - 16;
+		areaSettings.stackSize = StackSize;
+		_areaStack.setup(areaSettings, &_areaOutput[0][0][0]);
+
+		// Nearest palette indices, added from the frame callback
+		ObservationSettings nearestSettings;
+		nearestSettings.width = NearestWidth;
+		nearestSettings.height = NearestHeight;
+		nearestSettings.filter = DownsampleFilter::Nearest;
+		nearestSettings.format = PixelFormat::PaletteIndex;
+		_nearestStack.setup(nearestSettings, &_nearestOutput[0][0]);
+
+		addScenePpu(&_ppu);
+		_ppu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint16), PixelFormat::ColorIndex));
+		_ppu.setObservationStack(&_areaStack);
+		_ppu.setIO(this);
+
+		writeRandomScene();
+
+		for (uint32 frame = 0; frame < FrameCount; ++frame)
+		{
+			// A new picture every frame
+			_ppu.write(0x2005, static_cast<byte>(rand()));
+			_ppu.write(0x2005, static_cast<byte>(rand()));
+			_ppu.write(0x2001, static_cast<byte>(0x1E | (rand() & 0xE0)));
+
+			for (uint32 dot = 0; dot < DotsPerFrame; ++dot)
+			{
+				_ppu.tick();
+			}
+		}
+
+		assertIsEqual((_frameCount > StackSize), true, "Not enough frames to wrap the observation stack");
+		assertIsEqual(_areaStack.frameCount(), _frameCount, "Observation stack frame count not equal");
+		assertIsEqual(_areaStack.newestSlot(), (_frameCount - 1) % StackSize, "Newest observation slot not equal");
+		assertIsEqual(_isObservationEqual, true, "Observation not equal to the downsampled frame");
+
+		_areaStack.reset();
+		assertIsEqual(_areaStack.frameCount(), 0u, "Observation stack not reset");
+		assertIsEqual(_areaOutput[0][0][0], 0, "Observation output not cleared");
+
+		return true;
+	}
+
+	virtual void onFrame(const FrameInfo& frameInfo)
+	{
+		if (!frameInfo.isRendered)
+		{
+			return;
+		}
+
+		_nearestStack.addFrame(frameInfo.frameBuffer, _ppu.rgbPalette());
+
+		uint32 slot = _frameCount % StackSize;
+		_expectAreaAverage(_expectedArea[slot]);
+		_expectNearest(_expectedNearest);
+		++_frameCount;
+
+		if (memcmp(_areaOutput, _expectedArea, sizeof(_areaOutput)) != 0 || memcmp(_nearestOutput, _expectedNearest, sizeof(_nearestOutput)) != 0)
+		{
+			_isObservationEqual = false;
+		}
+	}
+
+private:
+	byte _grayscale(uint32 x, uint32 y)
+	{
+		return _ppu.rgbPalette().grayscale()[_frame[y][x]];
+	}
+
+	void _expectAreaAverage(byte expected[ObservationSize][ObservationSize])
+	{
+		const uint32 cropY = 8;
+		const uint32 cropHeight = FrameHeight - 16;
+
+		for (uint32 y = 0; y < ObservationSize; ++y)
+		{
+			uint32 top = cropY + y * cropHeight / ObservationSize;
+			uint32 bottom = cropY + (y + 1) * cropHeight / ObservationSize;
+
+			for (uint32 x = 0; x < ObservationSize; ++x)
+			{
+				uint32 left = x * FrameWidth / ObservationSize;
+				uint32 right = (x + 1) * FrameWidth / ObservationSize;
+
+				uint32 sum = 0;
+				for (uint32 frameY = top; frameY < bottom; ++frameY)
+				{
+					for (uint32 frameX = left; frameX < right; ++frameX)
+					{
+						sum += _grayscale(frameX, frameY);
+					}
+				}
+
+				uint32 area = (right - left) * (bottom - top);
+				expected[y][x] = static_cast<byte>((sum + area / 2) / area);
+			}
+		}
+	}
+
+	void _expectNearest(byte expected[NearestHeight][NearestWidth])
+	{
+		for (uint32 y = 0; y < NearestHeight; ++y)
+		{
+			for (uint32 x = 0; x < NearestWidth; ++x)
+			{
+				uint32 frameX = (2 * x + 1) * FrameWidth / (2 * NearestWidth);
+				uint32 frameY = (2 * y + 1) * FrameHeight / (2 * NearestHeight);
+				expected[y][x] = static_cast<byte>(_frame[frameY][frameX] & 0x3F);
+			}
+		}
+	}
+
+private:
+	PPU _ppu;
+	ObservationStack _areaStack;
+	ObservationStack _nearestStack;
+	uint16 _frame[FrameHeight][FrameWidth];
+	byte _areaOutput[StackSize][ObservationSize][ObservationSize];
+	byte _expectedArea[StackSize][ObservationSize][ObservationSize];
+	byte _nearestOutput[NearestHeight][NearestWidth];
+	byte _expectedNearest[NearestHeight][NearestWidth];
+	uint32 _frameCount;
+	bool _isObservationEqual;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_ObservationTest, ppu_observation);
\ No newline at end of file
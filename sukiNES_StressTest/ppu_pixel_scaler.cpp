@@ -0,0 +1,217 @@
+// STL includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// sukiNES includes
+#include <framebuffer.h>
+#include <pixelscaler.h>
+#include <pixelscalerpool.h>
+#include <ppu.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0x5CA1E;
+static const uint32 FrameCount = 4;
+static const uint32 PoolThreadCount = 3;
+static const uint32 MaxScaleFactor = 3;
+static const uint32 OutputSize = FrameWidth * FrameHeight * MaxScaleFactor * MaxScaleFactor;
+static const uint32 FilterCount = 5;
+static const uint32 OpaqueWhite = 0xFFFFFFFF;
+static const uint32 OpaqueBlack = 0xFF000000;
+
+static const ScaleFilter Filters[FilterCount] =
+{
+	ScaleFilter::Nearest2x,
+	ScaleFilter::Nearest3x,
+	ScaleFilter::Scale2x,
+	ScaleFilter::Scale3x,
+	ScaleFilter::Xbr2x
+};
+
+class Ppu_PixelScalerTest : public PpuSceneTestBase
+{
+public:
+	Ppu_PixelScalerTest()
+	: PpuSceneTestBase()
+	, _expected(OutputSize)
+	, _simd(OutputSize)
+	, _pooled(OutputSize)
+	, _pool(PoolThreadCount)
+	{
+	}
+
+	virtual bool run()
+	{
+		srand(RandomSeed);
+
+		if (!_testFlatFrame() || !_testStaircase())
+		{
+			return false;
+		}
+
+		randomizeChr();
+
+		memset(_frame, 0, sizeof(_frame));
+
+		addScenePpu(&_ppu);
+		_ppu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint32), PixelFormat::RGB32));
+
+		writeRandomScene();
+
+		for (uint32 frame = 0; frame < FrameCount; ++frame)
+		{
+			for (uint32 dot = 0; dot < DotsPerFrame; ++dot)
+			{
+				_ppu.tick();
+			}
+
+			for (uint32 whichFilter = 0; whichFilter < FilterCount; ++whichFilter)
+			{
+				if (!_testFrame(Filters[whichFilter]))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+private:
+	FrameBuffer _source()
+	{
+		return FrameBuffer(reinterpret_cast<byte*>(_frame), FrameWidth * sizeof(uint32), PixelFormat::RGB32);
+	}
+
+	static FrameBuffer _destination(std::vector<uint32>& output, ScaleFilter filter)
+	{
+		uint32 pitch = FrameWidth * PixelScaler::scaleFactor(filter) * sizeof(uint32);
+		return FrameBuffer(reinterpret_cast<byte*>(output.data()), pitch, PixelFormat::RGB32);
+	}
+
+	void _scale(ScaleFilter filter, bool allowSimd, std::vector<uint32>& output)
+	{
+		std::fill(output.begin(), output.end(), 0xCDCDCDCD);
+
+		PixelScaler scaler;
+		scaler.setFilter(filter, allowSimd);
+		scaler.prepare(_source());
+		scaler.scale(_destination(output, filter));
+	}
+
+	// Scalar, SIMD and threaded output are the same
+	bool _testFrame(ScaleFilter filter)
+	{
+		uint32 factor = PixelScaler::scaleFactor(filter);
+		uint32 outputSize = FrameWidth * FrameHeight * factor * factor;
+
+		_scale(filter, false, _expected);
+		_scale(filter, true, _simd);
+
+		std::fill(_pooled.begin(), _pooled.end(), 0xCDCDCDCD);
+		_pool.setFilter(filter);
+		_pool.setDestination(_destination(_pooled, filter));
+		assertIsEqual(_pool.submit(_source()), true, "Idle pool refused a frame");
+		_pool.wait();
+
+		assertIsEqual(memcmp(_simd.data(), _expected.data(), outputSize * sizeof(uint32)), 0, "SIMD scaler output not equal to the scalar output");
+		assertIsEqual(memcmp(_pooled.data(), _expected.data(), outputSize * sizeof(uint32)), 0, "Pool output not equal to the single thread output");
+
+		if (filter == ScaleFilter::Nearest2x || filter == ScaleFilter::Nearest3x)
+		{
+			for (uint32 y = 0; y < FrameHeight * factor; ++y)
+			{
+				for (uint32 x = 0; x < FrameWidth * factor; ++x)
+				{
+					assertIsEqual(_expected[y * FrameWidth * factor + x], _frame[y / factor][x / factor], "Nearest pixel not equal to its source pixel");
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool _testFlatFrame()
+	{
+		for (uint32 y = 0; y < FrameHeight; ++y)
+		{
+			for (uint32 x = 0; x < FrameWidth; ++x)
+			{
+				_frame[y][x] = 0xFF2038EC;
+			}
+		}
+
+		for (uint32 whichFilter = 0; whichFilter < FilterCount; ++whichFilter)
+		{
+			ScaleFilter filter = Filters[whichFilter];
+			uint32 factor = PixelScaler::scaleFactor(filter);
+
+			for (uint32 simd = 0; simd < 2; ++simd)
+			{
+				_scale(filter, simd != 0, _expected);
+
+				for (uint32 pixel = 0; pixel < FrameWidth * FrameHeight * factor * factor; ++pixel)
+				{
+					assertIsEqual(_expected[pixel], 0xFF2038EC, "Flat frame not scaled to the same colour");
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// White above the diagonal, black below: the steps get filled in
+	bool _testStaircase()
+	{
+		for (uint32 y = 0; y < FrameHeight; ++y)
+		{
+			for (uint32 x = 0; x < FrameWidth; ++x)
+			{
+				_frame[y][x] = x >= y ? OpaqueWhite : OpaqueBlack;
+			}
+		}
+
+		for (uint32 simd = 0; simd < 2; ++simd)
+		{
+			_scale(ScaleFilter::Scale2x, simd != 0, _expected);
+			for (uint32 y = 1; y < FrameHeight - 1; ++y)
+			{
+				// Top right of the black pixel left of the diagonal
+				assertIsEqual(_expected[(y * 2) * FrameWidth * 2 + (y - 1) * 2 + 1], OpaqueWhite, "Scale2x did not fill a step of the staircase");
+				assertIsEqual(_expected[(y * 2 + 1) * FrameWidth * 2 + (y - 1) * 2], OpaqueBlack, "Scale2x changed a pixel away from the edge");
+			}
+
+			_scale(ScaleFilter::Scale3x, simd != 0, _expected);
+			for (uint32 y = 1; y < FrameHeight - 1; ++y)
+			{
+				assertIsEqual(_expected[(y * 3) * FrameWidth * 3 + (y - 1) * 3 + 2], OpaqueWhite, "Scale3x did not fill a step of the staircase");
+				assertIsEqual(_expected[(y * 3 + 1) * FrameWidth * 3 + (y - 1) * 3 + 1], OpaqueBlack, "Scale3x changed the centre of a pixel");
+			}
+
+			_scale(ScaleFilter::Xbr2x, simd != 0, _expected);
+			for (uint32 y = 2; y < FrameHeight - 2; ++y)
+			{
+				// Blended half way between black and white
+				assertIsEqual(_expected[(y * 2) * FrameWidth * 2 + (y - 1) * 2 + 1], 0xFF808080, "xBR did not blend a step of the staircase");
+				assertIsEqual(_expected[(y * 2 + 1) * FrameWidth * 2 + (y - 1) * 2], OpaqueBlack, "xBR changed a pixel away from the edge");
+			}
+		}
+
+		return true;
+	}
+
+private:
+	PPU _ppu;
+	uint32 _frame[FrameHeight][FrameWidth];
+	std::vector<uint32> _expected;
+	std::vector<uint32> _simd;
+	std::vector<uint32> _pooled;
+	PixelScalerPool _pool;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_PixelScalerTest, ppu_pixel_scaler);
\ No newline at end of file
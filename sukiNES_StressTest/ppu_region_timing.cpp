@@ -0,0 +1,118 @@
+// STL includes
+#include <cstring>
+
+// sukiNES includes
+#include <ppu.h>
+
+// Local includes
+#include "test.h"
+
+using namespace sukiNES;
+
+static const byte VBlankFlag = 0x80;
+static const uint32 DotsPerScanline = 341;
+
+class Ppu_RegionTimingTest : public StressTest::Test
+{
+public:
+	Ppu_RegionTimingTest()
+	: StressTest::Test()
+	{
+	}
+
+	virtual bool run()
+	{
+		// NTSC drops a dot of the pre-render scanline on odd frames when rendering
+		assertIsEqual(_frameDots(Region::Ntsc, 0x00), 262 * DotsPerScanline, "NTSC frame length not equal");
+		assertIsEqual(_frameDots(Region::Ntsc, 0x18), 2 * 262 * DotsPerScanline - 1, "NTSC rendering frame length not equal");
+		assertIsEqual(_frameDots(Region::Pal, 0x18), 2 * 312 * DotsPerScanline, "PAL frame length not equal");
+		assertIsEqual(_frameDots(Region::Dendy, 0x18), 2 * 312 * DotsPerScanline, "Dendy frame length not equal");
+
+		assertIsEqual(_vblankScanline(Region::Ntsc), 241, "NTSC VBlank scanline not equal");
+		assertIsEqual(_vblankScanline(Region::Pal), 241, "PAL VBlank scanline not equal");
+		assertIsEqual(_vblankScanline(Region::Dendy), 291, "Dendy VBlank scanline not equal");
+
+		// One frame of each console's master clock, 21.477272 MHz / 4 and 26.601712 MHz / 5 per dot
+		assertIsEqual(_isFrameRateClose(Region::Ntsc, 21477272.0 / 4.0 / (262 * DotsPerScanline - 0.5)), true, "NTSC frame rate not equal");
+		assertIsEqual(_isFrameRateClose(Region::Pal, 26601712.0 / 5.0 / (312 * DotsPerScanline)), true, "PAL frame rate not equal");
+		assertIsEqual(_isFrameRateClose(Region::Dendy, 26601712.0 / 5.0 / (312 * DotsPerScanline)), true, "Dendy frame rate not equal");
+
+		// The frame count moves at the same place as the frame length above
+		_setupPpu(Region::Ntsc, 0x18);
+		for (uint32 frame = 1; frame <= 3; ++frame)
+		{
+			do
+			{
+				_ppu.tick();
+			}
+			while (_ppu.currentScanline() != -1 || _ppu.cyclesCountPerScanline() != 0);
+
+			assertIsEqual(_ppu.frameCount(), frame, "Frame count not equal to the frames ticked");
+		}
+
+		return true;
+	}
+
+private:
+	void _setupPpu(Region region, byte ppuMask)
+	{
+		memset(_chr, 0, sizeof(_chr));
+
+		_ppu.setRegion(region);
+		_ppu.powerOn();
+		_ppu.mapChrBank(_chr);
+		_ppu.write(0x2001, ppuMask);
+	}
+
+	// Dots from the start of a frame to the start of the next one, two frames when rendering
+	uint32 _frameDots(Region region, byte ppuMask)
+	{
+		_setupPpu(region, ppuMask);
+
+		uint32 frameCount = ppuMask ? 2 : 1;
+		uint32 dots = 0;
+		for (uint32 frame = 0; frame < frameCount; ++frame)
+		{
+			do
+			{
+				_ppu.tick();
+				++dots;
+			}
+			while (_ppu.currentScanline() != -1 || _ppu.cyclesCountPerScanline() != 0);
+		}
+
+		return dots;
+	}
+
+	static bool _isFrameRateClose(Region region, double expected)
+	{
+		double difference = regionTiming(region).frameRate - expected;
+		return difference < 0.0001 && difference > -0.0001;
+	}
+
+	// First scanline with the VBlank flag set
+	sint32 _vblankScanline(Region region)
+	{
+		_setupPpu(region, 0x00);
+
+		// Skip the pre-render scanline, the flag might still be set from power on
+		while (_ppu.currentScanline() != 0)
+		{
+			_ppu.tick();
+		}
+		_ppu.read(0x2002);
+
+		while ((_ppu.read(0x2002) & VBlankFlag) == 0)
+		{
+			_ppu.tick();
+		}
+
+		return _ppu.currentScanline();
+	}
+
+private:
+	byte _chr[SUKINES_KB(8)];
+	PPU _ppu;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_RegionTimingTest, ppu_region_timing);
\ No newline at end of file
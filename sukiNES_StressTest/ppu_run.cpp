@@ -0,0 +1,98 @@
+// STL includes
+#include <cstdlib>
+#include <cstring>
+
+// sukiNES includes
+#include <framebuffer.h>
+#include <ppu.h>
+
+// Local includes
+#include "test.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0xD075;
+static const uint32 StepCount = 3000;
+static const uint32 MaxDotsPerStep = 2000;
+
+class Ppu_RunTest : public StressTest::Test
+{
+public:
+	Ppu_RunTest()
+	: StressTest::Test()
+	{
+	}
+
+	virtual bool run()
+	{
+		// Both PPUs have rendering disabled, run() must skip idle dots without changing the output
+		_expectedPpu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_expected), FrameWidth * sizeof(uint32), PixelFormat::RGB32));
+		_actualPpu.setFrameBuffer(FrameBuffer(reinterpret_cast<byte*>(_actual), FrameWidth * sizeof(uint32), PixelFormat::RGB32));
+
+		memset(_expected, 0, sizeof(_expected));
+		memset(_actual, 0, sizeof(_actual));
+
+		srand(RandomSeed);
+
+		for (uint32 step = 0; step < StepCount; ++step)
+		{
+			_randomRegisterWrite();
+
+			uint32 dotCount = 1 + rand() % MaxDotsPerStep;
+			for (uint32 dot = 0; dot < dotCount; ++dot)
+			{
+				_expectedPpu.tick();
+			}
+			_actualPpu.run(dotCount);
+
+			assertIsEqual(_actualPpu.currentScanline(), _expectedPpu.currentScanline(), "Scanline not equal");
+			assertIsEqual(_actualPpu.cyclesCountPerScanline(), _expectedPpu.cyclesCountPerScanline(), "PPU cycles count not equal");
+			assertIsEqual(_actualPpu.read(0x2002), _expectedPpu.read(0x2002), "PPU status not equal");
+			assertIsEqual(memcmp(_actual, _expected, sizeof(_expected)), 0, "Frame not equal");
+		}
+
+		return true;
+	}
+
+private:
+	void _randomRegisterWrite()
+	{
+		word address;
+		byte value = static_cast<byte>(rand());
+
+		switch(rand() % 4)
+		{
+			case 0:
+				// Greyscale and emphasis only, rendering stays disabled
+				address = 0x2001;
+				value &= 0xE1;
+				break;
+			case 1:
+				// Point the PPU address into the palette or out of it
+				_write(0x2006, (rand() & 1) ? 0x3F : 0x20);
+				address = 0x2006;
+				break;
+			case 2:
+				address = 0x2007;
+				break;
+			default:
+				return;
+		}
+
+		_write(address, value);
+	}
+
+	void _write(word address, byte value)
+	{
+		_expectedPpu.write(address, value);
+		_actualPpu.write(address, value);
+	}
+
+private:
+	PPU _expectedPpu;
+	PPU _actualPpu;
+	uint32 _expected[FrameHeight][FrameWidth];
+	uint32 _actual[FrameHeight][FrameWidth];
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_RunTest, ppu_run);
\ No newline at end of file
@@ -0,0 +1,234 @@
+// STL includes
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+// sukiNES includes
+#include <cpufeatures.h>
+#include <scanlinecompositor.h>
+
+// Local includes
+#include "test.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0x5EED;
+static const uint32 ScanlineCount = 2000;
+
+// PPUMASK bits
+static const byte Greyscale = 0x01;
+static const byte ShowBackgroundLeftmost = 0x02;
+static const byte ShowSpritesLeftmost = 0x04;
+static const byte ShowBackground = 0x08;
+static const byte ShowSprites = 0x10;
+static const byte ShowAll = ShowBackgroundLeftmost | ShowSpritesLeftmost | ShowBackground | ShowSprites;
+
+// Pixel 2 with attribute 1, pixel 0 with attribute 1
+static const byte OpaqueBackground = 0x06;
+static const byte TransparentBackground = 0x04;
+// Pixel 1 with palette 2, pixel 2 with palette 3
+static const byte Sprite = 0x19;
+static const byte OtherSprite = 0x1E;
+
+class Ppu_ScanlineCompositorTest : public StressTest::Test
+{
+public:
+	Ppu_ScanlineCompositorTest()
+	: StressTest::Test()
+	{
+	}
+
+	virtual bool run()
+	{
+		if (!_testReferenceCases())
+		{
+			return false;
+		}
+
+#ifdef SUKINES_ARCH_X86
+		const CpuFeatures& features = hostCpuFeatures();
+
+		srand(RandomSeed);
+
+		for (uint32 scanline = 0; scanline < ScanlineCount; ++scanline)
+		{
+			_generateScanline();
+
+			byte ppuMask = static_cast<byte>(rand() & 0x1F);
+			uint32 startX = rand() % ScanlineWidth;
+			uint32 endX = startX + (rand() % (ScanlineWidth - startX + 1));
+
+			ScanlineLayers layers = { _background, _sprite, _frontSprite, _sprite0 };
+			sint32 expectedHit = compositeScanlineScalar(layers, _palette, ppuMask, startX, endX, _expected);
+
+			if (features.sse2)
+			{
+				std::fill(std::begin(_actual), std::end(_actual), 0);
+				sint32 actualHit = compositeScanlineSSE2(layers, _palette, ppuMask, startX, endX, _actual);
+
+				assertIsEqual(actualHit, expectedHit, "SSE2 sprite 0 hit not equal");
+				for (uint32 x = startX; x < endX; ++x)
+				{
+					assertIsEqual(_actual[x], _expected[x], "SSE2 pixel not equal");
+				}
+			}
+
+			if (features.avx2)
+			{
+				std::fill(std::begin(_actual), std::end(_actual), 0);
+				sint32 actualHit = compositeScanlineAVX2(layers, _palette, ppuMask, startX, endX, _actual);
+
+				assertIsEqual(actualHit, expectedHit, "AVX2 sprite 0 hit not equal");
+				for (uint32 x = startX; x < endX; ++x)
+				{
+					assertIsEqual(_actual[x], _expected[x], "AVX2 pixel not equal");
+				}
+			}
+		}
+#endif
+
+		return true;
+	}
+
+private:
+	// Expected values worked out by hand from the rules of the per-pixel renderer
+	bool _testReferenceCases()
+	{
+		// Every palette value is distinct, and greyscale keeps only bits 4-5
+		for (uint32 index = 0; index < 32; ++index)
+		{
+			_palette[index] = static_cast<byte>(0x20 + index);
+		}
+
+		// Left column masks
+		_clearLayers();
+		_background[3] = OpaqueBackground;
+		_background[8] = OpaqueBackground;
+		_composite(ShowBackground | ShowSprites);
+		assertIsEqual(_expected[3], 0x20, "Background shown in the left column");
+		assertIsEqual(_expected[8], 0x26, "Background hidden after the left column");
+
+		_clearLayers();
+		_setSprite(5, Sprite, true);
+		_setSprite(9, Sprite, true);
+		_composite(ShowBackgroundLeftmost | ShowBackground | ShowSprites);
+		assertIsEqual(_expected[5], 0x20, "Sprite shown in the left column");
+		assertIsEqual(_expected[9], 0x39, "Sprite hidden after the left column");
+		_composite(ShowAll);
+		assertIsEqual(_expected[5], 0x39, "Sprite hidden in the left column when shown");
+
+		// The background mask hides the pixel but a back sprite still loses to it
+		_clearLayers();
+		_background[2] = OpaqueBackground;
+		_setSprite(2, Sprite, false);
+		_composite(ShowSpritesLeftmost | ShowBackground | ShowSprites);
+		assertIsEqual(_expected[2], 0x20, "Back sprite shown over a masked background");
+
+		// Sprite 0 hit is masked with the sprites only
+		_clearLayers();
+		_background[3] = OpaqueBackground;
+		_setSprite(3, Sprite, true);
+		_sprite0[3] = 0xFF;
+		assertIsEqual(_composite(ShowBackgroundLeftmost | ShowBackground | ShowSprites), -1, "Sprite 0 hit in the hidden left column");
+		assertIsEqual(_composite(ShowAll), 3, "Sprite 0 hit missed in the left column");
+
+		// Front and back sprite priority
+		_clearLayers();
+		_background[20] = OpaqueBackground;
+		_setSprite(20, Sprite, false);
+		_background[21] = OpaqueBackground;
+		_setSprite(21, Sprite, true);
+		_background[22] = TransparentBackground;
+		_setSprite(22, Sprite, false);
+		_background[23] = TransparentBackground;
+		// A back sprite first, then a front sprite under it
+		_background[24] = OpaqueBackground;
+		_sprite[24] = Sprite;
+		_frontSprite[24] = OtherSprite;
+		_background[25] = TransparentBackground;
+		_sprite[25] = Sprite;
+		_frontSprite[25] = OtherSprite;
+		_composite(ShowAll);
+		assertIsEqual(_expected[20], 0x26, "Back sprite shown over an opaque background");
+		assertIsEqual(_expected[21], 0x39, "Front sprite hidden by the background");
+		assertIsEqual(_expected[22], 0x39, "Back sprite hidden by a transparent background");
+		assertIsEqual(_expected[23], 0x20, "Transparent background not using the backdrop");
+		assertIsEqual(_expected[24], 0x3E, "Front sprite under a back sprite hidden by the background");
+		assertIsEqual(_expected[25], 0x39, "First sprite not shown over a transparent background");
+
+		// Sprite 0 hit stops before the last column
+		_clearLayers();
+		_background[254] = OpaqueBackground;
+		_background[255] = OpaqueBackground;
+		_setSprite(255, Sprite, true);
+		_sprite0[255] = 0xFF;
+		assertIsEqual(_composite(ShowAll), -1, "Sprite 0 hit at x=255");
+		_setSprite(254, Sprite, true);
+		_sprite0[254] = 0xFF;
+		assertIsEqual(_composite(ShowAll), 254, "Sprite 0 hit missed at x=254");
+		assertIsEqual(_composite(ShowSpritesLeftmost | ShowSprites), -1, "Sprite 0 hit with the background disabled");
+		_background[254] = TransparentBackground;
+		assertIsEqual(_composite(ShowAll), -1, "Sprite 0 hit over a transparent background");
+
+		// Greyscale applies to background, sprites and backdrop
+		_clearLayers();
+		_background[30] = OpaqueBackground;
+		_setSprite(31, Sprite, true);
+		_composite(ShowAll | Greyscale);
+		assertIsEqual(_expected[30], 0x20, "Greyscale background not equal");
+		assertIsEqual(_expected[31], 0x30, "Greyscale sprite not equal");
+		assertIsEqual(_expected[32], 0x20, "Greyscale backdrop not equal");
+
+		return true;
+	}
+
+	void _clearLayers()
+	{
+		std::fill(std::begin(_background), std::end(_background), 0);
+		std::fill(std::begin(_sprite), std::end(_sprite), 0);
+		std::fill(std::begin(_frontSprite), std::end(_frontSprite), 0);
+		std::fill(std::begin(_sprite0), std::end(_sprite0), 0);
+	}
+
+	void _setSprite(uint32 x, byte sprite, bool isInFront)
+	{
+		_sprite[x] = sprite;
+		_frontSprite[x] = isInFront ? sprite : 0;
+	}
+
+	sint32 _composite(byte ppuMask)
+	{
+		ScanlineLayers layers = { _background, _sprite, _frontSprite, _sprite0 };
+		return compositeScanlineScalar(layers, _palette, ppuMask, 0, ScanlineWidth, _expected);
+	}
+
+	void _generateScanline()
+	{
+		for (uint32 index = 0; index < 32; ++index)
+		{
+			_palette[index] = static_cast<byte>(rand());
+		}
+
+		for (uint32 x = 0; x < ScanlineWidth; ++x)
+		{
+			_background[x] = static_cast<byte>(rand() & 0xF);
+
+			// Keep the layers consistent with what the PPU produces
+			byte sprite = (rand() & 1) ? static_cast<byte>(0x10 | (rand() & 0xC) | (1 + rand() % 3)) : 0;
+			_sprite[x] = sprite;
+			_frontSprite[x] = (sprite && (rand() & 1)) ? sprite : 0;
+			_sprite0[x] = (sprite && (rand() % 4) == 0) ? 0xFF : 0;
+		}
+	}
+
+private:
+	byte _palette[32];
+	byte _background[ScanlineWidth];
+	byte _sprite[ScanlineWidth];
+	byte _frontSprite[ScanlineWidth];
+	byte _sprite0[ScanlineWidth];
+	byte _expected[ScanlineWidth];
+	byte _actual[ScanlineWidth];
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_ScanlineCompositorTest, ppu_scanline_compositor);
\ No newline at end of file
@@ -0,0 +1,122 @@
+// STL includes
+#include <cstring>
+
+// sukiNES includes
+#include <ppu.h>
+
+// Local includes
+#include "test.h"
+
+using namespace sukiNES;
+
+static const sint32 OverflowScanline = 100;
+static const byte SpriteOverflowFlag = 0x20;
+
+class Ppu_SpriteOverflowTimingTest : public StressTest::Test
+{
+public:
+	Ppu_SpriteOverflowTimingTest()
+	: StressTest::Test()
+	{
+	}
+
+	virtual bool run()
+	{
+		// The flag is set 2 dots per sprite up to the 8th in range, then 1 dot per sprite from dot 65
+		_setupPpu(10, 0x00);
+		_runUntilOverflow();
+		assertIsEqual(_overflowScanline, OverflowScanline, "Overflow scanline not equal");
+		assertIsEqual(_overflowCycle, 82u, "Overflow cycle not equal");
+
+		// Moving the 9th sprite away during the evaluation delays the flag to the 10th
+		_setupPpu(10, 0x00);
+		_runUntil(OverflowScanline, 70);
+		_ppu.write(0x2003, 8 * 4);
+		_ppu.write(0x2004, 0xF0);
+		_runUntilOverflow();
+		assertIsEqual(_overflowScanline, OverflowScanline, "Overflow scanline not equal after OAM write");
+		assertIsEqual(_overflowCycle, 83u, "Overflow cycle not equal after OAM write");
+
+		// 8x16 sprites: the last 2 sprites start 8 scanlines higher and only reach the others when 16 pixels tall
+		_setupPpu(9, 0x20);
+		_moveSpritesUp(7, 2);
+		_runUntilOverflow();
+		assertIsEqual(_overflowScanline, OverflowScanline, "8x16 overflow scanline not equal");
+		assertIsEqual(_overflowCycle, 82u, "8x16 overflow cycle not equal");
+
+		_setupPpu(9, 0x00);
+		_moveSpritesUp(7, 2);
+		_runUntilOverflow();
+		assertIsEqual(_overflowScanline, -1, "8x8 sprites should not overflow");
+
+		return true;
+	}
+
+private:
+	void _setupPpu(uint32 spriteCount, byte ppuControl)
+	{
+		memset(_chr, 0, sizeof(_chr));
+
+		_ppu.powerOn();
+		_ppu.mapChrBank(_chr);
+
+		// spriteCount sprites on OverflowScanline, the others below the screen
+		_ppu.write(0x2003, 0);
+		for (uint32 sprite = 0; sprite < 64; ++sprite)
+		{
+			_ppu.write(0x2004, sprite < spriteCount ? OverflowScanline : 0xF0);
+			_ppu.write(0x2004, 0);
+			_ppu.write(0x2004, 0);
+			_ppu.write(0x2004, 0);
+		}
+		_ppu.write(0x2003, 0);
+
+		_ppu.write(0x2000, ppuControl);
+		_ppu.write(0x2001, 0x18);
+	}
+
+	void _moveSpritesUp(uint32 firstSprite, uint32 spriteCount)
+	{
+		for (uint32 sprite = firstSprite; sprite < firstSprite + spriteCount; ++sprite)
+		{
+			_ppu.write(0x2003, static_cast<byte>(sprite * 4));
+			_ppu.write(0x2004, OverflowScanline - 8);
+		}
+		_ppu.write(0x2003, 0);
+	}
+
+	void _runUntil(sint32 scanline, uint32 cycle)
+	{
+		while (_ppu.currentScanline() != scanline || _ppu.cyclesCountPerScanline() != cycle)
+		{
+			_ppu.tick();
+		}
+	}
+
+	void _runUntilOverflow()
+	{
+		_overflowScanline = -1;
+		_overflowCycle = 0;
+
+		// Until the end of the first frame
+		while (_ppu.currentScanline() < 240)
+		{
+			_ppu.tick();
+
+			if (_ppu.read(0x2002) & SpriteOverflowFlag)
+			{
+				_overflowScanline = _ppu.currentScanline();
+				_overflowCycle = _ppu.cyclesCountPerScanline();
+				return;
+			}
+		}
+	}
+
+private:
+	byte _chr[SUKINES_KB(8)];
+	PPU _ppu;
+	sint32 _overflowScanline;
+	uint32 _overflowCycle;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_SpriteOverflowTimingTest, ppu_sprite_overflow_timing);
\ No newline at end of file
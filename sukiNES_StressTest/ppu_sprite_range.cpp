@@ -0,0 +1,95 @@
+// STL includes
+#include <cstdlib>
+
+// sukiNES includes
+#include <cpufeatures.h>
+#include <spriterange.h>
+
+// Local includes
+#include "test.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0x5EED;
+static const uint32 OamCount = 2000;
+static const uint32 VisibleScanlines = 240;
+
+class Ppu_SpriteRangeTest : public StressTest::Test
+{
+public:
+	Ppu_SpriteRangeTest()
+	: StressTest::Test()
+	{
+	}
+
+	virtual bool run()
+	{
+#ifdef SUKINES_ARCH_X86
+		const CpuFeatures& features = hostCpuFeatures();
+
+		srand(RandomSeed);
+
+		for (uint32 oam = 0; oam < OamCount; ++oam)
+		{
+			_generateOam();
+
+			uint32 spriteSize = (rand() & 1) ? 16 : 8;
+			for (uint32 scanline = 0; scanline < VisibleScanlines; ++scanline)
+			{
+				SpritesInRange expected;
+				findSpritesInRangeScalar(_spriteY, scanline, spriteSize, expected);
+
+				if (features.sse2)
+				{
+					SpritesInRange actual;
+					findSpritesInRangeSSE2(_spriteY, scanline, spriteSize, actual);
+					if (!_assertIsSame(actual, expected, "SSE2"))
+					{
+						return false;
+					}
+				}
+
+				if (features.avx2)
+				{
+					SpritesInRange actual;
+					findSpritesInRangeAVX2(_spriteY, scanline, spriteSize, actual);
+					if (!_assertIsSame(actual, expected, "AVX2"))
+					{
+						return false;
+					}
+				}
+			}
+		}
+#endif
+
+		return true;
+	}
+
+private:
+	void _generateOam()
+	{
+		// Cluster most sprites around a few lines so that overflows happen, Y near 255 covers the wrap around
+		uint32 base = rand() % 256;
+		for (uint32 oamIndex = 0; oamIndex < OamSpriteCount; ++oamIndex)
+		{
+			_spriteY[oamIndex] = static_cast<byte>((rand() % 3) ? base + rand() % 24 : rand());
+		}
+	}
+
+	bool _assertIsSame(const SpritesInRange& actual, const SpritesInRange& expected, const char* kernel)
+	{
+		assertIsEqual(actual.count, expected.count, kernel);
+		for (uint32 index = 0; index < expected.count && index < 8; ++index)
+		{
+			assertIsEqual(actual.oamIndices[index], expected.oamIndices[index], kernel);
+		}
+		assertIsEqual(actual.overflowIndex, expected.overflowIndex, kernel);
+
+		return true;
+	}
+
+private:
+	byte _spriteY[OamSpriteCount];
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_SpriteRangeTest, ppu_sprite_range);
\ No newline at end of file
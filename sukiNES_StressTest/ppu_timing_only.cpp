@@ -0,0 +1,210 @@
+// STL includes
+#include <cstdlib>
+#include <cstring>
+
+// sukiNES includes
+#include <framebuffer.h>
+#include <ppu.h>
+#include <ppuio.h>
+
+// Local includes
+#include "ppuscenetestbase.h"
+
+using namespace sukiNES;
+
+static const uint32 RandomSeed = 0xC0FFEE;
+static const uint32 FrameCount = 60;
+static const byte VBlankFlag = 0x80;
+static const byte Sprite0HitFlag = 0x40;
+static const byte SpriteOverflowFlag = 0x20;
+
+/**
+ * @brief Count the frames of a PPU, and compare the composed ones with the reference frame
+ */
+class TimingOnlyFrameIO : public PPUIO
+{
+public:
+	TimingOnlyFrameIO(const byte* referenceFrame)
+	: _referenceFrame(referenceFrame)
+	, _frameCount(0)
+	, _renderedFrameCount(0)
+	, _mismatchCount(0)
+	{
+	}
+
+	virtual void onFrame(const FrameInfo& frameInfo)
+	{
+		++_frameCount;
+
+		if (_referenceFrame && frameInfo.isRendered)
+		{
+			++_renderedFrameCount;
+			if (memcmp(frameInfo.frameBuffer.pixels, _referenceFrame, FrameWidth * FrameHeight) != 0)
+			{
+				++_mismatchCount;
+			}
+		}
+	}
+
+	uint32 frameCount() const
+	{
+		return _frameCount;
+	}
+
+	uint32 renderedFrameCount() const
+	{
+		return _renderedFrameCount;
+	}
+
+	uint32 mismatchCount() const
+	{
+		return _mismatchCount;
+	}
+
+private:
+	const byte* _referenceFrame;
+	uint32 _frameCount;
+	uint32 _renderedFrameCount;
+	uint32 _mismatchCount;
+};
+
+class Ppu_TimingOnlyTest : public PpuSceneTestBase
+{
+public:
+	Ppu_TimingOnlyTest()
+	: PpuSceneTestBase()
+	, _fullIO(nullptr)
+	, _timingIO(_fullFrame)
+	, _sprite0HitCount(0)
+	, _spriteOverflowCount(0)
+	, _vblankCount(0)
+	{
+	}
+
+	virtual bool run()
+	{
+		srand(RandomSeed);
+
+		randomizeChr();
+
+		// The reference PPU composes every frame, the other one skips the composition of most frames
+		addScenePpu(&_fullPpu);
+		_fullPpu.setIO(&_fullIO);
+		_fullPpu.setFrameBuffer(FrameBuffer(_fullFrame, FrameWidth, PixelFormat::PaletteIndex));
+
+		addScenePpu(&_timingPpu);
+		_timingPpu.setIO(&_timingIO);
+		_timingPpu.setFrameBuffer(FrameBuffer(_timingFrame, FrameWidth, PixelFormat::PaletteIndex));
+		_timingPpu.setTimingOnly(true);
+		_timingPpu.powerOn();
+
+		writeRandomScene();
+
+		uint32 nextStatusRead = 0;
+		uint32 lastFrameCount = _fullIO.frameCount();
+		while (_fullIO.frameCount() < FrameCount)
+		{
+			if (rand() % 1500 == 0)
+			{
+				_randomAccess();
+			}
+
+			// Switched per frame, one frame in four is composed
+			if (_fullIO.frameCount() != lastFrameCount)
+			{
+				lastFrameCount = _fullIO.frameCount();
+				_timingPpu.setTimingOnly(rand() % 4 != 0);
+			}
+
+			if (nextStatusRead == 0)
+			{
+				byte expectedStatus = _fullPpu.read(0x2002);
+				byte timingStatus = _timingPpu.read(0x2002);
+				assertIsEqual(timingStatus, expectedStatus, "PPUSTATUS not equal");
+				assertIsEqual(_timingPpu.hasVBlankOccured(), _fullPpu.hasVBlankOccured(), "NMI not equal");
+
+				_countFlags(expectedStatus);
+				nextStatusRead = rand() % 16;
+			}
+			else
+			{
+				--nextStatusRead;
+			}
+
+			// The reference frame is complete before the timing PPU reports the same frame
+			_fullPpu.tick();
+			_timingPpu.tick();
+		}
+
+		// A frame composed right after timing-only frames, sprite 0 included, must match the reference
+		assertIsEqual(static_cast<bool>(_timingIO.renderedFrameCount()), true, "No frame composed in timing-only mode");
+		assertIsEqual(_timingIO.mismatchCount(), 0u, "Composed frame differs from the reference");
+
+		// The scene must have exercised every flag
+		assertIsEqual(static_cast<bool>(_sprite0HitCount), true, "Sprite 0 hit never set");
+		assertIsEqual(static_cast<bool>(_spriteOverflowCount), true, "Sprite overflow never set");
+		assertIsEqual(static_cast<bool>(_vblankCount), true, "VBlank never read");
+
+		return true;
+	}
+
+private:
+	void _countFlags(byte status)
+	{
+		if (status & Sprite0HitFlag)
+		{
+			++_sprite0HitCount;
+		}
+		if (status & SpriteOverflowFlag)
+		{
+			++_spriteOverflowCount;
+		}
+		if (status & VBlankFlag)
+		{
+			++_vblankCount;
+		}
+	}
+
+	void _randomAccess()
+	{
+		switch(rand() % 5)
+		{
+			case 0:
+				write(0x2003, static_cast<byte>(rand()));
+				write(0x2004, static_cast<byte>(rand()));
+				break;
+			case 1:
+				// Random sprite 0, so that it often overlaps opaque background
+				write(0x2003, 0);
+				for (uint32 index = 0; index < 4; ++index)
+				{
+					write(0x2004, static_cast<byte>(rand()));
+				}
+				break;
+			case 2:
+				write(0x2000, static_cast<byte>(0x80 | (rand() & 0x38)));
+				break;
+			case 3:
+				// Rendering and the left column are sometimes disabled for a while
+				write(0x2001, static_cast<byte>((rand() % 4) ? 0x18 | (rand() & 0x06) : 0x00));
+				break;
+			default:
+				write(0x2005, static_cast<byte>(rand()));
+				write(0x2005, static_cast<byte>(rand()));
+				break;
+		}
+	}
+
+private:
+	byte _fullFrame[FrameWidth * FrameHeight];
+	byte _timingFrame[FrameWidth * FrameHeight];
+	PPU _fullPpu;
+	PPU _timingPpu;
+	TimingOnlyFrameIO _fullIO;
+	TimingOnlyFrameIO _timingIO;
+	uint32 _sprite0HitCount;
+	uint32 _spriteOverflowCount;
+	uint32 _vblankCount;
+};
+
+STRESSTEST_REGISTER_TEST(Ppu_TimingOnlyTest, ppu_timing_only);
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "ppuscenetestbase.h"
+
+// STL includes
+#include <cstdlib>
+
+PpuSceneTestBase::PpuSceneTestBase()
+: StressTest::Test()
+, _unchangedFrameCount(0)
+, _scenePpuCount(0)
+{
+}
+
+void PpuSceneTestBase::randomizeChr()
+{
+	for (uint32 index = 0; index < sizeof(_chr); ++index)
+	{
+		_chr[index] = static_cast<byte>(rand());
+	}
+}
+
+void PpuSceneTestBase::addScenePpu(sukiNES::PPU* ppu)
+{
+	ppu->mapChrBank(_chr);
+	_scenePpus[_scenePpuCount++] = ppu;
+}
+
+void PpuSceneTestBase::writeRandomScene(byte* written)
+{
+	write(0x2006, 0x20);
+	write(0x2006, 0x00);
+	for (uint32 index = 0; index < SceneMemorySize; ++index)
+	{
+		if (index == 0x1000)
+		{
+			write(0x2006, 0x3F);
+			write(0x2006, 0x00);
+		}
+
+		byte value = static_cast<byte>(rand());
+		if (written)
+		{
+			written[index] = value;
+		}
+		write(0x2007, value);
+	}
+
+	for (uint32 index = 0; index < 256; ++index)
+	{
+		write(0x2004, static_cast<byte>(rand()));
+	}
+
+	write(0x2000, 0x00);
+	write(0x2005, 0x00);
+	write(0x2005, 0x00);
+	write(0x2001, 0x1E);
+}
+
+void PpuSceneTestBase::write(word address, byte value)
+{
+	for (uint32 whichPpu = 0; whichPpu < _scenePpuCount; ++whichPpu)
+	{
+		_scenePpus[whichPpu]->write(address, value);
+	}
+}
+
+uint32 PpuSceneTestBase::nextWriteDelay()
+{
+	return (rand() % 4) * DotsPerFrame + rand() % DotsPerFrame;
+}
\ No newline at end of file
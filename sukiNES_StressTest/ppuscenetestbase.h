@@ -0,0 +1,72 @@
+#pragma once
+
+// sukiNES includes
+#include <ppu.h>
+#include <ppuio.h>
+
+// StressTest includes
+#include "test.h"
+
+/**
+ * @brief Base of the stress tests that run PPUs over the same random scene
+ *
+ * Every PPU added with addScenePpu() maps the same random CHR and gets every write().
+ */
+class PpuSceneTestBase : public StressTest::Test
+{
+public:
+	PpuSceneTestBase();
+
+protected:
+	static const uint32 MaxScenePpuCount = 4;
+	static const uint32 DotsPerFrame = 262 * 341;
+	// Nametables then palette, as written by writeRandomScene()
+	static const uint32 SceneMemorySize = 0x1000 + 0x20;
+
+	/**
+	 * @brief Fill the CHR with rand(), seed it first
+	 */
+	void randomizeChr();
+
+	/**
+	 * @brief Map the CHR in ppu and send it every write()
+	 */
+	void addScenePpu(sukiNES::PPU* ppu);
+
+	/**
+	 * @brief Random nametables, palette and sprites, scroll at 0, then show background and sprites
+	 * @param written Receives the SceneMemorySize nametable and palette bytes, or nullptr
+	 */
+	void writeRandomScene(byte* written = nullptr);
+
+	void write(word address, byte value);
+
+	/**
+	 * @brief Dots until the next random write, most frames are left untouched
+	 */
+	static uint32 nextWriteDelay();
+
+	/**
+	 * @brief Count the frames reused by the PPU, from PPUIO::onFrame()
+	 */
+	void countFrame(const sukiNES::FrameInfo& frameInfo)
+	{
+		if (frameInfo.isUnchanged)
+		{
+			++_unchangedFrameCount;
+		}
+	}
+
+	bool hasReusedFrame() const
+	{
+		return _unchangedFrameCount > 0;
+	}
+
+protected:
+	byte _chr[SUKINES_KB(8)];
+	uint32 _unchangedFrameCount;
+
+private:
+	sukiNES::PPU* _scenePpus[MaxScenePpuCount];
+	uint32 _scenePpuCount;
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+// STL includes
+#include <thread>
+
+// sukiNES includes
+#include <spscring.h>
+
+// Local includes
+#include "test.h"
+
+using namespace sukiNES;
+
+static const uint32 RingCapacity = 16;
+static const uint32 TransferCount = 1000000;
+
+class SpscRingTest : public StressTest::Test
+{
+public:
+	SpscRingTest()
+	: StressTest::Test()
+	{
+	}
+
+	virtual bool run()
+	{
+		if (!_testSingleThread())
+		{
+			return false;
+		}
+
+		// A producer thread pushing a sequence, every value comes out once and in order
+		SpscRing<uint32, RingCapacity> ring;
+		std::thread producer([&ring] () {
+			for (uint32 value = 0; value < TransferCount; ++value)
+			{
+				while (!ring.push(value))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+
+		uint32 expected = 0;
+		uint32 outOfOrderCount = 0;
+		while (expected < TransferCount)
+		{
+			uint32 value = 0;
+			if (!ring.pop(value))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			if (value != expected)
+			{
+				++outOfOrderCount;
+			}
+			expected = value + 1;
+		}
+		producer.join();
+
+		assertIsEqual(outOfOrderCount, 0, "Values lost or reordered between threads");
+
+		uint32 leftover = 0;
+		assertIsEqual(ring.pop(leftover), false, "Ring not empty after the last value");
+
+		return true;
+	}
+
+private:
+	bool _testSingleThread()
+	{
+		SpscRing<uint32, RingCapacity> ring;
+		uint32 value = 0;
+
+		assertIsEqual(ring.pop(value), false, "New ring not empty");
+
+		// Fill and drain a few times so the indices wrap around the storage
+		for (uint32 round = 0; round < 5; ++round)
+		{
+			for (uint32 index = 0; index < RingCapacity; ++index)
+			{
+				assertIsEqual(ring.push(round * 100 + index), true, "Ring full before its capacity");
+			}
+			assertIsEqual(ring.push(0), false, "Ring accepted a value past its capacity");
+
+			for (uint32 index = 0; index < RingCapacity; ++index)
+			{
+				assertIsEqual(ring.pop(value), true, "Ring empty before its capacity");
+				assertIsEqual(value, round * 100 + index, "Value not taken in the order pushed");
+			}
+			assertIsEqual(ring.pop(value), false, "Ring not empty after draining it");
+		}
+
+		assertIsEqual(ring.pushedCount(), 5 * RingCapacity, "Pushed values not counted");
+		assertIsEqual(ring.poppedCount(), 5 * RingCapacity, "Popped values not counted");
+
+		ring.push(1);
+		ring.clear();
+		assertIsEqual(ring.pop(value), false, "Ring not empty after clear()");
+		assertIsEqual(ring.pushedCount(), 0u, "Pushed count not reset by clear()");
+
+		return true;
+	}
+};
+
+STRESSTEST_REGISTER_TEST(SpscRingTest, spsc_ring);
\ No newline at end of file